@@ -0,0 +1,267 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DERIVED_RECORDS_HPP_
+#define DERIVED_RECORDS_HPP_
+
+/* Records produced by the test program itself, from the data it receives.
+   They use the same 8-byte {type, size} header as the MagElement records,
+   and carry their 64-bit packet index at offset 8, so that they can be
+   written to the same files and found by the same searches. */
+
+#include <stdint.h>
+#include "gmplatform.h"
+#include "MagElementData.hpp"
+
+#define GM_DATA_DOMAIN_TEST_CLIENT (0x40 << 16)
+
+/* Identifier for the gradiometer record: difference and sum of mag1 and mag2 */
+#define GM_MAG_ELEMENT_GRADIOMETER_FORMAT         (GM_DATA_DOMAIN_TEST_CLIENT | 0x01)
+
+/* Gradiometer record.  Output sample i covers the raw samples
+   mFirstPacketIndex + i * mDecimation ... + mDecimation - 1, and is the mean
+   over those of the valid samples (both sensors valid, neither in the dead
+   zone).  Values are in nT. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_GradiometerPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_GRADIOMETER_FORMAT */
+  uint32_t mRecordSize;          /* Size 672 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint32_t mDecimation;          /* Raw samples per output sample. Offset 16 */
+  uint32_t mSampleCount;         /* Entries used, up to 40. Offset 20 */
+  uint64_t mValidMask;           /* Bit i set if output i had any valid input. Offset 24 */
+  double   mDifference[MFAM_STREAMER_CACHE_SIZE];  /* mag1 - mag2. Offset 32 */
+  double   mSum[MFAM_STREAMER_CACHE_SIZE];         /* mag1 + mag2. Offset 352 */
+} GradiometerPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_GRADIOMETER_FORMAT (672)
+
+static_assert ((sizeof(GradiometerPacket) == SIZE_OF_GM_MAG_ELEMENT_GRADIOMETER_FORMAT),
+               "Not expected size");
+
+/* Identifier for the checksum record, written to recordings made with -checksum */
+#define GM_MAG_ELEMENT_CHECKSUM_FORMAT            (GM_DATA_DOMAIN_TEST_CLIENT | 0x02)
+
+/* Checksum record.  It covers the mByteCount bytes of the file that come
+   immediately before it, which hold mRecordCount whole records, the first
+   of them with index mFirstPacketIndex.  mCrc32c is the CRC32C (Castagnoli
+   polynomial) of those bytes; see Checksum.hpp. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_ChecksumPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_CHECKSUM_FORMAT */
+  uint32_t mRecordSize;          /* Size 32 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint32_t mRecordCount;         /* Offset 16 */
+  uint32_t mByteCount;           /* Offset 20 */
+  uint32_t mCrc32c;              /* Offset 24 */
+  uint32_t mReserved;            /* Offset 28 */
+} ChecksumPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_CHECKSUM_FORMAT (32)
+
+static_assert ((sizeof(ChecksumPacket) == SIZE_OF_GM_MAG_ELEMENT_CHECKSUM_FORMAT),
+               "Not expected size");
+
+/* Identifier for the merge source record, written by -proto merge */
+#define GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT        (GM_DATA_DOMAIN_TEST_CLIENT | 0x03)
+
+/* Merge source record.  In a stream merged from several instruments, the
+   records that follow it, up to the next one, came from input mInput (its
+   place in the -file list), whose instrument has serial number
+   mSerialNumber (zero until its first heartbeat).  mFirstPacketIndex is
+   the index of the record that follows, and mTimeNanoseconds its time on
+   the common time base: nanoseconds since the instrument's first PPS. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_MergeSourcePacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT */
+  uint32_t mRecordSize;          /* Size 40 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint32_t mInput;               /* Offset 16 */
+  uint32_t mReserved;            /* Offset 20 */
+  int64_t  mTimeNanoseconds;     /* Offset 24 */
+  uint8_t  mSerialNumber[8];     /* Offset 32 */
+} MergeSourcePacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT (40)
+
+static_assert ((sizeof(MergeSourcePacket) == SIZE_OF_GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT),
+               "Not expected size");
+
+/* Identifier for the anomaly record, written by the anomaly detector (-anomaly) */
+#define GM_MAG_ELEMENT_ANOMALY_FORMAT             (GM_DATA_DOMAIN_TEST_CLIENT | 0x04)
+
+/* Anomaly record: one event on one mag channel (mChannel 1 or 2).  The
+   event covers the mWidth samples from mFirstPacketIndex on in which the
+   detrended RMS stayed above the threshold; its largest detrended value,
+   mPeakAmplitude, was at mPeakPacketIndex.  ANOMALY_FLAG_TRUNCATED is set
+   if the event was cut short at the longest width, to bound its latency.
+   Values are in nT. */
+#define ANOMALY_FLAG_TRUNCATED 0x0001
+
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_AnomalyPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_ANOMALY_FORMAT */
+  uint32_t mRecordSize;          /* Size 56 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint64_t mPeakPacketIndex;     /* Offset 16 */
+  uint32_t mWidth;               /* Samples. Offset 24 */
+  uint16_t mChannel;             /* Offset 28 */
+  uint16_t mFlags;               /* Offset 30 */
+  double   mPeakAmplitude;       /* Detrended, with sign. Offset 32 */
+  double   mPeakRms;             /* Largest detrended RMS. Offset 40 */
+  double   mThreshold;           /* RMS threshold when the event began. Offset 48 */
+} AnomalyPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_ANOMALY_FORMAT (56)
+
+static_assert ((sizeof(AnomalyPacket) == SIZE_OF_GM_MAG_ELEMENT_ANOMALY_FORMAT),
+               "Not expected size");
+
+/* Identifier for the compensated record, written by the Tolles-Lawson stage (-tl) */
+#define GM_MAG_ELEMENT_COMPENSATED_FORMAT         (GM_DATA_DOMAIN_TEST_CLIENT | 0x05)
+
+/* Compensated record: mMagData of the decimated record with index mIndex,
+   less the platform field that the Tolles-Lawson model predicts from the
+   compass, mCorrection.  mCalibrationSamples is the number of samples the
+   coefficients were fitted to.  Values are in nT. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_CompensatedPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_COMPENSATED_FORMAT */
+  uint32_t mRecordSize;          /* Size 48 */
+  uint64_t mIndex;               /* Offset 8 */
+  double   mMagData;             /* Offset 16 */
+  double   mCompensated;         /* Offset 24 */
+  double   mCorrection;          /* Offset 32 */
+  uint32_t mCalibrationSamples;  /* Offset 40 */
+  uint32_t mReserved;            /* Offset 44 */
+} CompensatedPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_COMPENSATED_FORMAT (48)
+
+static_assert ((sizeof(CompensatedPacket) == SIZE_OF_GM_MAG_ELEMENT_COMPENSATED_FORMAT),
+               "Not expected size");
+
+/* Identifier for the resampled record, written by the resampling stage (-resample) */
+#define GM_MAG_ELEMENT_RESAMPLED_FORMAT           (GM_DATA_DOMAIN_TEST_CLIENT | 0x06)
+
+/* Resampled record: mag1, mag2 and the four aux channels of the 1000Hz
+   blocks, interpolated onto a uniform grid of mRate samples a second that
+   is aligned with the PPS edges.  Output sample i is at (mFirstTick + i) /
+   mRate seconds after the instrument's first PPS; mFirstPacketIndex is the
+   raw sample at or just before the first of them.  Each mSegment is a run
+   of raw samples with no gaps or invalid samples, and no output sample
+   draws on more than one.  mKernel is RESAMPLE_KERNEL_LINEAR, _CUBIC or
+   _SINC.  Mag values are in nT, aux values in LSBs. */
+#define RESAMPLED_SAMPLES       32
+#define RESAMPLE_KERNEL_LINEAR  0
+#define RESAMPLE_KERNEL_CUBIC   1
+#define RESAMPLE_KERNEL_SINC    2
+
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_ResampledPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_RESAMPLED_FORMAT */
+  uint32_t mRecordSize;          /* Size 1064 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  int64_t  mFirstTick;           /* Offset 16 */
+  uint32_t mRate;                /* Output samples a second. Offset 24 */
+  uint32_t mSegment;             /* Offset 28 */
+  uint16_t mSampleCount;         /* Entries used, up to 32. Offset 32 */
+  uint16_t mKernel;              /* Offset 34 */
+  uint32_t mReserved;            /* Offset 36 */
+  double   mMag1[RESAMPLED_SAMPLES];     /* Offset 40 */
+  double   mMag2[RESAMPLED_SAMPLES];     /* Offset 296 */
+  float    mAux[4][RESAMPLED_SAMPLES];   /* auxsenx, auxseny, auxsenz, auxsent. Offset 552 */
+} ResampledPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_RESAMPLED_FORMAT (1064)
+
+static_assert ((sizeof(ResampledPacket) == SIZE_OF_GM_MAG_ELEMENT_RESAMPLED_FORMAT),
+               "Not expected size");
+
+/* Identifier for the fixed-point record, written by the fixed-point stage (-fixed) */
+#define GM_MAG_ELEMENT_FIXED_POINT_FORMAT         (GM_DATA_DOMAIN_TEST_CLIENT | 0x07)
+
+/* Fixed-point record: mag1, mag2 and mag1 - mag2, decimated by
+   mDecimation with a CIC filter of order mOrder, as the filter's exact
+   integer sums; nT = value * MFAM_NANOTESLAS_PER_LSB / mGain, where mGain
+   is mDecimation to the power mOrder.  Output sample i ends at raw sample
+   mFirstPacketIndex + (i + 1) * mDecimation - 1, and spans mOrder *
+   (mDecimation - 1) + 1 raw samples.  Bit i of a valid mask is set if
+   every sample in that span was valid; the difference is valid where
+   both are. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_FixedPointPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_FIXED_POINT_FORMAT */
+  uint32_t mRecordSize;          /* Size 1008 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint32_t mDecimation;          /* Offset 16 */
+  uint16_t mSampleCount;         /* Entries used, up to 40. Offset 20 */
+  uint8_t  mOrder;               /* Offset 22 */
+  uint8_t  mReserved;            /* Offset 23 */
+  uint64_t mGain;                /* Offset 24 */
+  uint64_t mMag1ValidMask;       /* Offset 32 */
+  uint64_t mMag2ValidMask;       /* Offset 40 */
+  int64_t  mMag1[MFAM_STREAMER_CACHE_SIZE];        /* Offset 48 */
+  int64_t  mMag2[MFAM_STREAMER_CACHE_SIZE];        /* Offset 368 */
+  int64_t  mDifference[MFAM_STREAMER_CACHE_SIZE];  /* Offset 688 */
+} FixedPointPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_FIXED_POINT_FORMAT (1008)
+
+static_assert ((sizeof(FixedPointPacket) == SIZE_OF_GM_MAG_ELEMENT_FIXED_POINT_FORMAT),
+               "Not expected size");
+
+/* Identifier for the FIR decimated record, written by -proto decimate */
+#define GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT       (GM_DATA_DOMAIN_TEST_CLIENT | 0x08)
+
+/* FIR decimated record: mag1 and mag2 low-pass filtered with mTaps
+   symmetric taps and decimated by mDecimation.  Output sample i is
+   centred on raw sample mFirstPacketIndex + i * mDecimation, and records
+   cover fixed runs of 40 outputs, starting at multiples of 40 *
+   mDecimation.  Bit i of a valid mask is set if every raw sample under
+   the taps was present and valid; other outputs are 0.  Values are in nT. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_FirDecimatedPacket
+{
+  uint32_t mRecordType;          /* GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT */
+  uint32_t mRecordSize;          /* Size 680 */
+  uint64_t mFirstPacketIndex;    /* Offset 8 */
+  uint32_t mDecimation;          /* Offset 16 */
+  uint32_t mTaps;                /* Offset 20 */
+  uint64_t mMag1ValidMask;       /* Offset 24 */
+  uint64_t mMag2ValidMask;       /* Offset 32 */
+  double   mMag1[MFAM_STREAMER_CACHE_SIZE];  /* Offset 40 */
+  double   mMag2[MFAM_STREAMER_CACHE_SIZE];  /* Offset 360 */
+} FirDecimatedPacket ALIGN_1_SPEC;
+
+#define SIZE_OF_GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT (680)
+
+static_assert ((sizeof(FirDecimatedPacket) == SIZE_OF_GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT),
+               "Not expected size");
+
+#endif /* DERIVED_RECORDS_HPP_ */
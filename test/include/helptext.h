@@ -29,20 +29,235 @@ Examples:
   MagElementTestLinux -proto tcp -addr 192.168.10.3 -port 1000
   MagElementTestWindows -proto udp -port 2000 -file "savefile.bin"
   MagElementTestWindows -proto file-check -file "savefile.bin" 			   
+  MagElementTestLinux -proto replay -replay-proto tcp -port 1000 -file "savefile.bin" -rate 10
+  MagElementTestLinux -proto replay -replay-proto udp -addr 127.0.0.1 -port 2000 -file "savefile.bin" -rate max -loss 1
+  MagElementTestLinux -proto udp -port 2000 -verbose false -stats 10000
+  MagElementTestLinux -proto tcp -addr 192.168.10.3 -port 1000 -psd "noise.psd"
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -gradiometer 10
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -anomaly 6 -anomaly-rms 20
+  MagElementTestLinux -proto file-check -file "recordings/*.bin" -follow -stats 10000
+  MagElementTestLinux -proto file-check -file "calibration.bin" -tl "tl.txt" -tl-calibrate 1000 9000
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -tl "tl.txt"
+  MagElementTestLinux -proto udp -port 2000 -stats 10000 -psd "noise.psd" -threads stage
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -pipeline "stages.txt"
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -rx-cpu 2 -rt-priority 80 -lock-memory
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -checksum 1
+  MagElementTestLinux -proto udp -port 2000 -file "savefile.bin" -reorder 64 -reorder-ms 50
+  MagElementTestLinux -proto udp -port 2000 -verbose false -stdout block,heartbeat | zstd > "savefile.bin.zst"
+  MagElementTestLinux -proto dual -addr 192.168.10.3 -port 1000 -udp-port 2000 -file "savefile.bin" -reorder 64
+  MagElementTestLinux -proto batch-check -file "recordings/*.bin"
+  MagElementTestLinux -proto salvage -file "damaged.bin" -out "recovered.bin"
+  MagElementTestLinux -proto extract -file "savefile.bin" -range 120000 130039 -csv "mag.csv"
+  MagElementTestLinux -proto pcap -file "capture.pcapng" -port 2000 -out "savefile.bin"
+  MagElementTestLinux -proto pyramid -file "savefile.bin" -pixels 1920 -csv "overview.csv"
+  MagElementTestLinux -proto merge -file "port.bin,starboard.bin" -out "array.bin"
+  MagElementTestLinux -proto decimate -file "savefile.bin" -out "survey.bin" -rates 100,10,1
+  MagElementTestLinux -proto decode -file "old.bin" -schema "layouts.txt" -layout block -csv "old.csv"
   MagElementTestLinux -LICENSE
   
 
 Options:
--proto      [tcp | udp | file-check ] : tcp and udp are communications protocols
-                   to receive data from a MagElement.  file-check is a command
-                   to check the validity of the data in a data file collected
-                   via udp or tcp
+-proto      [tcp | udp | dual | file-check | replay | batch-check | extract |
+                   salvage | pyramid | pcap | merge | decimate | decode ] : tcp and udp are communications protocols
+                   to receive data from a MagElement.  dual receives the
+                   same instrument over both at once, from -addr and
+                   -port over tcp and on -udp-port over udp, and keeps
+                   the first copy of each record, so that each path fills
+                   the gaps of the other; it reports which path supplied
+                   each run of 1000Hz blocks.
+                   file-check is a command to check the validity of the data
+                   in a data file collected via udp or tcp (see -follow).
+                   replay sends the
+                   data in a file back out over tcp or udp, as a MagElement
+                   would.  batch-check validates many files at once: -file
+                   names a file, a directory, or a pattern such as
+                   "day3/*.bin".  It reports record counts, index gaps,
+                   unreadable ranges and truncated ends for each file, and
+                   exits with 1 if any file has problems.  extract prints
+                   mag1 and mag2 in nT, as CSV, for a range of packet
+                   indices in the -file recording (see -range, -csv).
+                   salvage copies every record that can be recovered from
+                   a damaged -file recording into a new file, -out, and
+                   lists the byte ranges it left out.
+                   pyramid builds a min/max/mean summary of mag1 and mag2
+                   at every power-of-two zoom level beside the -file
+                   recording (savefile.bin.pyr, or -out), for plotting any
+                   stretch of it quickly; see -pixels.
+                   pcap reads the records in a tcpdump or Wireshark capture
+                   (-file, pcap or pcapng), from UDP datagrams and TCP
+                   streams, and handles them as if they had been received,
+                   as fast as possible; with -port, only traffic to or from
+                   that port.
+                   merge combines the recordings of several instruments,
+                   -file "a.bin,b.bin" (each may be a directory or pattern),
+                   into one stream in time order, aligned on the PPS
+                   counters in their heartbeats, and handles it as if it
+                   had been received.  A merge source record before each
+                   run of records says which input they came from; with
+                   -out, the merged stream is saved.  Only recordings can
+                   be merged, not live streams; the files matched by one
+                   entry are one instrument's segments, read in name
+                   order.  See -merge-buffer.
+                   decimate low-pass filters mag1 and mag2 of the -file
+                   recording and writes them at each of -rates to a new
+                   file, -out, splitting the work across -workers.
+                   decode prints every field of the -layout records in the
+                   -file recording as CSV (see -csv), using record layouts
+                   read from -schema, so that recordings from other
+                   firmware versions can be read without a rebuild.
                    No default value.
 -addr          Ip address of the sending instrument, in NNN.NNN.NNN.NNN format
 -port          Instrument port to which this test should connect; used for tcp only.
+-udp-port      Dual: the local port on which udp records arrive. Default = -port.
 -file          Optionally, open this file and record all binary records to this file.
 -verbose       Display info to console.  [ true | false ]. Default = true; 
                  in non-verbose mode the program may run silently, 
                  i.e. without any indication that it is running.
+-replay-proto  [ tcp | udp ]  Protocol for replay. Default = tcp. With tcp, replay
+                 listens on -port and streams to the first client; with udp,
+                 it sends to -addr (default 127.0.0.1) on -port.
+-follow       File-check: keep checking the -file recording as it is
+                 written, reading only the bytes appended to it.  -file
+                 may be a directory or pattern of segments; the latest is
+                 followed, then each new one as it appears.  Gaps,
+                 unreadable bytes, failed checksums and cut-short records
+                 are reported at once; press q for a summary.
+-workers       Threads for batch-check, salvage and decimate. Default = 0, one per
+                 hardware thread.
+-chunk-mb      Files larger than this many MB are split into pieces that
+                 batch-check and salvage scan in parallel. Default = 64.
+-out           Salvage: the new file for the recovered records.
+                 Pyramid: the sidecar file. Default = -file name + .pyr.
+                 Pcap: save the records found as a recording.
+                 Merge: save the merged stream as a recording.
+                 Decimate: the new file for the decimated records.
+-rates         Decimate: output rates in Hz, comma separated, each dividing
+                 1000. Default = 100,10,1.
+-merge-buffer  Merge: records held for each input while the merge waits
+                 on the others, 16 to 1048576. Default = 1024.
+-pixels        Pyramid: after building, print minimum, maximum and mean of
+                 mag1 and mag2 in nT for this many equal columns of -range,
+                 as CSV (see -csv).
+-stdout        Write the records received or read, unchanged, to standard
+                 output, for another program to read through a pipe:
+                 all, or a comma separated list of record types (block,
+                 decimated, heartbeat, gradiometer, checksum, source,
+                 anomaly, compensated, resampled, fixed, fir, or a type
+                 number such as 0x1001F).  Text output goes to standard
+                 error instead.  Records are written in batches the size
+                 of the pipe buffer, or every 0.1 s when they come slowly.
+                 For tcp, udp, dual, file-check, pcap and merge.
+-schema        Decode: file of record layouts, added to the built-in layouts
+                 of the block, decimated and heartbeat records.  Each line
+                 is one of
+                   record <name> <type> <size>
+                   field <name> <offset> <u8|i8|u16|i16|u32|i32|u64|i64|f32|f64> [scale]
+                   repeat <count> <stride>
+                 with # for comments; a field's offset is from the start
+                 of the record, and the fields after repeat occur count
+                 times, stride bytes apart.  Layouts for different
+                 firmware versions may share a name.
+-layout        Decode: name of the layouts to print. Default = block.
+-range         Extract and pyramid: first and last packet index, inclusive.
+                 Default = the whole recording.
+-csv           Extract, pyramid and decode: write the CSV to this file instead of
+                 the console.
+-rate          Replay speed: a multiple of real time, or max for as fast as
+                 possible. Default = 1.  Pacing follows the packet index
+                 of the 1000Hz blocks.
+-jitter        Replay: add a random delay of 0 to this many milliseconds to
+                 each 1000Hz block.  Default = 0.
+-loss          Replay: drop this percentage of records at random. Default = 0.
+-stats         Streaming statistics over a sliding window of this many samples:
+                 mean, standard deviation, minimum, maximum and Allan
+                 deviation at octave taus of mag1, mag2 (1000Hz blocks) and
+                 the decimated field strength. Printed with each heartbeat.
+-psd           Welch power spectral density of mag1 and mag2, written to this
+                 binary log file (see WelchPsd.hpp for the format). Noise
+                 near 1, 10 and 100 Hz, in pT/sqrt(Hz), is printed with
+                 each estimate.
+-psd-length    FFT segment length for -psd, a power of two. Default = 4096.
+                 Segments overlap by half and use a Hann window.
+-psd-averages  Number of segments averaged in each -psd estimate. Default = 8.
+-gradiometer   Derive the gradiometer channel, mag1 - mag2, and mag1 + mag2, and
+                 output them with the received records. The number given
+                 is the decimation factor: 1 for every sample, or N for the
+                 mean of each N raw samples.  Invalid and dead-zone samples
+                 are left out.
+-anomaly       Flag magnetic anomalies in mag1 and mag2 as the data arrives,
+                 and output an anomaly record for each one: first and peak
+                 packet index, width, and peak amplitude in nT.  The number
+                 given is the threshold, in spreads (mean absolute
+                 deviations) of the noise above its level; 6 is a good
+                 start.  Each event is reported within -anomaly-trend
+                 + -anomaly-rms samples of its start.
+-anomaly-rms   Samples over which the detrended RMS is taken. Default = 20.
+-anomaly-trend Samples whose mean is the background trend, and over which
+                 the noise level adapts. Default = 2000.
+-tl            Tolles-Lawson compensation of the decimated mag data for the
+                 field of the platform, from the compass: output a
+                 compensated record for each decimated record.  The
+                 coefficients are read from this file, or with
+                 -tl-calibrate, fitted and written to it.
+-tl-calibrate  First and last decimated index of the calibration
+                 manoeuvres.  The coefficients are fitted as the data
+                 arrives, saved at the end of the range and used from
+                 then on.
+-tl-filter     Half width, in decimated samples, of the moving mean that is
+                 taken out of the calibration data, so that only the
+                 manoeuvres are fitted. Default = 50.
+-resample      Interpolate mag1, mag2 and the aux channels of the 1000Hz
+                 blocks onto a uniform grid of this many samples a second,
+                 1 to 10000, aligned with the PPS edges, and output them as
+                 resampled records.  Gaps and invalid samples start a new
+                 segment; nothing is interpolated across them.
+-interpolation Kernel for -resample: linear, cubic or sinc (Lanczos).
+                 Default = cubic.  Below 1000Hz, the kernel is widened to
+                 filter out what the lower rate can't carry.
+-fixed         Decimate mag1, mag2 and mag1 - mag2 by this factor entirely in
+                 integer arithmetic, with a CIC filter, and output them as
+                 fixed-point records: the filter's exact sums, the same on
+                 every platform.  Only the console output converts them
+                 to nT.
+-fixed-order   CIC stages for -fixed, 1 to 6. Default = 3.  Order times
+                 log2 of the factor may be at most 31.
+-pipeline      File that sets out the processing stages, their order, the
+                 threads they run on and the batching between threads.  One
+                 stage per line: stats [window], psd [log [length [averages]]],
+                 gradiometer [decimation], anomaly [factor [rms [trend]]],
+                 compensate [file], resample [rate [kernel]],
+                 fixed [decimation [order]], output, console or file.  Other lines: "thread" (next
+                 stage on a new thread), "batch N", "queue N" (batches
+                 queued between threads); # comments.
+                 Without -pipeline, the stages follow the options above.
+-threads       [fused | stage] : fused (default) runs every stage on the
+                 receiving thread; stage gives each stage its own thread.
+-batch         Records passed between threads at a time. Default = 8.
+-pool-slots    Preallocated buffers for each record size. Records are shared
+                 between stages and threads without copying; with too few
+                 buffers, some come from the heap (see the verbose report
+                 at exit). Default = 2048.
+-rx-cpu        Run the receiving thread only on this CPU (0, 1, 2...).
+-writer-cpu    Run the thread that writes the output file only on this CPU.
+                 Applies when the file stage has its own thread (-threads
+                 stage, or a pipeline file).
+-command-cpu   Run the thread that watches for q,[ENTER] only on this CPU.
+-rt-priority   Run the receiving thread with real-time priority, 1 to 99.
+                 Needs root, CAP_SYS_NICE or an rtprio limit.
+-rt-policy     [fifo | rr] : real-time scheduling policy. Default = fifo.
+-lock-memory   Lock all memory into RAM so that no page faults occur once
+                 data flows.  Needs CAP_IPC_LOCK or a high memlock limit.
+                 Page faults and context switches are reported at exit.
+-checksum      Recording: after every this many records, write a checksum
+                 record holding the CRC32C of the records since the last
+                 one.  file-check and batch-check verify the checksums and
+                 report any that don't match; files without checksums are
+                 checked as before.  1 gives a checksum per record.
+-reorder       UDP and dual: hold up to this many 1000Hz blocks, 2 to 1024, so that
+                 blocks arriving out of order are put back in packet index
+                 order and duplicates are dropped.  Default = off.
+-reorder-ms    UDP and dual: the longest wait for a missing block before it is
+                 counted as lost and later blocks are passed on.
+                 Default = 50.  -verbose true reports the counts at exit.
 -LICENSE       Display the license for this software.
 )";
@@ -0,0 +1,739 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+/* Python bindings for the recording reader and the record decoder.
+
+   magelement.Recording (path) opens a recording; read (first, end)
+   decodes the 1000Hz samples with packet indices first ... end - 1 into
+   a Columns object.  magelement.StreamDecoder takes bytes as they arrive
+   from a socket (TCP stream or UDP datagrams) with feed (data), and
+   take () hands over the samples decoded so far.
+
+   Each column of a Columns object (mag1, mag2, adc0 ...) supports the
+   buffer protocol, so numpy.asarray (columns.mag1) and memoryview
+   (columns.mag1) see the decoded data in place, without a copy.  The
+   interpreter lock is released while files are indexed and records are
+   decoded. */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "DecodedColumns.hpp"
+#include "RecordUtilities.hpp"
+#include "RecordingReader.hpp"
+
+/* ---------------------------------------------------------------------
+   Columns: decoded samples, owned by C++
+   --------------------------------------------------------------------- */
+
+typedef struct
+{
+  PyObject_HEAD
+  SampleColumns *mColumns;
+} ColumnsObject;
+
+/* One column of a Columns object.  It holds a reference to the Columns
+   object, so the data stays alive for as long as any view of it. */
+typedef struct
+{
+  PyObject_HEAD
+  PyObject   *mOwner;
+  void       *mData;
+  Py_ssize_t  mLength;
+  Py_ssize_t  mItemSize;
+  const char *mFormat;
+} ColumnObject;
+
+/* The types are filled in member by member in PyInit_magelement(). */
+static PyTypeObject ColumnsType;
+static PyTypeObject ColumnType;
+
+static int Column_GetBuffer (PyObject *self, Py_buffer *view, int flags)
+{
+  ColumnObject *column = (ColumnObject *)self;
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+    {
+      PyErr_SetString (PyExc_BufferError, "magelement columns are read-only");
+      view->obj = NULL;
+      return -1;
+    }
+  view->obj = self;
+  Py_INCREF (self);
+  view->buf = column->mData;
+  view->len = column->mLength * column->mItemSize;
+  view->readonly = 1;
+  view->itemsize = column->mItemSize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? (char *)column->mFormat : NULL;
+  view->ndim = 1;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? &column->mLength : NULL;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &column->mItemSize : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static PyBufferProcs ColumnBufferProcs = { Column_GetBuffer, NULL };
+
+static void Column_Dealloc (PyObject *self)
+{
+  Py_XDECREF (((ColumnObject *)self)->mOwner);
+  Py_TYPE (self)->tp_free (self);
+}
+
+static Py_ssize_t Column_Length (PyObject *self)
+{
+  return ((ColumnObject *)self)->mLength;
+}
+
+static PySequenceMethods ColumnSequenceMethods;
+
+template <typename T>
+static const char *FormatFor ();
+template <> const char *FormatFor<uint64_t> () { return "Q"; }
+template <> const char *FormatFor<uint32_t> () { return "I"; }
+template <> const char *FormatFor<uint16_t> () { return "H"; }
+template <> const char *FormatFor<uint8_t> () { return "B"; }
+
+template <typename T>
+static PyObject *NewColumn (PyObject *owner, std::vector<T> &values)
+{
+  ColumnObject *column = PyObject_New (ColumnObject, &ColumnType);
+  if (column == NULL)
+    {
+      return NULL;
+    }
+  Py_INCREF (owner);
+  column->mOwner = owner;
+  column->mData = values.data ();
+  column->mLength = (Py_ssize_t)values.size ();
+  column->mItemSize = sizeof (T);
+  column->mFormat = FormatFor<T> ();
+  return (PyObject *)column;
+}
+
+static PyObject *NewColumns (SampleColumns *columns)
+{
+  ColumnsObject *object = PyObject_New (ColumnsObject, &ColumnsType);
+  if (object == NULL)
+    {
+      delete columns;
+      return NULL;
+    }
+  object->mColumns = columns;
+  return (PyObject *)object;
+}
+
+static void Columns_Dealloc (PyObject *self)
+{
+  delete ((ColumnsObject *)self)->mColumns;
+  Py_TYPE (self)->tp_free (self);
+}
+
+static Py_ssize_t Columns_Length (PyObject *self)
+{
+  return (Py_ssize_t)((ColumnsObject *)self)->mColumns->Size ();
+}
+
+static PySequenceMethods ColumnsSequenceMethods;
+
+/* Getter for each column; closure is the column's number in this list. */
+enum ColumnId
+  {
+    COLUMN_INDEX, COLUMN_MAG1, COLUMN_MAG2, COLUMN_MAG1_VALID, COLUMN_MAG2_VALID,
+    COLUMN_FRAME_ID, COLUMN_SYS_STAT, COLUMN_MAG1_STAT, COLUMN_MAG2_STAT,
+    COLUMN_AUX_X, COLUMN_AUX_Y, COLUMN_AUX_Z, COLUMN_AUX_T,
+    COLUMN_ADC0, COLUMN_ADC1, COLUMN_ADC2, COLUMN_ADC3
+  };
+
+static PyObject *Columns_GetColumn (PyObject *self, void *closure)
+{
+  SampleColumns &columns = *((ColumnsObject *)self)->mColumns;
+  switch ((ColumnId)(intptr_t)closure)
+    {
+    case COLUMN_INDEX:      return NewColumn (self, columns.mIndex);
+    case COLUMN_MAG1:       return NewColumn (self, columns.mMag1);
+    case COLUMN_MAG2:       return NewColumn (self, columns.mMag2);
+    case COLUMN_MAG1_VALID: return NewColumn (self, columns.mMag1Valid);
+    case COLUMN_MAG2_VALID: return NewColumn (self, columns.mMag2Valid);
+    case COLUMN_FRAME_ID:   return NewColumn (self, columns.mFrameId);
+    case COLUMN_SYS_STAT:   return NewColumn (self, columns.mSysStat);
+    case COLUMN_MAG1_STAT:  return NewColumn (self, columns.mMag1Stat);
+    case COLUMN_MAG2_STAT:  return NewColumn (self, columns.mMag2Stat);
+    case COLUMN_AUX_X:      return NewColumn (self, columns.mAux[0]);
+    case COLUMN_AUX_Y:      return NewColumn (self, columns.mAux[1]);
+    case COLUMN_AUX_Z:      return NewColumn (self, columns.mAux[2]);
+    case COLUMN_AUX_T:      return NewColumn (self, columns.mAux[3]);
+    case COLUMN_ADC0:       return NewColumn (self, columns.mAdc[0]);
+    case COLUMN_ADC1:       return NewColumn (self, columns.mAdc[1]);
+    case COLUMN_ADC2:       return NewColumn (self, columns.mAdc[2]);
+    case COLUMN_ADC3:       return NewColumn (self, columns.mAdc[3]);
+    }
+  Py_RETURN_NONE;
+}
+
+#define COLUMN_GETTER(NAME, ID, DOC) \
+  { (char *)NAME, Columns_GetColumn, NULL, (char *)DOC, (void *)(intptr_t)ID }
+
+static PyGetSetDef ColumnsGetSet[] =
+  {
+    COLUMN_GETTER ("index", COLUMN_INDEX, "Packet index of each sample (uint64)"),
+    COLUMN_GETTER ("mag1", COLUMN_MAG1, "Sensor 1, LSBs (uint32); multiply by NANOTESLAS_PER_LSB for nT"),
+    COLUMN_GETTER ("mag2", COLUMN_MAG2, "Sensor 2, LSBs (uint32)"),
+    COLUMN_GETTER ("mag1_valid", COLUMN_MAG1_VALID, "1 if mag1 is valid and not in the dead zone (uint8)"),
+    COLUMN_GETTER ("mag2_valid", COLUMN_MAG2_VALID, "1 if mag2 is valid and not in the dead zone (uint8)"),
+    COLUMN_GETTER ("frame_id", COLUMN_FRAME_ID, "MFAM frameid (uint16)"),
+    COLUMN_GETTER ("sys_stat", COLUMN_SYS_STAT, "MFAM sysstat (uint16)"),
+    COLUMN_GETTER ("mag1_stat", COLUMN_MAG1_STAT, "MFAM mag1stat (uint16)"),
+    COLUMN_GETTER ("mag2_stat", COLUMN_MAG2_STAT, "MFAM mag2stat (uint16)"),
+    COLUMN_GETTER ("aux_x", COLUMN_AUX_X, "MFAM auxsenx (uint16)"),
+    COLUMN_GETTER ("aux_y", COLUMN_AUX_Y, "MFAM auxseny (uint16)"),
+    COLUMN_GETTER ("aux_z", COLUMN_AUX_Z, "MFAM auxsenz (uint16)"),
+    COLUMN_GETTER ("aux_t", COLUMN_AUX_T, "MFAM auxsent (uint16)"),
+    COLUMN_GETTER ("adc0", COLUMN_ADC0, "ADC channel 0 (uint16)"),
+    COLUMN_GETTER ("adc1", COLUMN_ADC1, "ADC channel 1 (uint16)"),
+    COLUMN_GETTER ("adc2", COLUMN_ADC2, "ADC channel 2 (uint16)"),
+    COLUMN_GETTER ("adc3", COLUMN_ADC3, "ADC channel 3 (uint16)"),
+    { NULL, NULL, NULL, NULL, NULL }
+  };
+
+/* ---------------------------------------------------------------------
+   Recording: random access to a file
+   --------------------------------------------------------------------- */
+
+/* The reader is used with the interpreter lock released, so mLock
+   guards it: read, close and __init__ take it, and none of them calls
+   into Python while holding it. */
+typedef struct
+{
+  PyObject_HEAD
+  RecordingReader *mReader;
+  std::mutex      *mLock;
+} RecordingObject;
+
+static PyTypeObject RecordingType;
+
+static PyObject *Recording_New (PyTypeObject *type, PyObject *args, PyObject *keywords)
+{
+  PyObject *self = PyType_GenericNew (type, args, keywords);
+  if (self != NULL)
+    {
+      ((RecordingObject *)self)->mLock = new std::mutex;
+    }
+  return self;
+}
+
+static int Recording_Init (PyObject *self, PyObject *args, PyObject *keywords)
+{
+  static const char *keywordList[] = { "path", NULL };
+  PyObject *pathObject = NULL;
+  if (!PyArg_ParseTupleAndKeywords (args, keywords, "O&", (char **)keywordList,
+				    PyUnicode_FSConverter, &pathObject))
+    {
+      return -1;
+    }
+  std::string path (PyBytes_AS_STRING (pathObject));
+  Py_DECREF (pathObject);
+
+  RecordingObject *recording = (RecordingObject *)self;
+  bool opened;
+  Py_BEGIN_ALLOW_THREADS
+  {
+    std::lock_guard<std::mutex> guard (*recording->mLock);
+    delete recording->mReader;
+    recording->mReader = new RecordingReader;
+    opened = recording->mReader->Open (path);
+  }
+  Py_END_ALLOW_THREADS
+  if (!opened)
+    {
+      PyErr_Format (PyExc_OSError, "can't open recording %s", path.c_str ());
+      return -1;
+    }
+  return 0;
+}
+
+static void Recording_Dealloc (PyObject *self)
+{
+  delete ((RecordingObject *)self)->mReader;
+  delete ((RecordingObject *)self)->mLock;
+  Py_TYPE (self)->tp_free (self);
+}
+
+/* Call with mLock held. */
+static bool RecordingIsOpen (const RecordingObject *recording)
+{
+  return (recording->mReader != NULL) && recording->mReader->IsOpen ();
+}
+
+static PyObject *RecordingNotOpen ()
+{
+  PyErr_SetString (PyExc_ValueError, "recording is not open");
+  return NULL;
+}
+
+static PyObject *Recording_Read (PyObject *self, PyObject *args, PyObject *keywords)
+{
+  RecordingObject *recording = (RecordingObject *)self;
+  static const char *keywordList[] = { "first", "end", NULL };
+  PyObject *firstObject = NULL;
+  PyObject *endObject = NULL;
+  if (!PyArg_ParseTupleAndKeywords (args, keywords, "|OO", (char **)keywordList, &firstObject, &endObject))
+    {
+      return NULL;
+    }
+  unsigned long long first = 0, end = 0;
+  if ((firstObject != NULL) &&
+      (((first = PyLong_AsUnsignedLongLong (firstObject)) == (unsigned long long)-1) && PyErr_Occurred ()))
+    {
+      return NULL;
+    }
+  if ((endObject != NULL) &&
+      (((end = PyLong_AsUnsignedLongLong (endObject)) == (unsigned long long)-1) && PyErr_Occurred ()))
+    {
+      return NULL;
+    }
+
+  SampleColumns *columns = new SampleColumns;
+  bool isOpen;
+  Py_BEGIN_ALLOW_THREADS
+  {
+    std::lock_guard<std::mutex> guard (*recording->mLock);
+    isOpen = RecordingIsOpen (recording);
+    if (isOpen)
+      {
+	first = (firstObject != NULL) ? first : recording->mReader->FirstIndex ();
+	end = (endObject != NULL) ? end : recording->mReader->EndIndex ();
+	std::vector<BlockSlice> slices;
+	uint64_t found = recording->mReader->Slices (first, end, slices);
+	columns->Reserve (found);
+	for (const BlockSlice &slice : slices)
+	  {
+	    columns->Append (*slice.mBlock, slice.mFirstSample, slice.mCount);
+	  }
+      }
+  }
+  Py_END_ALLOW_THREADS
+  if (!isOpen)
+    {
+      delete columns;
+      return RecordingNotOpen ();
+    }
+  return NewColumns (columns);
+}
+
+static PyObject *Recording_Close (PyObject *self, PyObject * /* unused */)
+{
+  RecordingObject *recording = (RecordingObject *)self;
+  Py_BEGIN_ALLOW_THREADS
+  {
+    std::lock_guard<std::mutex> guard (*recording->mLock);
+    if (recording->mReader != NULL)
+      {
+	recording->mReader->Close ();
+      }
+  }
+  Py_END_ALLOW_THREADS
+  Py_RETURN_NONE;
+}
+
+static PyObject *Recording_Enter (PyObject *self, PyObject * /* unused */)
+{
+  Py_INCREF (self);
+  return self;
+}
+
+static PyObject *Recording_Exit (PyObject *self, PyObject * /* args */)
+{
+  return Recording_Close (self, NULL);
+}
+
+static PyMethodDef RecordingMethods[] =
+  {
+    { "read", (PyCFunction)(void (*) (void))Recording_Read, METH_VARARGS | METH_KEYWORDS,
+      "read(first=first_index, end=end_index) -> Columns\n"
+      "Decode the 1000Hz samples with packet indices first ... end - 1.\n"
+      "Samples missing from the recording are left out; see Columns.index." },
+    { "close", Recording_Close, METH_NOARGS, "Unmap the file." },
+    { "__enter__", Recording_Enter, METH_NOARGS, NULL },
+    { "__exit__", Recording_Exit, METH_VARARGS, NULL },
+    { NULL, NULL, 0, NULL }
+  };
+
+enum RecordingCount
+  {
+    RECORDING_FIRST_INDEX, RECORDING_END_INDEX, RECORDING_BLOCKS, RECORDING_DECIMATED,
+    RECORDING_HEARTBEATS, RECORDING_GRADIOMETER, RECORDING_UNREADABLE
+  };
+
+static PyObject *Recording_GetCount (PyObject *self, void *closure)
+{
+  RecordingObject *recording = (RecordingObject *)self;
+  bool isOpen;
+  unsigned long long value = 0;
+  Py_BEGIN_ALLOW_THREADS
+  {
+    std::lock_guard<std::mutex> guard (*recording->mLock);
+    isOpen = RecordingIsOpen (recording);
+    if (isOpen)
+      {
+	const RecordingReader &reader = *recording->mReader;
+	switch ((RecordingCount)(intptr_t)closure)
+	  {
+	  case RECORDING_FIRST_INDEX: value = reader.FirstIndex (); break;
+	  case RECORDING_END_INDEX:   value = reader.EndIndex (); break;
+	  case RECORDING_BLOCKS:      value = reader.BlockCount (); break;
+	  case RECORDING_DECIMATED:   value = reader.DecimatedCount (); break;
+	  case RECORDING_HEARTBEATS:  value = reader.HeartbeatCount (); break;
+	  case RECORDING_GRADIOMETER: value = reader.GradiometerCount (); break;
+	  case RECORDING_UNREADABLE:  value = reader.UnreadableBytes (); break;
+	  }
+      }
+  }
+  Py_END_ALLOW_THREADS
+  if (!isOpen)
+    {
+      return RecordingNotOpen ();
+    }
+  return PyLong_FromUnsignedLongLong (value);
+}
+
+#define COUNT_GETTER(NAME, ID, DOC) \
+  { (char *)NAME, Recording_GetCount, NULL, (char *)DOC, (void *)(intptr_t)ID }
+
+static PyGetSetDef RecordingGetSet[] =
+  {
+    COUNT_GETTER ("first_index", RECORDING_FIRST_INDEX, "Packet index of the first sample"),
+    COUNT_GETTER ("end_index", RECORDING_END_INDEX, "One past the packet index of the last sample"),
+    COUNT_GETTER ("block_count", RECORDING_BLOCKS, "Number of 1000Hz blocks"),
+    COUNT_GETTER ("decimated_count", RECORDING_DECIMATED, "Number of decimated records"),
+    COUNT_GETTER ("heartbeat_count", RECORDING_HEARTBEATS, "Number of heartbeat records"),
+    COUNT_GETTER ("gradiometer_count", RECORDING_GRADIOMETER, "Number of gradiometer records"),
+    COUNT_GETTER ("unreadable_bytes", RECORDING_UNREADABLE, "Bytes that are not part of any record"),
+    { NULL, NULL, NULL, NULL, NULL }
+  };
+
+/* ---------------------------------------------------------------------
+   StreamDecoder: records as they arrive
+   --------------------------------------------------------------------- */
+
+/* Splits incoming bytes into records.  A valid header where a record is
+   expected is taken at once.  Bytes that are not part of a record are
+   skipped, and after them a header is taken only when the one that
+   follows its record confirms it (see FindNextRecord). */
+struct StreamState
+{
+  std::mutex               mLock;
+  std::vector<uint8_t>     mPending;   /* Start of a record not yet complete */
+  std::unique_ptr<SampleColumns> mColumns { new SampleColumns };
+  uint64_t                 mBlocks = 0;
+  uint64_t                 mDecimated = 0;
+  uint64_t                 mHeartbeats = 0;
+  uint64_t                 mSkippedBytes = 0;
+
+  void Feed (const uint8_t *data, size_t length);
+  void Reset ();
+
+private:
+  size_t Consume (const uint8_t *data, size_t length);
+};
+
+/* \brief Decode the whole records at the start of data.
+   \return  The number of bytes used. */
+size_t StreamState::Consume (const uint8_t *data, size_t length)
+{
+  size_t offset = 0;
+  while (offset + sizeof (RecordHeader) <= length)
+    {
+      if (!IsValidRecordHeader (data + offset))
+	{
+	  uint64_t next = FindNextRecord (data, length, offset + 1);
+	  if (next == length)
+	    {
+	      /* Keep enough for a record and the header that confirms it. */
+	      size_t keep = MAX_RECORD_LENGTH + sizeof (RecordHeader);
+	      if (length - offset > keep)
+		{
+		  mSkippedBytes += length - offset - keep;
+		  offset = length - keep;
+		}
+	      return offset;
+	    }
+	  mSkippedBytes += next - offset;
+	  offset = next;
+	  continue;
+	}
+      RecordHeader header;
+      memcpy (&header, data + offset, sizeof (header));
+      if (offset + header.mRecordSize > length)
+	{
+	  break;
+	}
+      switch (header.mRecordType)
+	{
+	case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+	  mColumns->Append (*(const StreamerPacket *)(data + offset), 0, MFAM_STREAMER_CACHE_SIZE);
+	  mBlocks++;
+	  break;
+	case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+	  mDecimated++;
+	  break;
+	case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+	  mHeartbeats++;
+	  break;
+	}
+      offset += header.mRecordSize;
+    }
+  return offset;
+}
+
+void StreamState::Feed (const uint8_t *data, size_t length)
+{
+  std::lock_guard<std::mutex> guard (mLock);
+  /* Without a partial record waiting, decode straight from the caller's
+     buffer and keep only what is left over. */
+  if (mPending.empty ())
+    {
+      size_t used = Consume (data, length);
+      mPending.assign (data + used, data + length);
+      return;
+    }
+  mPending.insert (mPending.end (), data, data + length);
+  size_t used = Consume (mPending.data (), mPending.size ());
+  mPending.erase (mPending.begin (), mPending.begin () + used);
+}
+
+void StreamState::Reset ()
+{
+  std::lock_guard<std::mutex> guard (mLock);
+  mPending.clear ();
+  mColumns.reset (new SampleColumns);
+  mBlocks = 0;
+  mDecimated = 0;
+  mHeartbeats = 0;
+  mSkippedBytes = 0;
+}
+
+typedef struct
+{
+  PyObject_HEAD
+  StreamState *mState;
+} StreamDecoderObject;
+
+static PyTypeObject StreamDecoderType;
+
+static int StreamDecoder_Init (PyObject *self, PyObject *args, PyObject * /* keywords */)
+{
+  if (!PyArg_ParseTuple (args, ""))
+    {
+      return -1;
+    }
+  StreamDecoderObject *decoder = (StreamDecoderObject *)self;
+  if (decoder->mState == NULL)
+    {
+      decoder->mState = new StreamState;
+    }
+  else
+    {
+      /* Another thread may be feeding it, so start it over in place. */
+      Py_BEGIN_ALLOW_THREADS
+      decoder->mState->Reset ();
+      Py_END_ALLOW_THREADS
+    }
+  return 0;
+}
+
+/* \return  The decoder's state, or NULL, with ValueError set, for an
+   object made without __init__. */
+static StreamState *StreamDecoderState (PyObject *self)
+{
+  StreamState *state = ((StreamDecoderObject *)self)->mState;
+  if (state == NULL)
+    {
+      PyErr_SetString (PyExc_ValueError, "stream decoder is not initialized");
+    }
+  return state;
+}
+
+static void StreamDecoder_Dealloc (PyObject *self)
+{
+  delete ((StreamDecoderObject *)self)->mState;
+  Py_TYPE (self)->tp_free (self);
+}
+
+static PyObject *StreamDecoder_Feed (PyObject *self, PyObject *argument)
+{
+  StreamState *state = StreamDecoderState (self);
+  if (state == NULL)
+    {
+      return NULL;
+    }
+  Py_buffer input;
+  if (PyObject_GetBuffer (argument, &input, PyBUF_SIMPLE) != 0)
+    {
+      return NULL;
+    }
+  Py_BEGIN_ALLOW_THREADS
+  state->Feed ((const uint8_t *)input.buf, (size_t)input.len);
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release (&input);
+  Py_RETURN_NONE;
+}
+
+static PyObject *StreamDecoder_Take (PyObject *self, PyObject * /* unused */)
+{
+  StreamState *state = StreamDecoderState (self);
+  if (state == NULL)
+    {
+      return NULL;
+    }
+  SampleColumns *columns;
+  Py_BEGIN_ALLOW_THREADS
+  {
+    std::lock_guard<std::mutex> guard (state->mLock);
+    columns = state->mColumns.release ();
+    state->mColumns.reset (new SampleColumns);
+  }
+  Py_END_ALLOW_THREADS
+  return NewColumns (columns);
+}
+
+static PyMethodDef StreamDecoderMethods[] =
+  {
+    { "feed", StreamDecoder_Feed, METH_O,
+      "feed(data)\nDecode the records in data (bytes, bytearray, memoryview...),\n"
+      "which continues whatever was fed before." },
+    { "take", StreamDecoder_Take, METH_NOARGS,
+      "take() -> Columns\nThe samples decoded since the last take()." },
+    { NULL, NULL, 0, NULL }
+  };
+
+enum StreamCount { STREAM_BLOCKS, STREAM_DECIMATED, STREAM_HEARTBEATS, STREAM_SKIPPED };
+
+static PyObject *StreamDecoder_GetCount (PyObject *self, void *closure)
+{
+  StreamState *state = StreamDecoderState (self);
+  if (state == NULL)
+    {
+      return NULL;
+    }
+  std::lock_guard<std::mutex> guard (state->mLock);
+  unsigned long long value = 0;
+  switch ((StreamCount)(intptr_t)closure)
+    {
+    case STREAM_BLOCKS:     value = state->mBlocks; break;
+    case STREAM_DECIMATED:  value = state->mDecimated; break;
+    case STREAM_HEARTBEATS: value = state->mHeartbeats; break;
+    case STREAM_SKIPPED:    value = state->mSkippedBytes; break;
+    }
+  return PyLong_FromUnsignedLongLong (value);
+}
+
+static PyGetSetDef StreamDecoderGetSet[] =
+  {
+    { (char *)"block_count", StreamDecoder_GetCount, NULL, (char *)"1000Hz blocks decoded",
+      (void *)(intptr_t)STREAM_BLOCKS },
+    { (char *)"decimated_count", StreamDecoder_GetCount, NULL, (char *)"Decimated records seen",
+      (void *)(intptr_t)STREAM_DECIMATED },
+    { (char *)"heartbeat_count", StreamDecoder_GetCount, NULL, (char *)"Heartbeat records seen",
+      (void *)(intptr_t)STREAM_HEARTBEATS },
+    { (char *)"skipped_bytes", StreamDecoder_GetCount, NULL, (char *)"Bytes that were not part of a record",
+      (void *)(intptr_t)STREAM_SKIPPED },
+    { NULL, NULL, NULL, NULL, NULL }
+  };
+
+/* ---------------------------------------------------------------------
+   Module
+   --------------------------------------------------------------------- */
+
+static struct PyModuleDef MagElementModule =
+  {
+    PyModuleDef_HEAD_INIT,
+    "magelement",
+    "Readers for MagElement recordings and data streams, with decoded\n"
+    "columns that numpy can use without copying.",
+    -1,
+    NULL, NULL, NULL, NULL, NULL
+  };
+
+static bool ReadyType (PyTypeObject &type, const char *name, size_t size, const char *doc)
+{
+  static const PyVarObject heads[] = { PyVarObject_HEAD_INIT (NULL, 0) };
+  type.ob_base = heads[0];
+  type.tp_name = name;
+  type.tp_basicsize = (Py_ssize_t)size;
+  type.tp_flags = Py_TPFLAGS_DEFAULT;
+  type.tp_doc = doc;
+  return PyType_Ready (&type) == 0;
+}
+
+PyMODINIT_FUNC PyInit_magelement (void)
+{
+  ColumnSequenceMethods.sq_length = Column_Length;
+  ColumnsSequenceMethods.sq_length = Columns_Length;
+  ColumnType.tp_dealloc = Column_Dealloc;
+  ColumnType.tp_as_buffer = &ColumnBufferProcs;
+  ColumnType.tp_as_sequence = &ColumnSequenceMethods;
+  ColumnsType.tp_dealloc = Columns_Dealloc;
+  ColumnsType.tp_getset = ColumnsGetSet;
+  ColumnsType.tp_as_sequence = &ColumnsSequenceMethods;
+  RecordingType.tp_new = Recording_New;
+  RecordingType.tp_init = Recording_Init;
+  RecordingType.tp_dealloc = Recording_Dealloc;
+  RecordingType.tp_methods = RecordingMethods;
+  RecordingType.tp_getset = RecordingGetSet;
+  StreamDecoderType.tp_new = PyType_GenericNew;
+  StreamDecoderType.tp_init = StreamDecoder_Init;
+  StreamDecoderType.tp_dealloc = StreamDecoder_Dealloc;
+  StreamDecoderType.tp_methods = StreamDecoderMethods;
+  StreamDecoderType.tp_getset = StreamDecoderGetSet;
+
+  if (!ReadyType (ColumnType, "magelement.Column", sizeof (ColumnObject),
+		  "One decoded column; supports the buffer protocol (read-only).") ||
+      !ReadyType (ColumnsType, "magelement.Columns", sizeof (ColumnsObject),
+		  "Decoded 1000Hz samples, one column per field.") ||
+      !ReadyType (RecordingType, "magelement.Recording", sizeof (RecordingObject),
+		  "Recording(path)\nRandom access to a recording by packet index.") ||
+      !ReadyType (StreamDecoderType, "magelement.StreamDecoder", sizeof (StreamDecoderObject),
+		  "StreamDecoder()\nDecodes records from bytes fed to it as they arrive."))
+    {
+      return NULL;
+    }
+
+  PyObject *module = PyModule_Create (&MagElementModule);
+  if (module == NULL)
+    {
+      return NULL;
+    }
+  Py_INCREF (&ColumnsType);
+  Py_INCREF (&RecordingType);
+  Py_INCREF (&StreamDecoderType);
+  if ((PyModule_AddObject (module, "Columns", (PyObject *)&ColumnsType) != 0) ||
+      (PyModule_AddObject (module, "Recording", (PyObject *)&RecordingType) != 0) ||
+      (PyModule_AddObject (module, "StreamDecoder", (PyObject *)&StreamDecoderType) != 0) ||
+      (PyModule_AddObject (module, "NANOTESLAS_PER_LSB", PyFloat_FromDouble (MFAM_NANOTESLAS_PER_LSB)) != 0))
+    {
+      Py_DECREF (module);
+      return NULL;
+    }
+  return module;
+}
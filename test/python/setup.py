@@ -0,0 +1,34 @@
+# Build the magelement Python module from the test program's sources:
+#
+#     cd test/python
+#     python setup.py build_ext --inplace
+#
+# See magelement.cpp for what the module provides.
+import sys
+from setuptools import setup, Extension
+
+if sys.platform == "win32":
+    compile_args = ["/std:c++17", "/O2"]
+else:
+    compile_args = ["-std=c++17", "-O2"]
+
+setup(
+    name = "magelement",
+    version = "1.2.3",
+    description = "Readers for MagElement recordings and data streams",
+    ext_modules = [
+        Extension(
+            "magelement",
+            sources = [
+                "magelement.cpp",
+                "../src/RecordingReader.cpp",
+                "../src/MappedFile.cpp",
+                "../src/RecordUtilities.cpp",
+                "../src/DecodedColumns.cpp",
+            ],
+            include_dirs = ["../src", "../include"],
+            extra_compile_args = compile_args,
+            language = "c++",
+        )
+    ],
+)
@@ -0,0 +1,222 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cmath>
+#include <cstring>
+#include "DecodedColumns.hpp"
+#include "AnomalyDetector.hpp"
+
+AnomalyDetector::AnomalyDetector (uint16_t channel, uint32_t windowLength, uint32_t backgroundLength, double factor)
+  : mChannel (channel),
+    mWindowLength (windowLength > 0 ? windowLength : 1),
+    mBackgroundLength (backgroundLength > 0 ? backgroundLength : 1),
+    mFactor (factor),
+    mAlpha (1.0 / mBackgroundLength),
+    mSamples ((size_t)mWindowLength + mBackgroundLength, 0),
+    mSquares (mWindowLength, 0.0)
+{
+}
+
+bool AnomalyDetector::Add (uint64_t packetIndex, uint32_t value, AnomalyPacket &packet)
+{
+  /* The sample leaving the background is the one whose slot is reused;
+     the one entering it is windowLength samples old.  During an event the
+     background is held: the entering sample is replaced by the current
+     mean, so that the anomaly itself doesn't drag the trend after it. */
+  uint64_t sequence = mSeen++;
+  uint64_t ringLength = mSamples.size ();
+  uint32_t held = (uint32_t)((mBackgroundSum + mBackgroundLength / 2) / mBackgroundLength);
+  if (sequence >= ringLength)
+    {
+      mBackgroundSum -= mSamples[sequence % ringLength];
+    }
+  mSamples[sequence % ringLength] = value;
+  if (sequence >= mWindowLength)
+    {
+      uint32_t &entering = mSamples[(sequence - mWindowLength) % ringLength];
+      if (mInEvent)
+	{
+	  entering = held;
+	}
+      mBackgroundSum += entering;
+    }
+  if (sequence + 1 < ringLength)
+    {
+      return false;
+    }
+
+  double detrended = (double)value - (double)mBackgroundSum / mBackgroundLength;
+  uint64_t square = sequence + 1 - ringLength;
+  uint32_t slot = square % mWindowLength;
+  if (square >= mWindowLength)
+    {
+      mEnergy -= mSquares[slot];
+    }
+  mSquares[slot] = detrended * detrended;
+  mEnergy += mSquares[slot];
+  if (slot == mWindowLength - 1)
+    {
+      Recompute ();
+    }
+  if (square + 1 < mWindowLength)
+    {
+      return false;
+    }
+  double rms = std::sqrt ((mEnergy > 0.0 ? mEnergy : 0.0) / mWindowLength);
+
+  if (mInEvent)
+    {
+      if (rms <= mEventEnd)
+	{
+	  FillPacket (packet, false);
+	  mInEvent = false;
+	  return true;
+	}
+      mEventWidth++;
+      if (std::fabs (detrended) > std::fabs (mPeakValue))
+	{
+	  mPeakValue = detrended;
+	  mPeakIndex = packetIndex;
+	}
+      if (rms > mPeakRms)
+	{
+	  mPeakRms = rms;
+	}
+      if (mEventWidth >= mBackgroundLength)
+	{
+	  FillPacket (packet, true);
+	  mInEvent = false;
+	  return true;
+	}
+      return false;
+    }
+
+  /* The level has settled once it has seen a background's worth of the
+     statistic; until then it is a plain mean. */
+  double threshold = mLevel + mFactor * mSpread;
+  if (mSettled && (rms > threshold))
+    {
+      mInEvent = true;
+      mEventFirst = packetIndex;
+      mEventWidth = 1;
+      mPeakIndex = packetIndex;
+      mPeakValue = detrended;
+      mPeakRms = rms;
+      mEventThreshold = threshold;
+      mEventEnd = mLevel + ANOMALY_END_FRACTION * (threshold - mLevel);
+      return false;
+    }
+  mLevelCount++;
+  double weight = mSettled ? mAlpha : 1.0 / mLevelCount;
+  mLevel += weight * (rms - mLevel);
+  mSpread += weight * (std::fabs (rms - mLevel) - mSpread);
+  if (mLevelCount >= mBackgroundLength)
+    {
+      mSettled = true;
+    }
+  return false;
+}
+
+void AnomalyDetector::Recompute ()
+{
+  double sum = 0.0;
+  for (double square : mSquares)
+    {
+      sum += square;
+    }
+  mEnergy = sum;
+}
+
+bool AnomalyDetector::Restart (AnomalyPacket &packet)
+{
+  bool wasOpen = mInEvent;
+  if (wasOpen)
+    {
+      FillPacket (packet, false);
+    }
+  /* The noise level carries over; the background starts again. */
+  mInEvent = false;
+  mSeen = 0;
+  mBackgroundSum = 0;
+  mEnergy = 0.0;
+  return wasOpen;
+}
+
+void AnomalyDetector::FillPacket (AnomalyPacket &packet, bool truncated)
+{
+  memset (&packet, 0, sizeof (packet));
+  packet.mRecordType = GM_MAG_ELEMENT_ANOMALY_FORMAT;
+  packet.mRecordSize = sizeof (AnomalyPacket);
+  packet.mFirstPacketIndex = mEventFirst;
+  packet.mPeakPacketIndex = mPeakIndex;
+  packet.mWidth = mEventWidth;
+  packet.mChannel = mChannel;
+  packet.mFlags = truncated ? ANOMALY_FLAG_TRUNCATED : 0;
+  packet.mPeakAmplitude = MAG_DATA_AS_FLOAT (mPeakValue);
+  packet.mPeakRms = MAG_DATA_AS_FLOAT (mPeakRms);
+  packet.mThreshold = MAG_DATA_AS_FLOAT (mEventThreshold);
+}
+
+
+AnomalyProcessor::AnomalyProcessor (uint32_t windowLength, uint32_t backgroundLength, double factor)
+  : mMag1 (1, windowLength, backgroundLength, factor),
+    mMag2 (2, windowLength, backgroundLength, factor)
+{
+}
+
+void AnomalyProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodedRawBlock decoded;
+  DecodeRawBlock (streamerPacket, decoded);
+
+  /* Windows never span a gap in the input. */
+  if (mHaveIndex && (decoded.mFirstPacketIndex != mNextIndex))
+    {
+      Finish ();
+    }
+  mHaveIndex = true;
+  mNextIndex = decoded.mFirstPacketIndex + MFAM_STREAMER_CACHE_SIZE;
+
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      uint64_t packetIndex = decoded.mFirstPacketIndex + index;
+      if (decoded.mMag1Valid[index] && mMag1.Add (packetIndex, decoded.mMag1[index], mPacket))
+	{
+	  Emit (&mPacket, sizeof (mPacket));
+	}
+      if (decoded.mMag2Valid[index] && mMag2.Add (packetIndex, decoded.mMag2[index], mPacket))
+	{
+	  Emit (&mPacket, sizeof (mPacket));
+	}
+    }
+}
+
+void AnomalyProcessor::Finish ()
+{
+  if (mMag1.Restart (mPacket))
+    {
+      Emit (&mPacket, sizeof (mPacket));
+    }
+  if (mMag2.Restart (mPacket))
+    {
+      Emit (&mPacket, sizeof (mPacket));
+    }
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef ANOMALY_DETECTOR_HPP
+#define ANOMALY_DETECTOR_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "DerivedRecords.hpp"
+#include "RecordProcessor.hpp"
+
+/* Fraction of the way from the noise level back down to the threshold at
+   which an event ends; below 1, so that noise at the threshold doesn't
+   split one anomaly into many events. */
+#define ANOMALY_END_FRACTION 0.5
+
+/* Finds anomalies in one mag channel as the samples arrive.
+
+   The background is the mean of the backgroundLength samples before the
+   most recent windowLength, and each sample is detrended by subtracting
+   it; the background is held while an event is open.  The statistic is the RMS of the detrended samples over the most
+   recent windowLength: the energy that a nearby magnetic object adds on
+   top of the slowly varying field.  The noise level of the statistic and
+   its spread (mean absolute deviation) are followed with exponential
+   averages over backgroundLength samples, only while no event is open,
+   and an event begins when the statistic rises above level + factor *
+   spread.  It ends when the statistic falls back, or is cut short after
+   backgroundLength samples, so every event is reported within
+   backgroundLength + windowLength samples of its start.
+
+   Each sample costs O(1): running sums over rings, with the sum of
+   squares recomputed once per window so that rounding can't build up. */
+class AnomalyDetector
+{
+public:
+  AnomalyDetector (uint16_t channel, uint32_t windowLength, uint32_t backgroundLength, double factor);
+
+  /* \brief Take the next sample, in LSBs.
+     \return  true if an event ended, described in packet. */
+  bool Add (uint64_t packetIndex, uint32_t value, AnomalyPacket &packet);
+
+  /* \brief Close any open event, and start again; at a gap in the data.
+     \return  true if an event was open, described in packet. */
+  bool Restart (AnomalyPacket &packet);
+
+private:
+  void FillPacket (AnomalyPacket &packet, bool truncated);
+  void Recompute ();
+
+  uint16_t              mChannel;
+  uint32_t              mWindowLength;
+  uint32_t              mBackgroundLength;
+  double                mFactor;
+  double                mAlpha;         /* Weight of each sample in the level and spread */
+
+  std::vector<uint32_t> mSamples;       /* Ring of windowLength + backgroundLength samples */
+  std::vector<double>   mSquares;       /* Ring of windowLength squared detrended samples */
+  uint64_t              mSeen = 0;
+  int64_t               mBackgroundSum = 0;
+  double                mEnergy = 0.0;
+
+  uint64_t              mLevelCount = 0;
+  bool                  mSettled = false;
+  double                mLevel = 0.0;
+  double                mSpread = 0.0;
+
+  /* Event in progress */
+  bool                  mInEvent = false;
+  uint64_t              mEventFirst = 0;
+  uint32_t              mEventWidth = 0;
+  uint64_t              mPeakIndex = 0;
+  double                mPeakValue = 0.0;
+  double                mPeakRms = 0.0;
+  double                mEventThreshold = 0.0;
+  double                mEventEnd = 0.0;
+};
+
+/* Runs an AnomalyDetector on each of mag1 and mag2 of the 1000Hz blocks,
+   leaving out invalid and dead-zone samples, and emits an AnomalyPacket
+   for each event. */
+class AnomalyProcessor : public RecordProcessor
+{
+public:
+  AnomalyProcessor (uint32_t windowLength, uint32_t backgroundLength, double factor);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void Finish () override;
+
+private:
+  AnomalyDetector mMag1;
+  AnomalyDetector mMag2;
+  bool            mHaveIndex = false;
+  uint64_t        mNextIndex = 0;
+  AnomalyPacket   mPacket;
+};
+
+#endif
@@ -0,0 +1,262 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Checksum.hpp"
+#include "MappedFile.hpp"
+#include "RecordUtilities.hpp"
+#include "RecordValidation.hpp"
+#include "WorkStealingPool.hpp"
+#include "BatchCheck.hpp"
+
+/* One file of the batch, and the results for each of its chunks. */
+struct FileCheckJob
+{
+  std::string                   mFileName;
+  MappedFile                    mFile;
+  bool                          mOpened = false;
+  uint64_t                      mSize = 0;
+  uint64_t                      mChunkBytes = 0;
+  std::vector<RecordValidation> mChunks;
+  std::atomic<uint32_t>         mRemaining {0};
+  RecordValidation              mResult;
+};
+
+/* \brief Match text against a pattern in which * stands for any run of
+   characters and ? for any one character. */
+static bool WildcardMatch (const char *pattern, const char *text)
+{
+  const char *star = nullptr;
+  const char *resume = nullptr;
+  while (*text != '\0')
+    {
+      if ((*pattern == '?') || (*pattern == *text))
+	{
+	  pattern++;
+	  text++;
+	}
+      else if (*pattern == '*')
+	{
+	  star = pattern++;
+	  resume = text;
+	}
+      else if (star != nullptr)
+	{
+	  pattern = star + 1;
+	  text = ++resume;
+	}
+      else
+	{
+	  return false;
+	}
+    }
+  while (*pattern == '*')
+    {
+      pattern++;
+    }
+  return *pattern == '\0';
+}
+
+std::vector<std::string> ListFiles (const std::string &name)
+{
+  namespace fs = std::filesystem;
+  std::vector<std::string> files;
+  std::error_code error;
+
+  fs::path path (name);
+  std::string leaf = path.filename ().string ();
+  if (leaf.find_first_of ("*?") != std::string::npos)
+    {
+      fs::path directory = path.parent_path ();
+      if (directory.empty ())
+	{
+	  directory = ".";
+	}
+      for (const auto &entry : fs::directory_iterator (directory, error))
+	{
+	  if (entry.is_regular_file (error) &&
+	      WildcardMatch (leaf.c_str (), entry.path ().filename ().string ().c_str ()))
+	    {
+	      files.push_back (entry.path ().string ());
+	    }
+	}
+    }
+  else if (fs::is_directory (path, error))
+    {
+      for (const auto &entry : fs::directory_iterator (path, error))
+	{
+	  if (entry.is_regular_file (error))
+	    {
+	      files.push_back (entry.path ().string ());
+	    }
+	}
+    }
+  else if (fs::is_regular_file (path, error))
+    {
+      files.push_back (name);
+    }
+  std::sort (files.begin (), files.end ());
+  return files;
+}
+
+/* Join the chunk results in file order, once the last chunk is done. */
+static void FinishFile (FileCheckJob &job)
+{
+  JoinChunks (job.mFile.Data (), job.mSize, job.mChunkBytes, job.mChunks, job.mResult);
+  job.mChunks.clear ();
+  job.mFile.Close ();
+}
+
+static void CheckChunk (FileCheckJob &job, uint32_t chunk)
+{
+  ValidateChunk (job.mFile.Data (), job.mSize, job.mChunkBytes, chunk, job.mChunks[chunk]);
+  if (job.mRemaining.fetch_sub (1) == 1)
+    {
+      FinishFile (job);
+    }
+}
+
+static void StartFile (WorkStealingPool &pool, FileCheckJob &job)
+{
+  if (!job.mFile.Open (job.mFileName))
+    {
+      return;
+    }
+  job.mOpened = true;
+  job.mSize = job.mFile.Size ();
+  if (job.mSize == 0)
+    {
+      job.mFile.Close ();
+      return;
+    }
+  job.mFile.AdviseSequential ();
+
+  uint32_t chunks = (uint32_t)((job.mSize + job.mChunkBytes - 1) / job.mChunkBytes);
+  job.mChunks.resize (chunks);
+  job.mRemaining.store (chunks);
+  FileCheckJob *jobPointer = &job;
+  for (uint32_t chunk = 0; chunk < chunks; chunk++)
+    {
+      pool.Submit ([jobPointer, chunk] { CheckChunk (*jobPointer, chunk); });
+    }
+}
+
+int RunBatchCheck (MagElementTestOptions &options)
+{
+  std::vector<std::string> fileNames = ListFiles (options.mFileNameToSave);
+  if (fileNames.empty ())
+    {
+      std::cerr << "\n\nError: No files match " << options.mFileNameToSave << "\n\n";
+      return 1;
+    }
+
+  uint64_t chunkBytes = (uint64_t)options.mChunkMegabytes * 1024 * 1024;
+  std::vector<std::unique_ptr<FileCheckJob>> jobs;
+  for (const std::string &fileName : fileNames)
+    {
+      auto job = std::make_unique<FileCheckJob> ();
+      job->mFileName = fileName;
+      job->mChunkBytes = chunkBytes;
+      jobs.push_back (std::move (job));
+    }
+
+  auto startTime = std::chrono::steady_clock::now ();
+  WorkStealingPool pool (options.mWorkerCount);
+  for (auto &job : jobs)
+    {
+      FileCheckJob *jobPointer = job.get ();
+      WorkStealingPool *poolPointer = &pool;
+      pool.Submit ([poolPointer, jobPointer] { StartFile (*poolPointer, *jobPointer); });
+    }
+  pool.Wait ();
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+
+  /* Consolidated report, in file name order */
+  uint64_t totalBytes = 0;
+  uint32_t clean = 0;
+  uint32_t unopened = 0;
+  uint32_t truncated = 0;
+  RecordValidation totals;
+  for (auto &job : jobs)
+    {
+      if (!job->mOpened)
+	{
+	  unopened++;
+	  std::cout << job->mFileName << ": can't be read\n";
+	  continue;
+	}
+      const RecordValidation &result = job->mResult;
+      totalBytes += job->mSize;
+      totals.mBlocks += result.mBlocks;
+      totals.mDecimated += result.mDecimated;
+      totals.mHeartbeats += result.mHeartbeats;
+      totals.mGradiometer += result.mGradiometer;
+      totals.mOtherDerived += result.mOtherDerived;
+      totals.mGapCount += result.mGapCount;
+      totals.mMissingSamples += result.mMissingSamples;
+      totals.mUnreadableCount += result.mUnreadableCount;
+      totals.mUnreadableBytes += result.mUnreadableBytes;
+      totals.mChecksums += result.mChecksums;
+      totals.mChecksumFailures += result.mChecksumFailures;
+      truncated += result.mTruncated ? 1 : 0;
+
+      bool fileClean = result.Clean () && (result.Records () > 0);
+      if (fileClean)
+	{
+	  clean++;
+	}
+      std::cout << job->mFileName << ": " << (fileClean ? "OK" : "PROBLEMS")
+		<< ", " << job->mSize << " bytes\n";
+      if (!fileClean || options.mVerboseMode)
+	{
+	  result.Report (std::cout);
+	}
+    }
+
+  std::cout << "\nBatch check: " << jobs.size () << " files, "
+	    << clean << " OK, " << jobs.size () - clean - unopened << " with problems, "
+	    << unopened << " unreadable\n"
+	    << "  " << totals.mBlocks << " 1000Hz blocks, " << totals.mDecimated << " decimated, "
+	    << totals.mHeartbeats << " heartbeats, " << totals.mGradiometer << " gradiometer, "
+	    << totals.mOtherDerived << " other derived\n"
+	    << "  " << totals.mGapCount << " index gaps (" << totals.mMissingSamples << " samples), "
+	    << totals.mUnreadableCount << " unreadable ranges (" << totals.mUnreadableBytes << " bytes), "
+	    << truncated << " truncated files\n";
+  if (totals.mChecksums > 0)
+    {
+      std::cout << "  " << totals.mChecksums << " checksums (CRC32C, " << Crc32cImplementation ()
+		<< "), " << totals.mChecksumFailures << " failed\n";
+    }
+  std::cout << "  " << totalBytes << " bytes in " << std::fixed << std::setprecision (2) << seconds
+	    << " s on " << pool.WorkerCount () << " workers ("
+	    << ((seconds > 0.0) ? totalBytes / seconds / 1e6 : 0.0) << " MB/s, "
+	    << pool.Steals () << " tasks stolen)\n";
+
+  return (clean == jobs.size ()) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef BATCH_CHECK_HPP
+#define BATCH_CHECK_HPP
+
+#include <string>
+#include <vector>
+#include "TestOptions.hpp"
+
+/* \brief -proto batch-check: validate every recording named by -file (a
+   file, a directory, or a pattern with * and ? in the file name) on a
+   pool of worker threads, splitting large files into chunks that are
+   checked in parallel, then print one report for all of them.
+   \return 0 if every file is clean, 1 if any is not. */
+int RunBatchCheck (MagElementTestOptions &options);
+
+/* \brief The regular files named by a path, a directory (not searched
+   recursively) or a pattern, sorted by name. */
+std::vector<std::string> ListFiles (const std::string &name);
+
+#endif
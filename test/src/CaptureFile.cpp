@@ -0,0 +1,607 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <iostream>
+#include "CaptureFile.hpp"
+
+/* File and block identifiers */
+#define PCAP_MAGIC_MICROSECONDS  0xA1B2C3D4
+#define PCAP_MAGIC_NANOSECONDS   0xA1B23C4D
+#define PCAP_FILE_HEADER_LENGTH  24
+#define PCAP_RECORD_HEADER_LENGTH 16
+#define PCAPNG_SECTION_HEADER    0x0A0D0D0A
+#define PCAPNG_BYTE_ORDER_MAGIC  0x1A2B3C4D
+#define PCAPNG_INTERFACE         0x00000001
+#define PCAPNG_OBSOLETE_PACKET   0x00000002
+#define PCAPNG_SIMPLE_PACKET     0x00000003
+#define PCAPNG_ENHANCED_PACKET   0x00000006
+
+/* Link-layer types */
+#define LINKTYPE_NULL            0       /* BSD loopback, host byte order */
+#define LINKTYPE_ETHERNET        1
+#define LINKTYPE_RAW_OLD         12      /* Raw IP, as some systems number it */
+#define LINKTYPE_RAW_OPENBSD     14
+#define LINKTYPE_RAW             101
+#define LINKTYPE_LOOP            108     /* OpenBSD loopback, network byte order */
+#define LINKTYPE_LINUX_SLL       113
+#define LINKTYPE_IPV4            228
+#define LINKTYPE_IPV6            229
+#define LINKTYPE_LINUX_SLL2      276
+
+#define ETHERTYPE_IPV4           0x0800
+#define ETHERTYPE_IPV6           0x86DD
+#define ETHERTYPE_VLAN           0x8100
+#define ETHERTYPE_QINQ           0x88A8
+
+static uint32_t Swap32 (uint32_t value)
+{
+  return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+/* Network byte order fields of the protocol headers */
+static uint16_t Big16 (const uint8_t *data)
+{
+  return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t Big32 (const uint8_t *data)
+{
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+bool CaptureFile::Open (const std::string &fileName)
+{
+  Close ();
+  if (!mFile.Open (fileName))
+    {
+      return false;
+    }
+  mFile.AdviseSequential ();
+
+  uint32_t magic = 0;
+  if (mFile.Size () >= sizeof (magic))
+    {
+      memcpy (&magic, mFile.Data (), sizeof (magic));
+    }
+  if (magic == PCAPNG_SECTION_HEADER)
+    {
+      mPcapNg = true;
+      if (StartSection (0))
+	{
+	  return true;
+	}
+    }
+  else if ((mFile.Size () >= PCAP_FILE_HEADER_LENGTH) &&
+	   ((magic == PCAP_MAGIC_MICROSECONDS) || (magic == PCAP_MAGIC_NANOSECONDS) ||
+	    (Swap32 (magic) == PCAP_MAGIC_MICROSECONDS) || (Swap32 (magic) == PCAP_MAGIC_NANOSECONDS)))
+    {
+      mSwapped = (magic != PCAP_MAGIC_MICROSECONDS) && (magic != PCAP_MAGIC_NANOSECONDS);
+      /* The top bits of the link type field carry FCS information. */
+      mLinkType = Read32 (20) & 0x0FFFFFFF;
+      mOffset = PCAP_FILE_HEADER_LENGTH;
+      return true;
+    }
+  std::cerr << "\n\nError: " << fileName << " is not a pcap or pcapng capture\n\n";
+  Close ();
+  return false;
+}
+
+void CaptureFile::Close ()
+{
+  mFile.Close ();
+  mOffset = 0;
+  mPcapNg = false;
+  mSwapped = false;
+  mLinkType = 0;
+  mInterfaces.clear ();
+  mUnreadableBytes = 0;
+}
+
+uint16_t CaptureFile::Read16 (uint64_t offset) const
+{
+  uint16_t value;
+  memcpy (&value, mFile.Data () + offset, sizeof (value));
+  return mSwapped ? (uint16_t)((value >> 8) | (value << 8)) : value;
+}
+
+uint32_t CaptureFile::Read32 (uint64_t offset) const
+{
+  uint32_t value;
+  memcpy (&value, mFile.Data () + offset, sizeof (value));
+  return mSwapped ? Swap32 (value) : value;
+}
+
+/* Give up on the rest of the file. */
+bool CaptureFile::Stop ()
+{
+  mUnreadableBytes += mFile.Size () - mOffset;
+  mOffset = mFile.Size ();
+  return false;
+}
+
+bool CaptureFile::Next (CapturedPacket &packet)
+{
+  return mPcapNg ? NextPcapNg (packet) : NextPcap (packet);
+}
+
+bool CaptureFile::NextPcap (CapturedPacket &packet)
+{
+  if (mOffset + PCAP_RECORD_HEADER_LENGTH > mFile.Size ())
+    {
+      return Stop ();
+    }
+  uint32_t capturedLength = Read32 (mOffset + 8);
+  if (capturedLength > mFile.Size () - mOffset - PCAP_RECORD_HEADER_LENGTH)
+    {
+      return Stop ();
+    }
+  packet.mLinkType = mLinkType;
+  packet.mData = mFile.Data () + mOffset + PCAP_RECORD_HEADER_LENGTH;
+  packet.mLength = capturedLength;
+  mOffset += PCAP_RECORD_HEADER_LENGTH + capturedLength;
+  return true;
+}
+
+/* Read the section header block at offset, which sets the byte order and
+   starts a new list of interfaces. */
+bool CaptureFile::StartSection (uint64_t offset)
+{
+  if (offset + 28 > mFile.Size ())
+    {
+      return false;
+    }
+  uint32_t byteOrder;
+  memcpy (&byteOrder, mFile.Data () + offset + 8, sizeof (byteOrder));
+  if ((byteOrder != PCAPNG_BYTE_ORDER_MAGIC) && (Swap32 (byteOrder) != PCAPNG_BYTE_ORDER_MAGIC))
+    {
+      return false;
+    }
+  mSwapped = (byteOrder != PCAPNG_BYTE_ORDER_MAGIC);
+  uint32_t blockLength = Read32 (offset + 4);
+  if ((blockLength < 28) || (blockLength % 4) || (blockLength > mFile.Size () - offset))
+    {
+      return false;
+    }
+  mInterfaces.clear ();
+  mOffset = offset + blockLength;
+  return true;
+}
+
+bool CaptureFile::NextPcapNg (CapturedPacket &packet)
+{
+  while (mOffset + 12 <= mFile.Size ())
+    {
+      uint32_t blockType = Read32 (mOffset);
+      if (blockType == PCAPNG_SECTION_HEADER)
+	{
+	  if (!StartSection (mOffset))
+	    {
+	      return Stop ();
+	    }
+	  continue;
+	}
+      uint32_t blockLength = Read32 (mOffset + 4);
+      if ((blockLength < 12) || (blockLength % 4) || (blockLength > mFile.Size () - mOffset))
+	{
+	  return Stop ();
+	}
+      uint64_t block = mOffset;
+      mOffset += blockLength;
+
+      uint32_t interface = 0;
+      uint32_t capturedLength = 0;
+      uint32_t dataOffset = 0;
+      switch (blockType)
+	{
+	case PCAPNG_INTERFACE:
+	  if (blockLength >= 20)
+	    {
+	      mInterfaces.push_back (Read16 (block + 8));
+	    }
+	  continue;
+	case PCAPNG_ENHANCED_PACKET:
+	case PCAPNG_OBSOLETE_PACKET:
+	  if (blockLength < 32)
+	    {
+	      continue;
+	    }
+	  interface = (blockType == PCAPNG_ENHANCED_PACKET) ? Read32 (block + 8) : Read16 (block + 8);
+	  capturedLength = Read32 (block + 20);
+	  dataOffset = 28;
+	  break;
+	case PCAPNG_SIMPLE_PACKET:
+	  if (blockLength < 16)
+	    {
+	      continue;
+	    }
+	  /* The captured length is the original length, cut to fit the block. */
+	  capturedLength = Read32 (block + 8);
+	  if (capturedLength > blockLength - 16)
+	    {
+	      capturedLength = blockLength - 16;
+	    }
+	  dataOffset = 12;
+	  break;
+	default:
+	  /* Statistics, name resolution, comments and so on */
+	  continue;
+	}
+      if ((interface >= mInterfaces.size ()) || (capturedLength > blockLength - dataOffset - 4))
+	{
+	  continue;
+	}
+      packet.mLinkType = mInterfaces[interface];
+      packet.mData = mFile.Data () + block + dataOffset;
+      packet.mLength = capturedLength;
+      return true;
+    }
+  return Stop ();
+}
+
+
+/* \brief Decode an IPv4 or IPv6 packet and the UDP or TCP header in it. */
+static DecodeResult DecodeIp (const uint8_t *data, uint32_t length, TransportSegment &segment)
+{
+  if (length < 1)
+    {
+      return DecodeResult::Truncated;
+    }
+  FlowKey &flow = segment.mFlow;
+  uint8_t protocol;
+  uint32_t headerLength;
+  uint32_t payloadLength;
+  uint8_t version = data[0] >> 4;
+  if (version == 4)
+    {
+      if (length < 20)
+	{
+	  return DecodeResult::Truncated;
+	}
+      headerLength = (data[0] & 0x0F) * 4;
+      uint32_t totalLength = Big16 (data + 2);
+      if ((headerLength < 20) || (totalLength < headerLength))
+	{
+	  return DecodeResult::NotIp;
+	}
+      /* More fragments, or a fragment offset */
+      if (Big16 (data + 6) & 0x3FFF)
+	{
+	  return DecodeResult::Fragment;
+	}
+      protocol = data[9];
+      memset (flow.mSource, 0, 10);
+      memset (flow.mSource + 10, 0xFF, 2);
+      memcpy (flow.mSource + 12, data + 12, 4);
+      memset (flow.mDestination, 0, 10);
+      memset (flow.mDestination + 10, 0xFF, 2);
+      memcpy (flow.mDestination + 12, data + 16, 4);
+      payloadLength = totalLength - headerLength;
+    }
+  else if (version == 6)
+    {
+      if (length < 40)
+	{
+	  return DecodeResult::Truncated;
+	}
+      protocol = data[6];
+      memcpy (flow.mSource, data + 8, 16);
+      memcpy (flow.mDestination, data + 24, 16);
+      headerLength = 40;
+      payloadLength = Big16 (data + 4);
+      /* Hop-by-hop, routing and destination options headers */
+      while ((protocol == 0) || (protocol == 43) || (protocol == 60))
+	{
+	  if (length < headerLength + 8)
+	    {
+	      return DecodeResult::Truncated;
+	    }
+	  uint32_t extensionLength = (data[headerLength + 1] + 1) * 8;
+	  if (payloadLength < extensionLength)
+	    {
+	      return DecodeResult::NotIp;
+	    }
+	  protocol = data[headerLength];
+	  headerLength += extensionLength;
+	  payloadLength -= extensionLength;
+	}
+      if (protocol == 44)
+	{
+	  return DecodeResult::Fragment;
+	}
+    }
+  else
+    {
+      return DecodeResult::NotIp;
+    }
+
+  if (length < headerLength)
+    {
+      return DecodeResult::Truncated;
+    }
+  const uint8_t *transport = data + headerLength;
+  /* Ethernet pads short frames, so the IP length, not the captured
+     length, says where the packet ends. */
+  uint32_t available = length - headerLength;
+  if (protocol == CAPTURE_PROTOCOL_UDP)
+    {
+      if ((available < 8) || (payloadLength < 8))
+	{
+	  return DecodeResult::Truncated;
+	}
+      uint32_t udpLength = Big16 (transport + 4);
+      if ((udpLength < 8) || (udpLength > payloadLength))
+	{
+	  udpLength = payloadLength;
+	}
+      if (udpLength > available)
+	{
+	  return DecodeResult::Truncated;
+	}
+      segment.mProtocol = CAPTURE_PROTOCOL_UDP;
+      flow.mSourcePort = Big16 (transport);
+      flow.mDestinationPort = Big16 (transport + 2);
+      segment.mSequence = 0;
+      segment.mTcpFlags = 0;
+      segment.mPayload = transport + 8;
+      segment.mLength = udpLength - 8;
+      return DecodeResult::Decoded;
+    }
+  if (protocol == CAPTURE_PROTOCOL_TCP)
+    {
+      if ((available < 20) || (payloadLength < 20))
+	{
+	  return DecodeResult::Truncated;
+	}
+      uint32_t tcpHeaderLength = (transport[12] >> 4) * 4;
+      if ((tcpHeaderLength < 20) || (tcpHeaderLength > payloadLength))
+	{
+	  return DecodeResult::NotUdpOrTcp;
+	}
+      if (payloadLength > available)
+	{
+	  return DecodeResult::Truncated;
+	}
+      segment.mProtocol = CAPTURE_PROTOCOL_TCP;
+      flow.mSourcePort = Big16 (transport);
+      flow.mDestinationPort = Big16 (transport + 2);
+      segment.mSequence = Big32 (transport + 4);
+      segment.mTcpFlags = transport[13];
+      segment.mPayload = transport + tcpHeaderLength;
+      segment.mLength = payloadLength - tcpHeaderLength;
+      return DecodeResult::Decoded;
+    }
+  return DecodeResult::NotUdpOrTcp;
+}
+
+DecodeResult DecodeTransport (const CapturedPacket &packet, TransportSegment &segment)
+{
+  const uint8_t *data = packet.mData;
+  uint32_t length = packet.mLength;
+  uint32_t etherType = 0;
+  uint32_t linkLength = 0;
+  switch (packet.mLinkType)
+    {
+    case LINKTYPE_ETHERNET:
+      if (length < 14)
+	{
+	  return DecodeResult::Truncated;
+	}
+      linkLength = 14;
+      etherType = Big16 (data + 12);
+      while ((etherType == ETHERTYPE_VLAN) || (etherType == ETHERTYPE_QINQ))
+	{
+	  if (length < linkLength + 4)
+	    {
+	      return DecodeResult::Truncated;
+	    }
+	  etherType = Big16 (data + linkLength + 2);
+	  linkLength += 4;
+	}
+      break;
+    case LINKTYPE_LINUX_SLL:
+      if (length < 16)
+	{
+	  return DecodeResult::Truncated;
+	}
+      linkLength = 16;
+      etherType = Big16 (data + 14);
+      break;
+    case LINKTYPE_LINUX_SLL2:
+      if (length < 20)
+	{
+	  return DecodeResult::Truncated;
+	}
+      linkLength = 20;
+      etherType = Big16 (data);
+      break;
+    case LINKTYPE_NULL:
+    case LINKTYPE_LOOP:
+      {
+	if (length < 4)
+	  {
+	    return DecodeResult::Truncated;
+	  }
+	/* The address family, in either byte order: AF_INET is 2 everywhere,
+	   AF_INET6 is 10, 24, 28 or 30 depending on the system. */
+	uint32_t family;
+	memcpy (&family, data, sizeof (family));
+	if (family > 0xFFFF)
+	  {
+	    family = Swap32 (family);
+	  }
+	linkLength = 4;
+	etherType = (family == 2) ? ETHERTYPE_IPV4 : ETHERTYPE_IPV6;
+	break;
+      }
+    case LINKTYPE_RAW:
+    case LINKTYPE_RAW_OLD:
+    case LINKTYPE_RAW_OPENBSD:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+      /* The IP version is in the packet itself. */
+      etherType = ETHERTYPE_IPV4;
+      break;
+    default:
+      return DecodeResult::UnknownLinkType;
+    }
+  if ((etherType != ETHERTYPE_IPV4) && (etherType != ETHERTYPE_IPV6))
+    {
+      return DecodeResult::NotIp;
+    }
+  return DecodeIp (data + linkLength, length - linkLength, segment);
+}
+
+
+void TcpReassembler::Add (const TransportSegment &segment, const StreamOutput &output)
+{
+  mSegments++;
+  auto found = mStreams.find (segment.mFlow);
+  if (found == mStreams.end ())
+    {
+      found = mStreams.emplace (segment.mFlow, Stream ()).first;
+      found->second.mIndex = (uint32_t)(mStreams.size () - 1);
+    }
+  Stream &stream = found->second;
+
+  uint32_t sequence = segment.mSequence;
+  if (segment.mTcpFlags & CAPTURE_TCP_SYN)
+    {
+      /* A new connection between the same ports: finish the old one.  The
+	 SYN itself takes up one sequence number. */
+      while (!stream.mHeld.empty ())
+	{
+	  SkipHole (stream, output);
+	}
+      stream.mStarted = true;
+      stream.mNextSequence = sequence + 1;
+      sequence++;
+    }
+  if (segment.mLength == 0)
+    {
+      return;
+    }
+  if (!stream.mStarted)
+    {
+      /* The capture began after the connection was made. */
+      stream.mStarted = true;
+      stream.mNextSequence = sequence;
+    }
+
+  /* Position in the stream; sequence numbers wrap at 2^32. */
+  int64_t start = (int64_t)stream.mNextOffset + (int32_t)(sequence - stream.mNextSequence);
+  int64_t end = start + segment.mLength;
+  const uint8_t *data = segment.mPayload;
+  if (end <= (int64_t)stream.mNextOffset)
+    {
+      mRetransmittedBytes += segment.mLength;
+      return;
+    }
+  if (start < (int64_t)stream.mNextOffset)
+    {
+      uint64_t overlap = stream.mNextOffset - start;
+      mRetransmittedBytes += overlap;
+      data += overlap;
+      start = stream.mNextOffset;
+    }
+
+  if (start == (int64_t)stream.mNextOffset)
+    {
+      Deliver (stream, data, end - start, output);
+      DeliverHeld (stream, output);
+      return;
+    }
+
+  /* Ahead of a missing segment: hold it, keeping the longer of two that
+     start at the same place. */
+  mOutOfOrderSegments++;
+  std::vector<uint8_t> &held = stream.mHeld[start];
+  if (held.size () < (size_t)(end - start))
+    {
+      stream.mHeldBytes += (end - start) - held.size ();
+      held.assign (data, data + (end - start));
+    }
+  while (stream.mHeldBytes > TCP_HOLD_LIMIT)
+    {
+      SkipHole (stream, output);
+    }
+}
+
+void TcpReassembler::Flush (const StreamOutput &output)
+{
+  for (auto &entry : mStreams)
+    {
+      while (!entry.second.mHeld.empty ())
+	{
+	  SkipHole (entry.second, output);
+	}
+    }
+}
+
+void TcpReassembler::Deliver (Stream &stream, const uint8_t *data, size_t length,
+			      const StreamOutput &output)
+{
+  output (stream.mIndex, data, length, stream.mAfterGap);
+  stream.mAfterGap = false;
+  stream.mNextOffset += length;
+  stream.mNextSequence += (uint32_t)length;
+}
+
+/* Pass on the held segments that now follow on from the stream. */
+void TcpReassembler::DeliverHeld (Stream &stream, const StreamOutput &output)
+{
+  while (!stream.mHeld.empty ())
+    {
+      auto first = stream.mHeld.begin ();
+      if (first->first > stream.mNextOffset)
+	{
+	  break;
+	}
+      const std::vector<uint8_t> &held = first->second;
+      uint64_t heldEnd = first->first + held.size ();
+      if (heldEnd > stream.mNextOffset)
+	{
+	  uint64_t skip = stream.mNextOffset - first->first;
+	  mRetransmittedBytes += skip;
+	  Deliver (stream, held.data () + skip, held.size () - skip, output);
+	}
+      else
+	{
+	  mRetransmittedBytes += held.size ();
+	}
+      stream.mHeldBytes -= held.size ();
+      stream.mHeld.erase (first);
+    }
+}
+
+/* Give up on the missing data before the first held segment. */
+void TcpReassembler::SkipHole (Stream &stream, const StreamOutput &output)
+{
+  if (stream.mHeld.empty ())
+    {
+      return;
+    }
+  uint64_t hole = stream.mHeld.begin ()->first - stream.mNextOffset;
+  mMissingBytes += hole;
+  stream.mNextOffset += hole;
+  stream.mNextSequence += (uint32_t)hole;
+  stream.mAfterGap = true;
+  DeliverHeld (stream, output);
+}
@@ -0,0 +1,181 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef CAPTURE_FILE_HPP
+#define CAPTURE_FILE_HPP
+
+#include <stdint.h>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+
+/* Reading of network captures made with tcpdump or Wireshark, without
+   libpcap: the packets of a capture file, the UDP datagrams and TCP
+   segments in them, and the byte streams of the TCP connections. */
+
+/* A packet as captured, with the link-layer type of the interface it was
+   captured on (the LINKTYPE_ numbers of the pcap formats). */
+struct CapturedPacket
+{
+  uint32_t       mLinkType = 0;
+  const uint8_t *mData = nullptr;
+  uint32_t       mLength = 0;    /* Bytes captured; may be fewer than were sent */
+};
+
+/* The packets of a classic pcap file (either byte order, microsecond or
+   nanosecond timestamps) or a pcapng file (any number of sections and
+   interfaces), in file order.  The file is mapped and packets are read
+   in place. */
+class CaptureFile
+{
+public:
+  /* Returns false, with a message on cerr, if the file can't be mapped or
+     is in neither format. */
+  bool Open (const std::string &fileName);
+  void Close ();
+
+  /* \brief The next packet.
+     \return false at the end of the file, or at a block that runs past it
+     or is malformed; UnreadableBytes() then counts the rest of the file. */
+  bool Next (CapturedPacket &packet);
+
+  bool     IsPcapNg () const { return mPcapNg; }
+  uint64_t UnreadableBytes () const { return mUnreadableBytes; }
+
+private:
+  bool     NextPcap (CapturedPacket &packet);
+  bool     NextPcapNg (CapturedPacket &packet);
+  bool     StartSection (uint64_t offset);
+  bool     Stop ();
+  uint16_t Read16 (uint64_t offset) const;
+  uint32_t Read32 (uint64_t offset) const;
+
+  MappedFile            mFile;
+  uint64_t              mOffset = 0;
+  bool                  mPcapNg = false;
+  bool                  mSwapped = false;    /* File byte order is not this machine's */
+  uint32_t              mLinkType = 0;       /* pcap: the one interface */
+  std::vector<uint32_t> mInterfaces;         /* pcapng: link type of each interface in the section */
+  uint64_t              mUnreadableBytes = 0;
+};
+
+/* Both ends of a UDP or TCP flow, in the direction the packet travelled.
+   IPv4 addresses are held as IPv4-mapped IPv6 addresses. */
+struct FlowKey
+{
+  uint8_t  mSource[16];
+  uint8_t  mDestination[16];
+  uint16_t mSourcePort;
+  uint16_t mDestinationPort;
+
+  bool operator< (const FlowKey &other) const { return memcmp (this, &other, sizeof (*this)) < 0; }
+};
+
+#define CAPTURE_PROTOCOL_TCP 6
+#define CAPTURE_PROTOCOL_UDP 17
+
+#define CAPTURE_TCP_FIN 0x01
+#define CAPTURE_TCP_SYN 0x02
+#define CAPTURE_TCP_RST 0x04
+
+/* The transport layer of a captured packet.  The payload points into the
+   packet. */
+struct TransportSegment
+{
+  uint8_t        mProtocol = 0;  /* CAPTURE_PROTOCOL_TCP or _UDP */
+  FlowKey        mFlow = {};
+  uint32_t       mSequence = 0;  /* TCP only */
+  uint8_t        mTcpFlags = 0;  /* TCP only */
+  const uint8_t *mPayload = nullptr;
+  uint32_t       mLength = 0;
+};
+
+enum class DecodeResult
+{
+  Decoded,
+  UnknownLinkType,     /* Not a link layer this decoder knows */
+  NotIp,               /* ARP, LLDP and so on */
+  NotUdpOrTcp,
+  Fragment,            /* Part of a fragmented IP datagram */
+  Truncated            /* Captured with too small a snap length */
+};
+
+/* \brief Find the UDP or TCP payload in a packet captured on Ethernet
+   (with or without VLAN tags), Linux "cooked" (SLL and SLL2), BSD
+   loopback or raw IP interfaces, over IPv4 or IPv6. */
+DecodeResult DecodeTransport (const CapturedPacket &packet, TransportSegment &segment);
+
+/* Bytes of early segments a TCP stream may hold while waiting for a
+   missing one. */
+#define TCP_HOLD_LIMIT (16 << 20)
+
+/* Rebuilds the byte stream sent in each direction of each TCP connection
+   from its segments: retransmitted data is dropped, and segments that
+   arrive ahead of a missing one are held until it comes.  If it never
+   does (it was not captured), the stream skips over the hole once
+   TCP_HOLD_LIMIT bytes are waiting, or at Flush(). */
+class TcpReassembler
+{
+public:
+  /* Data of the stream with the given number (one per direction of a
+     connection, numbered from 0 in the order they are first seen), in
+     order.  afterGap is true for the first data after a hole. */
+  typedef std::function<void (uint32_t stream, const uint8_t *data, size_t length, bool afterGap)> StreamOutput;
+
+  void Add (const TransportSegment &segment, const StreamOutput &output);
+
+  /* \brief Pass on everything still held, skipping the holes; at the end
+     of a capture. */
+  void Flush (const StreamOutput &output);
+
+  uint32_t StreamCount () const { return (uint32_t)mStreams.size (); }
+  uint64_t Segments () const { return mSegments; }
+  uint64_t RetransmittedBytes () const { return mRetransmittedBytes; }
+  uint64_t OutOfOrderSegments () const { return mOutOfOrderSegments; }
+  uint64_t MissingBytes () const { return mMissingBytes; }
+
+private:
+  struct Stream
+  {
+    uint32_t mIndex;
+    bool     mStarted = false;
+    bool     mAfterGap = false;
+    uint32_t mNextSequence = 0;        /* Sequence number of ... */
+    uint64_t mNextOffset = 0;          /* ... this byte of the stream */
+    uint64_t mHeldBytes = 0;
+    std::map<uint64_t, std::vector<uint8_t>> mHeld;  /* Early segments, by stream offset */
+  };
+
+  void Deliver (Stream &stream, const uint8_t *data, size_t length, const StreamOutput &output);
+  void DeliverHeld (Stream &stream, const StreamOutput &output);
+  void SkipHole (Stream &stream, const StreamOutput &output);
+
+  std::map<FlowKey, Stream> mStreams;
+  uint64_t mSegments = 0;
+  uint64_t mRetransmittedBytes = 0;
+  uint64_t mOutOfOrderSegments = 0;
+  uint64_t mMissingBytes = 0;
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstring>
+#include "RecordUtilities.hpp"
+#include "Checksum.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define GM_CRC_SSE42
+#elif defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64)
+#include <arm_acle.h>
+#define GM_CRC_ARMV8
+#endif
+
+/* Castagnoli polynomial, bit-reversed */
+#define CRC32C_POLYNOMIAL 0x82F63B78u
+
+typedef uint32_t (*Crc32cFunction) (uint32_t crc, const uint8_t *data, size_t length);
+
+/* Tables for slicing-by-8: entry [k][b] is the CRC of byte b followed by
+   k zero bytes. */
+struct Crc32cTables
+{
+  Crc32cTables ()
+  {
+    for (uint32_t byte = 0; byte < 256; byte++)
+      {
+	uint32_t crc = byte;
+	for (int bit = 0; bit < 8; bit++)
+	  {
+	    crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : (crc >> 1);
+	  }
+	mTable[0][byte] = crc;
+      }
+    for (int slice = 1; slice < 8; slice++)
+      {
+	for (uint32_t byte = 0; byte < 256; byte++)
+	  {
+	    uint32_t previous = mTable[slice - 1][byte];
+	    mTable[slice][byte] = (previous >> 8) ^ mTable[0][previous & 0xFF];
+	  }
+      }
+  }
+
+  uint32_t mTable[8][256];
+};
+
+static uint32_t SoftwareCrc32c (uint32_t crc, const uint8_t *data, size_t length)
+{
+  static const Crc32cTables tables;
+  const uint32_t (*table)[256] = tables.mTable;
+  while (length >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, data, sizeof (word));
+      word ^= crc;
+      crc = table[7][word & 0xFF] ^ table[6][(word >> 8) & 0xFF] ^
+	table[5][(word >> 16) & 0xFF] ^ table[4][(word >> 24) & 0xFF] ^
+	table[3][(word >> 32) & 0xFF] ^ table[2][(word >> 40) & 0xFF] ^
+	table[1][(word >> 48) & 0xFF] ^ table[0][word >> 56];
+      data += 8;
+      length -= 8;
+    }
+  for (; length > 0; length--)
+    {
+      crc = table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+  return crc;
+}
+
+#if defined(GM_CRC_SSE42)
+/* Built for SSE4.2 whatever the compiler's target, and called only after
+   the processor has been found to support it. */
+#if defined(__GNUC__)
+__attribute__ ((target ("sse4.2")))
+#endif
+static uint32_t HardwareCrc32c (uint32_t crc, const uint8_t *data, size_t length)
+{
+  uint64_t crc64 = crc;
+  while (length >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, data, sizeof (word));
+      crc64 = _mm_crc32_u64 (crc64, word);
+      data += 8;
+      length -= 8;
+    }
+  crc = (uint32_t)crc64;
+  for (; length > 0; length--)
+    {
+      crc = _mm_crc32_u8 (crc, *data++);
+    }
+  return crc;
+}
+
+static bool HaveHardwareCrc32c ()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid (info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#else
+  return __builtin_cpu_supports ("sse4.2");
+#endif
+}
+#define CRC32C_HARDWARE_NAME "sse4.2"
+
+#elif defined(GM_CRC_ARMV8)
+static uint32_t HardwareCrc32c (uint32_t crc, const uint8_t *data, size_t length)
+{
+  while (length >= 8)
+    {
+      uint64_t word;
+      memcpy (&word, data, sizeof (word));
+      crc = __crc32cd (crc, word);
+      data += 8;
+      length -= 8;
+    }
+  for (; length > 0; length--)
+    {
+      crc = __crc32cb (crc, *data++);
+    }
+  return crc;
+}
+
+/* The compiler was told that the processor has the CRC32 instructions. */
+static bool HaveHardwareCrc32c ()
+{
+  return true;
+}
+#define CRC32C_HARDWARE_NAME "armv8"
+#endif
+
+struct Crc32cSelection
+{
+  Crc32cSelection ()
+  {
+#if defined(GM_CRC_SSE42) || defined(GM_CRC_ARMV8)
+    if (HaveHardwareCrc32c ())
+      {
+	mFunction = HardwareCrc32c;
+	mName = CRC32C_HARDWARE_NAME;
+      }
+#endif
+  }
+
+  Crc32cFunction mFunction = SoftwareCrc32c;
+  const char    *mName = "software";
+};
+
+static const Crc32cSelection &Selection ()
+{
+  static const Crc32cSelection selection;
+  return selection;
+}
+
+uint32_t Crc32c (uint32_t crc, const void *data, size_t length)
+{
+  return ~Selection ().mFunction (~crc, (const uint8_t *)data, length);
+}
+
+const char *Crc32cImplementation ()
+{
+  return Selection ().mName;
+}
+
+
+void RecordChecksum::Add (const uint8_t *record, uint32_t length)
+{
+  if (mRecords == 0)
+    {
+      mFirstIndex = GetRecordIndex (record);
+    }
+  mCrc = Crc32c (mCrc, record, length);
+  mBytes += length;
+  mRecords++;
+}
+
+void RecordChecksum::MakePacket (ChecksumPacket &packet)
+{
+  memset (&packet, 0, sizeof (packet));
+  packet.mRecordType = GM_MAG_ELEMENT_CHECKSUM_FORMAT;
+  packet.mRecordSize = sizeof (ChecksumPacket);
+  packet.mFirstPacketIndex = mFirstIndex;
+  packet.mRecordCount = mRecords;
+  packet.mByteCount = mBytes;
+  packet.mCrc32c = mCrc;
+  Restart ();
+}
+
+bool RecordChecksum::Check (const ChecksumPacket &packet)
+{
+  bool match = (packet.mRecordCount == mRecords) && (packet.mByteCount == mBytes) &&
+    (packet.mCrc32c == mCrc);
+  Restart ();
+  return match;
+}
+
+void RecordChecksum::Restart ()
+{
+  mCrc = 0;
+  mBytes = 0;
+  mRecords = 0;
+  mFirstIndex = 0;
+}
@@ -0,0 +1,66 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DerivedRecords.hpp"
+
+/* \brief CRC32C (Castagnoli) of length bytes, continuing from the CRC of
+   the bytes before them; start with crc = 0.  Uses the SSE4.2 crc32
+   instruction on x86-64 processors that have it, the ARMv8 CRC32
+   instructions when the compiler targets them, and slicing-by-8 tables
+   elsewhere. */
+uint32_t Crc32c (uint32_t crc, const void *data, size_t length);
+
+/* \brief "sse4.2", "armv8" or "software": the implementation Crc32c uses. */
+const char *Crc32cImplementation ();
+
+/* Running checksum of the records since the last checksum record, kept
+   by the program that writes a recording and by the one that checks it. */
+class RecordChecksum
+{
+public:
+  void Add (const uint8_t *record, uint32_t length);
+
+  uint32_t Records () const { return mRecords; }
+  uint32_t Bytes () const { return mBytes; }
+
+  /* \brief Fill in a checksum record for the records added since the
+     last one, and start the next group. */
+  void MakePacket (ChecksumPacket &packet);
+
+  /* \brief True if packet matches the records added since the last one.
+     Either way, the next group starts after packet. */
+  bool Check (const ChecksumPacket &packet);
+
+private:
+  void Restart ();
+
+  uint32_t mCrc = 0;
+  uint32_t mBytes = 0;
+  uint32_t mRecords = 0;
+  uint64_t mFirstIndex = 0;
+};
+
+#endif
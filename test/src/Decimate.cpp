@@ -0,0 +1,240 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include "DerivedRecords.hpp"
+#include "RecordingReader.hpp"
+#include "SimdKernels.hpp"
+#include "WorkStealingPool.hpp"
+#include "Decimate.hpp"
+
+static const double sPi = 3.14159265358979323846;
+
+/* Raw samples in each chunk: 400 s, a whole number of records at every
+   rate that divides 1000Hz. */
+#define DECIMATE_RAW_RATE      1000
+#define DECIMATE_CHUNK_SAMPLES 400000
+#define DECIMATE_CUTOFF        0.8
+
+static_assert (DECIMATE_CHUNK_SAMPLES % (MFAM_STREAMER_CACHE_SIZE * DECIMATE_RAW_RATE) == 0,
+	       "Chunks must hold whole records at every rate");
+
+FirDecimationFilter::FirDecimationFilter (uint32_t decimation)
+  : mDecimation (decimation > 0 ? decimation : 1)
+{
+  mHalfWidth = DECIMATE_HALF_WIDTH * mDecimation;
+  uint32_t taps = Taps ();
+  double cutoff = DECIMATE_CUTOFF * 0.5 / mDecimation;   /* Cycles per raw sample */
+  mWeights.resize (taps);
+  double total = 0.0;
+  for (uint32_t tap = 0; tap < taps; tap++)
+    {
+      double offset = (double)tap - mHalfWidth;
+      double sinc = (tap == mHalfWidth) ? 2.0 * cutoff : std::sin (2.0 * sPi * cutoff * offset) / (sPi * offset);
+      double phase = 2.0 * sPi * tap / (taps - 1);
+      double window = 0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase);
+      mWeights[tap] = sinc * window;
+      total += mWeights[tap];
+    }
+  for (double &weight : mWeights)
+    {
+      weight /= total;
+    }
+}
+
+/* Filter the raw samples first ... end - 1 at every rate, appending the
+   records to records.  A record is kept if any of its outputs is valid. */
+static void DecimateChunk (const RecordingReader &reader, const std::vector<FirDecimationFilter> &filters,
+			   uint64_t first, uint64_t end, std::vector<uint8_t> &records)
+{
+  uint32_t margin = 0;
+  for (const FirDecimationFilter &filter : filters)
+    {
+      margin = std::max (margin, filter.HalfWidth ());
+    }
+  uint64_t readFirst = (first > margin) ? first - margin : 0;
+  uint64_t count = end + margin - readFirst;
+  std::vector<uint32_t> mag[2] = { std::vector<uint32_t> (count), std::vector<uint32_t> (count) };
+  std::vector<uint8_t>  valid (count);
+  if (reader.ReadMag (readFirst, count, mag[0].data (), mag[1].data (), valid.data ()) == 0)
+    {
+      return;
+    }
+
+  /* Samples in LSBs, and running counts of invalid ones, so that a
+     window's validity is one subtraction. */
+  std::vector<double>   values[2];
+  std::vector<uint32_t> invalid[2];
+  for (int channel = 0; channel < 2; channel++)
+    {
+      values[channel].resize (count);
+      invalid[channel].resize (count + 1);
+      invalid[channel][0] = 0;
+      uint8_t flag = (uint8_t)(1 << channel);
+      for (uint64_t index = 0; index < count; index++)
+	{
+	  values[channel][index] = (double)mag[channel][index];
+	  invalid[channel][index + 1] = invalid[channel][index] + (((valid[index] & flag) != 0) ? 0 : 1);
+	}
+    }
+
+  FirDecimatedPacket packet;
+  for (const FirDecimationFilter &filter : filters)
+    {
+      uint32_t decimation = filter.Decimation ();
+      uint32_t taps = filter.Taps ();
+      uint64_t step = (uint64_t)MFAM_STREAMER_CACHE_SIZE * decimation;
+      for (uint64_t start = first; start < end; start += step)
+	{
+	  memset (&packet, 0, sizeof (packet));
+	  packet.mRecordType = GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT;
+	  packet.mRecordSize = sizeof (FirDecimatedPacket);
+	  packet.mFirstPacketIndex = start;
+	  packet.mDecimation = decimation;
+	  packet.mTaps = taps;
+	  /* Filled here and copied in, since members of the packed record
+	     may not be aligned. */
+	  double    outputs[2][MFAM_STREAMER_CACHE_SIZE] = {};
+	  uint64_t  masks[2] = { 0, 0 };
+	  for (uint32_t slot = 0; slot < MFAM_STREAMER_CACHE_SIZE; slot++)
+	    {
+	      uint64_t centre = start + (uint64_t)slot * decimation;
+	      if (centre < readFirst + filter.HalfWidth ())
+		{
+		  continue;
+		}
+	      uint64_t low = centre - filter.HalfWidth () - readFirst;
+	      for (int channel = 0; channel < 2; channel++)
+		{
+		  if (invalid[channel][low + taps] == invalid[channel][low])
+		    {
+		      outputs[channel][slot] = MAG_DATA_AS_FLOAT (DotProduct (&values[channel][low],
+									      filter.Weights (), taps));
+		      masks[channel] |= (uint64_t)1 << slot;
+		    }
+		}
+	    }
+	  if ((masks[0] | masks[1]) != 0)
+	    {
+	      memcpy (packet.mMag1, outputs[0], sizeof (outputs[0]));
+	      memcpy (packet.mMag2, outputs[1], sizeof (outputs[1]));
+	      packet.mMag1ValidMask = masks[0];
+	      packet.mMag2ValidMask = masks[1];
+	      const uint8_t *bytes = (const uint8_t *)&packet;
+	      records.insert (records.end (), bytes, bytes + sizeof (packet));
+	    }
+	}
+    }
+}
+
+int RunDecimate (MagElementTestOptions &options)
+{
+  auto startTime = std::chrono::steady_clock::now ();
+  RecordingReader reader;
+  if (!reader.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+  if (reader.BlockCount () == 0)
+    {
+      std::cerr << "\n\nError: " << options.mFileNameToSave << " has no 1000Hz blocks\n\n";
+      return 1;
+    }
+  std::vector<FirDecimationFilter> filters;
+  for (uint32_t rate : options.mDecimateRates)
+    {
+      filters.emplace_back (DECIMATE_RAW_RATE / rate);
+    }
+
+  FILE *output = fopen (options.mOutputFileName.c_str (), "wb");
+  if (output == nullptr)
+    {
+      std::cerr << "\n\nError: Output file " << options.mOutputFileName << " can't be opened\n\n";
+      return 1;
+    }
+
+  uint64_t firstChunk = reader.FirstIndex () / DECIMATE_CHUNK_SAMPLES;
+  uint64_t endChunk = (reader.EndIndex () + DECIMATE_CHUNK_SAMPLES - 1) / DECIMATE_CHUNK_SAMPLES;
+  size_t   chunkCount = (size_t)(endChunk - firstChunk);
+  std::vector<std::vector<uint8_t>> results (chunkCount);
+  std::vector<bool>                 done (chunkCount, false);
+  std::mutex                        doneMutex;
+  std::condition_variable           doneChanged;
+
+  uint64_t written = 0;
+  bool writeFailed = false;
+  WorkStealingPool pool (options.mWorkerCount);
+  for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+      pool.Submit ([&, chunk]
+		   {
+		     uint64_t first = (firstChunk + chunk) * DECIMATE_CHUNK_SAMPLES;
+		     DecimateChunk (reader, filters, first, first + DECIMATE_CHUNK_SAMPLES, results[chunk]);
+		     std::lock_guard<std::mutex> lock (doneMutex);
+		     done[chunk] = true;
+		     doneChanged.notify_one ();
+		   });
+    }
+
+  /* Write the chunks in order as they finish, and free each once written. */
+  for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+      std::vector<uint8_t> records;
+      {
+	std::unique_lock<std::mutex> lock (doneMutex);
+	doneChanged.wait (lock, [&] { return done[chunk]; });
+	records.swap (results[chunk]);
+      }
+      if (!writeFailed && !records.empty ())
+	{
+	  writeFailed = (fwrite (records.data (), 1, records.size (), output) != records.size ());
+	  written += records.size ();
+	}
+    }
+  pool.Wait ();
+  if (fclose (output) != 0)
+    {
+      writeFailed = true;
+    }
+  if (writeFailed)
+    {
+      std::cerr << "\n\nError: Output file " << options.mOutputFileName << " not written\n\n";
+      return 1;
+    }
+
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+  std::cout << options.mFileNameToSave << ": indices " << reader.FirstIndex () << " to "
+	    << reader.EndIndex () << " (exclusive), decimated to";
+  for (const FirDecimationFilter &filter : filters)
+    {
+      std::cout << " " << DECIMATE_RAW_RATE / filter.Decimation () << "Hz (" << filter.Taps () << " taps)";
+    }
+  std::cout << "\n" << options.mOutputFileName << ": " << written / sizeof (FirDecimatedPacket)
+	    << " records, " << chunkCount << " chunks in " << seconds << " s on "
+	    << pool.WorkerCount () << " workers\n";
+  return 0;
+}
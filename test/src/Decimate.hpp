@@ -0,0 +1,66 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DECIMATE_HPP
+#define DECIMATE_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "TestOptions.hpp"
+
+/* Low-pass FIR for decimation by a factor of the 1000Hz rate: a
+   Blackman-windowed sinc with its cutoff at 0.8 of the output Nyquist
+   frequency and DECIMATE_HALF_WIDTH output samples of taps each side,
+   scaled to a DC gain of exactly 1 in double precision. */
+#define DECIMATE_HALF_WIDTH 16
+
+class FirDecimationFilter
+{
+public:
+  explicit FirDecimationFilter (uint32_t decimation);
+
+  uint32_t      Decimation () const { return mDecimation; }
+  uint32_t      HalfWidth () const { return mHalfWidth; }     /* Raw samples */
+  uint32_t      Taps () const { return 2 * mHalfWidth + 1; }
+  const double *Weights () const { return mWeights.data (); }
+
+private:
+  uint32_t            mDecimation;
+  uint32_t            mHalfWidth;
+  std::vector<double> mWeights;
+};
+
+/* \brief -proto decimate: low-pass filter and decimate mag1 and mag2 of
+   the recording named by -file to each of the -rates, writing
+   FirDecimatedPacket records to the new file named by -out.
+
+   The recording is cut into chunks of DECIMATE_CHUNK_SAMPLES raw
+   samples, which are filtered in parallel on -workers threads; each
+   chunk reads the filter's half width of samples beyond either end, so
+   that no output near a boundary is cut short.  Every output is the
+   same function of the samples under its taps, whichever chunk computes
+   it, and chunk boundaries fall on whole records at every rate, so the
+   file is byte for byte the same as a run on one worker.  Chunks are
+   written in order, each as soon as it and those before it are done.
+   \return 0 if the file was written, 1 if not. */
+int RunDecimate (MagElementTestOptions &options);
+
+#endif
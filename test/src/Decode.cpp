@@ -0,0 +1,220 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "RecordSchema.hpp"
+#include "RecordUtilities.hpp"
+#include "Decode.hpp"
+
+/* CSV text is written out in pieces of about this many bytes. */
+#define DECODE_WRITE_BYTES (1 << 20)
+
+int RunDecode (MagElementTestOptions &options)
+{
+  RecordSchema schema;
+  schema.LoadDefault ();
+  if (!options.mSchemaFileName.empty () && !schema.Load (options.mSchemaFileName))
+    {
+      return 1;
+    }
+
+  /* The columns are the fields of every layout with the chosen name, in
+     the order first listed; fieldOfColumn maps them back, per layout, to
+     a field of that layout, or -1. */
+  std::vector<std::string> columns;
+  std::vector<std::vector<int>> fieldOfColumn (schema.LayoutCount ());
+  std::vector<bool> selected (schema.LayoutCount (), false);
+  size_t valueCount = 0;
+  bool repeated = false;
+  for (size_t index = 0; index < schema.LayoutCount (); index++)
+    {
+      const SchemaLayout &layout = schema.Layout (index);
+      if (layout.mName != options.mDecodeLayout)
+	{
+	  continue;
+	}
+      selected[index] = true;
+      repeated = repeated || (layout.mRows > 1);
+      valueCount = std::max (valueCount, layout.mFields.size () * layout.mRows);
+      for (const SchemaField &field : layout.mFields)
+	{
+	  if (std::find (columns.begin (), columns.end (), field.mName) == columns.end ())
+	    {
+	      columns.push_back (field.mName);
+	    }
+	}
+    }
+  if (columns.empty ())
+    {
+      std::cerr << "\n\nError: There is no layout called " << options.mDecodeLayout << "\n\n";
+      return 1;
+    }
+  for (size_t index = 0; index < schema.LayoutCount (); index++)
+    {
+      if (!selected[index])
+	{
+	  continue;
+	}
+      const SchemaLayout &layout = schema.Layout (index);
+      fieldOfColumn[index].assign (columns.size (), -1);
+      for (size_t field = 0; field < layout.mFields.size (); field++)
+	{
+	  size_t column = std::find (columns.begin (), columns.end (), layout.mFields[field].mName) - columns.begin ();
+	  fieldOfColumn[index][column] = (int)field;
+	}
+    }
+
+  MappedFile input;
+  if (!input.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+  input.AdviseSequential ();
+
+  std::ofstream csvFile;
+  if (!options.mExtractFileName.empty ())
+    {
+      csvFile.open (options.mExtractFileName, std::ios::binary);
+      if (!csvFile)
+	{
+	  std::cerr << "\n\nError: CSV file " << options.mExtractFileName << " can't be opened\n\n";
+	  return 1;
+	}
+    }
+  std::ostream &output = csvFile.is_open () ? (std::ostream &)csvFile : std::cout;
+
+  /* Rows of a record with repeated fields are numbered from 0. */
+  std::string text = repeated ? "row," : "";
+  for (size_t column = 0; column < columns.size (); column++)
+    {
+      text += (column > 0) ? "," : "";
+      text += columns[column];
+    }
+  text += "\n";
+
+  std::vector<double> values (valueCount);
+  std::vector<uint64_t> recordCounts (schema.LayoutCount (), 0);
+  uint64_t otherRecords = 0;
+  uint64_t unreadableBytes = 0;
+  uint64_t truncatedBytes = 0;
+  const uint8_t *data = input.Data ();
+  uint64_t size = input.Size ();
+  uint64_t offset = 0;
+  while (offset + sizeof (RecordHeader) <= size)
+    {
+      RecordHeader header;
+      memcpy (&header, data + offset, sizeof (header));
+      const SchemaLayout *layout = schema.Find (header.mRecordType, header.mRecordSize);
+      if ((layout == nullptr) && IsValidRecordHeader (data + offset))
+	{
+	  /* One of this program's derived records. */
+	  if (offset + header.mRecordSize > size)
+	    {
+	      break;
+	    }
+	  otherRecords++;
+	  offset += header.mRecordSize;
+	  continue;
+	}
+      if (layout == nullptr)
+	{
+	  unreadableBytes++;
+	  offset++;
+	  continue;
+	}
+      if (offset + layout->mRecordSize > size)
+	{
+	  break;
+	}
+
+      size_t layoutIndex = schema.LayoutIndex (layout);
+      recordCounts[layoutIndex]++;
+      if (selected[layoutIndex])
+	{
+	  RecordSchema::Decode (*layout, data + offset, values.data ());
+	  const std::vector<int> &fields = fieldOfColumn[layoutIndex];
+	  for (uint32_t row = 0; row < layout->mRows; row++)
+	    {
+	      if (repeated)
+		{
+		  text += std::to_string (row);
+		  text += ',';
+		}
+	      for (size_t column = 0; column < fields.size (); column++)
+		{
+		  if (column > 0)
+		    {
+		      text += ',';
+		    }
+		  if (fields[column] < 0)
+		    {
+		      continue;
+		    }
+		  const SchemaField &field = layout->mFields[fields[column]];
+		  double value = values[fields[column] * layout->mRows + ((field.mCount > 1) ? row : 0)];
+		  char number[40];
+		  int length = snprintf (number, sizeof (number), field.IsInteger () ? "%.0f" : "%.12g", value);
+		  text.append (number, length);
+		}
+	      text += '\n';
+	    }
+	  if (text.size () >= DECODE_WRITE_BYTES)
+	    {
+	      output.write (text.data (), text.size ());
+	      text.clear ();
+	    }
+	}
+      offset += layout->mRecordSize;
+    }
+  if (offset < size)
+    {
+      truncatedBytes = size - offset;
+    }
+  output.write (text.data (), text.size ());
+  output.flush ();
+
+  if (options.mVerboseMode)
+    {
+      std::cerr << "Decode:";
+      for (size_t index = 0; index < schema.LayoutCount (); index++)
+	{
+	  if (recordCounts[index] > 0)
+	    {
+	      const SchemaLayout &layout = schema.Layout (index);
+	      std::cerr << " " << recordCounts[index] << " " << layout.mName << " (type 0x"
+			<< std::hex << layout.mRecordType << std::dec << ", "
+			<< layout.mRecordSize << " bytes),";
+	    }
+	}
+      std::cerr << " " << otherRecords << " other records, "
+		<< unreadableBytes << " unreadable bytes, "
+		<< truncatedBytes << " bytes in a cut-short record at the end\n";
+    }
+  return 0;
+}
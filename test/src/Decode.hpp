@@ -0,0 +1,37 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DECODE_HPP
+#define DECODE_HPP
+
+#include "TestOptions.hpp"
+
+/* \brief -proto decode: print every record of the -layout layouts in the
+   -file recording as CSV, one row per repeated group of fields, to the
+   -csv file or the console.  Layouts come from the built-in descriptions
+   of this program's records and from the -schema file, so recordings
+   from other firmware versions decode without a rebuild.  When layouts of
+   the same name differ, the columns are all of their fields, and a field
+   a record does not have is left blank.
+   \return 0 on success, 1 if the file or the layouts can't be read. */
+int RunDecode (MagElementTestOptions &options);
+
+#endif
@@ -0,0 +1,119 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include "DecodedColumns.hpp"
+
+void DecodeRawBlock (const StreamerPacket &streamerPacket, DecodedRawBlock &decoded)
+{
+  decoded.mFirstPacketIndex = streamerPacket.mStructuredHeader.mFirstPacketIndex;
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      const MfamSpiPacket  &mag = streamerPacket.mDataBlock[index].mMagData;
+      const A2d16Quadruple &analogs = streamerPacket.mDataBlock[index].mAnalogs;
+
+      decoded.mMag1[index]     = mag.mag1data;
+      decoded.mMag2[index]     = mag.mag2data;
+      decoded.mFrameId[index]  = mag.frameid;
+      decoded.mSysStat[index]  = mag.sysstat;
+      decoded.mMag1Stat[index] = mag.mag1stat;
+      decoded.mMag2Stat[index] = mag.mag2stat;
+      decoded.mAux[0][index]   = mag.auxsenx;
+      decoded.mAux[1][index]   = mag.auxseny;
+      decoded.mAux[2][index]   = mag.auxsenz;
+      decoded.mAux[3][index]   = mag.auxsent;
+      decoded.mAdc[0][index]   = analogs.adc0;
+      decoded.mAdc[1][index]   = analogs.adc1;
+      decoded.mAdc[2][index]   = analogs.adc2;
+      decoded.mAdc[3][index]   = analogs.adc3;
+
+      decoded.mMag1Valid[index] = (IS_MAG1_VALID (mag.frameid) && !IS_DEAD_ZONE (mag.mag1stat)) ? 1 : 0;
+      decoded.mMag2Valid[index] = (IS_MAG2_VALID (mag.frameid) && !IS_DEAD_ZONE (mag.mag2stat)) ? 1 : 0;
+    }
+}
+
+void SampleColumns::Reserve (size_t samples)
+{
+  mIndex.reserve (samples);
+  mMag1.reserve (samples);
+  mMag2.reserve (samples);
+  mFrameId.reserve (samples);
+  mSysStat.reserve (samples);
+  mMag1Stat.reserve (samples);
+  mMag2Stat.reserve (samples);
+  for (int channel = 0; channel < 4; channel++)
+    {
+      mAux[channel].reserve (samples);
+      mAdc[channel].reserve (samples);
+    }
+  mMag1Valid.reserve (samples);
+  mMag2Valid.reserve (samples);
+}
+
+void SampleColumns::Clear ()
+{
+  mIndex.clear ();
+  mMag1.clear ();
+  mMag2.clear ();
+  mFrameId.clear ();
+  mSysStat.clear ();
+  mMag1Stat.clear ();
+  mMag2Stat.clear ();
+  for (int channel = 0; channel < 4; channel++)
+    {
+      mAux[channel].clear ();
+      mAdc[channel].clear ();
+    }
+  mMag1Valid.clear ();
+  mMag2Valid.clear ();
+}
+
+void SampleColumns::Append (const StreamerPacket &streamerPacket, uint32_t firstSample, uint32_t count)
+{
+  uint64_t firstIndex = streamerPacket.mStructuredHeader.mFirstPacketIndex;
+  uint32_t last = firstSample + count;
+  if (last > MFAM_STREAMER_CACHE_SIZE)
+    {
+      last = MFAM_STREAMER_CACHE_SIZE;
+    }
+  for (uint32_t index = firstSample; index < last; index++)
+    {
+      const MfamSpiPacket  &mag = streamerPacket.mDataBlock[index].mMagData;
+      const A2d16Quadruple &analogs = streamerPacket.mDataBlock[index].mAnalogs;
+
+      mIndex.push_back (firstIndex + index);
+      mMag1.push_back (mag.mag1data);
+      mMag2.push_back (mag.mag2data);
+      mFrameId.push_back (mag.frameid);
+      mSysStat.push_back (mag.sysstat);
+      mMag1Stat.push_back (mag.mag1stat);
+      mMag2Stat.push_back (mag.mag2stat);
+      mAux[0].push_back (mag.auxsenx);
+      mAux[1].push_back (mag.auxseny);
+      mAux[2].push_back (mag.auxsenz);
+      mAux[3].push_back (mag.auxsent);
+      mAdc[0].push_back (analogs.adc0);
+      mAdc[1].push_back (analogs.adc1);
+      mAdc[2].push_back (analogs.adc2);
+      mAdc[3].push_back (analogs.adc3);
+      mMag1Valid.push_back ((IS_MAG1_VALID (mag.frameid) && !IS_DEAD_ZONE (mag.mag1stat)) ? 1 : 0);
+      mMag2Valid.push_back ((IS_MAG2_VALID (mag.frameid) && !IS_DEAD_ZONE (mag.mag2stat)) ? 1 : 0);
+    }
+}
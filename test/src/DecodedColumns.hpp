@@ -0,0 +1,77 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DECODED_COLUMNS_HPP
+#define DECODED_COLUMNS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "MagElementData.hpp"
+
+/* The 40 samples of a 1000Hz block, rearranged from records into one
+   array per field ("columns"), which is the form that numerical stages
+   want.  Mag values stay in integer LSBs; scale with MAG_DATA_AS_FLOAT
+   or MFAM_NANOTESLAS_PER_LSB when nanoteslas are needed. */
+struct DecodedRawBlock
+{
+  uint64_t mFirstPacketIndex = 0;
+  uint32_t mMag1[MFAM_STREAMER_CACHE_SIZE];
+  uint32_t mMag2[MFAM_STREAMER_CACHE_SIZE];
+  uint16_t mFrameId[MFAM_STREAMER_CACHE_SIZE];
+  uint16_t mSysStat[MFAM_STREAMER_CACHE_SIZE];
+  uint16_t mMag1Stat[MFAM_STREAMER_CACHE_SIZE];
+  uint16_t mMag2Stat[MFAM_STREAMER_CACHE_SIZE];
+  uint16_t mAux[4][MFAM_STREAMER_CACHE_SIZE];     /* auxsenx, auxseny, auxsenz, auxsent */
+  uint16_t mAdc[4][MFAM_STREAMER_CACHE_SIZE];     /* adc0 .. adc3 */
+  uint8_t  mMag1Valid[MFAM_STREAMER_CACHE_SIZE];  /* 1 if valid and not in the dead zone */
+  uint8_t  mMag2Valid[MFAM_STREAMER_CACHE_SIZE];
+};
+
+/* \brief Split a 1000Hz block into columns. */
+void DecodeRawBlock (const StreamerPacket &streamerPacket, DecodedRawBlock &decoded);
+
+/* The same columns for any number of samples, from any number of blocks,
+   each sample with its packet index; for consumers that work on long runs
+   of data, such as the Python bindings. */
+struct SampleColumns
+{
+  std::vector<uint64_t> mIndex;
+  std::vector<uint32_t> mMag1;
+  std::vector<uint32_t> mMag2;
+  std::vector<uint16_t> mFrameId;
+  std::vector<uint16_t> mSysStat;
+  std::vector<uint16_t> mMag1Stat;
+  std::vector<uint16_t> mMag2Stat;
+  std::vector<uint16_t> mAux[4];
+  std::vector<uint16_t> mAdc[4];
+  std::vector<uint8_t>  mMag1Valid;
+  std::vector<uint8_t>  mMag2Valid;
+
+  size_t Size () const { return mIndex.size (); }
+  void   Reserve (size_t samples);
+  void   Clear ();
+
+  /* \brief Add count samples of a block, starting with sample firstSample. */
+  void   Append (const StreamerPacket &streamerPacket, uint32_t firstSample, uint32_t count);
+};
+
+#endif
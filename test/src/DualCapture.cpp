@@ -0,0 +1,418 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <boost/asio.hpp>
+#include "MagElementData.hpp"
+#include "RecordUtilities.hpp"
+#include "ReorderWindow.hpp"
+#include "TestClient.hpp"
+#include "DualCapture.hpp"
+
+using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
+
+/* Bytes taken from the TCP stream at a time. */
+#define DUAL_TCP_READ_BYTES 16384
+
+static const char *sPathNames[2] = { "udp", "tcp" };
+
+SlidingBitmap::SlidingBitmap ()
+  : mWords (DEDUP_WINDOW_BITS / 64, 0),
+    mMarks (DEDUP_WINDOW_BITS / 64, 0)
+{
+}
+
+/* Clear the bits of keys first ... last, fewer than DEDUP_WINDOW_BITS of
+   them; whole words at a time where the range covers them. */
+void SlidingBitmap::Clear (uint64_t first, uint64_t last)
+{
+  uint64_t key = first;
+  while (key <= last)
+    {
+      uint64_t bit = key & 63;
+      uint64_t count = std::min<uint64_t> (64 - bit, last - key + 1);
+      uint64_t bits = (count == 64) ? ~(uint64_t)0 : (((uint64_t)1 << count) - 1) << bit;
+      size_t   word = (key & (DEDUP_WINDOW_BITS - 1)) >> 6;
+      mWords[word] &= ~bits;
+      mMarks[word] &= ~bits;
+      key += count;
+    }
+}
+
+void SlidingBitmap::ClearAll ()
+{
+  std::fill (mWords.begin (), mWords.end (), 0);
+  std::fill (mMarks.begin (), mMarks.end (), 0);
+}
+
+bool SlidingBitmap::Forgets (uint64_t key) const
+{
+  return !mStarted || ((key > mTop) && (key - mTop >= DEDUP_WINDOW_BITS)) ||
+    ((key < mTop) && (mTop - key >= DEDUP_RESTART_KEYS));
+}
+
+SlidingBitmap::Result SlidingBitmap::TestAndSet (uint64_t key, bool mark)
+{
+  if (Forgets (key))
+    {
+      ClearAll ();
+      mStarted = true;
+      mTop = key;
+    }
+  else if (key > mTop)
+    {
+      Clear (mTop + 1, key);
+      mTop = key;
+    }
+  else if (mTop - key >= DEDUP_WINDOW_BITS)
+    {
+      return SEEN_TOO_LATE;
+    }
+
+  size_t   word = (key & (DEDUP_WINDOW_BITS - 1)) >> 6;
+  uint64_t bit = (uint64_t)1 << (key & 63);
+  if ((mWords[word] & bit) != 0)
+    {
+      return SEEN_BEFORE;
+    }
+  mWords[word] |= bit;
+  if (mark)
+    {
+      mMarks[word] |= bit;
+    }
+  return SEEN_NEW;
+}
+
+
+DualPathMerger::DualPathMerger (RecordOutput output, bool verbose)
+  : mOutput (output), mVerbose (verbose)
+{
+}
+
+void DualPathMerger::Offer (const RecordRef &record, DualPath path)
+{
+  std::lock_guard<std::mutex> lock (mLock);
+  RecordHeader header;
+  memcpy (&header, record.Data (), sizeof (header));
+  uint64_t index = GetRecordIndex (record.Data ());
+  SlidingBitmap::Result result;
+  switch (header.mRecordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      AddBlock (index, path, result);
+      break;
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      result = mDecimated.TestAndSet (index);
+      break;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      result = mHeartbeats.TestAndSet (index);
+      break;
+    default:
+      mOther[path]++;
+      return;
+    }
+
+  if (result == SlidingBitmap::SEEN_BEFORE)
+    {
+      mDuplicates[path]++;
+    }
+  else if (result == SlidingBitmap::SEEN_TOO_LATE)
+    {
+      mLate[path]++;
+    }
+  else
+    {
+      mPassed[path]++;
+      mOutput (record);
+    }
+}
+
+void DualPathMerger::AddBlock (uint64_t index, DualPath path, SlidingBitmap::Result &result)
+{
+  uint64_t key = index / MFAM_STREAMER_CACHE_SIZE;
+  if (mBlocks.Forgets (key))
+    {
+      /* Settle the runs of the blocks the bitmap is about to forget; a
+	 jump forward leaves the blocks between missing. */
+      if (mHaveCursor)
+	{
+	  AdvanceRuns (true);
+	  if (key > mCursor)
+	    {
+	      mMissing += key - mCursor;
+	    }
+	}
+      mHaveCursor = true;
+      mCursor = mFirstKey = key;
+      mPhase = index % MFAM_STREAMER_CACHE_SIZE;
+    }
+  result = mBlocks.TestAndSet (key, path == DUAL_PATH_TCP);
+  if (result != SlidingBitmap::SEEN_NEW)
+    {
+      return;
+    }
+  if (key < mCursor)
+    {
+      /* Filled after it had been counted missing, unless it came before
+	 the first block, which the runs start from. */
+      if (key >= mFirstKey)
+	{
+	  mMissing--;
+	}
+      return;
+    }
+  AdvanceRuns (false);
+}
+
+/* Move the cursor over the blocks seen, in index order, and over a missing
+   one once DUAL_SETTLE_BLOCKS later blocks have arrived, or at once if
+   settled.  Each block is passed over once. */
+void DualPathMerger::AdvanceRuns (bool settled)
+{
+  uint64_t top = mBlocks.Top ();
+  while (mCursor <= top)
+    {
+      if (mBlocks.Seen (mCursor))
+	{
+	  AddToRun (mCursor, mBlocks.Marked (mCursor) ? DUAL_PATH_TCP : DUAL_PATH_UDP);
+	}
+      else if (settled || (top - mCursor >= DUAL_SETTLE_BLOCKS))
+	{
+	  mMissing++;
+	  CloseRun ();
+	}
+      else
+	{
+	  break;
+	}
+      mCursor++;
+    }
+}
+
+void DualPathMerger::AddToRun (uint64_t key, DualPath path)
+{
+  uint64_t index = key * MFAM_STREAMER_CACHE_SIZE + mPhase;
+  if (mHaveRun && (mRun.mPath == path))
+    {
+      mRun.mLastIndex = index;
+      mRun.mBlocks++;
+      return;
+    }
+  CloseRun ();
+  mRun = { path, index, index, 1 };
+  mHaveRun = true;
+}
+
+void DualPathMerger::CloseRun ()
+{
+  if (!mHaveRun)
+    {
+      return;
+    }
+  mRunCount++;
+  if (mRuns.size () < DUAL_MAX_LISTED)
+    {
+      mRuns.push_back (mRun);
+    }
+  if (mVerbose)
+    {
+      std::cerr << "Dual: blocks " << mRun.mFirstIndex << " to " << mRun.mLastIndex
+		<< " (" << mRun.mBlocks << ") from " << sPathNames[mRun.mPath] << "\n";
+    }
+  mHaveRun = false;
+}
+
+void DualPathMerger::Finish ()
+{
+  std::lock_guard<std::mutex> lock (mLock);
+  if (mHaveCursor)
+    {
+      AdvanceRuns (true);
+    }
+  CloseRun ();
+}
+
+void DualPathMerger::Report (std::ostream &output) const
+{
+  output << "Dual path capture:\n";
+  for (int path = DUAL_PATH_UDP; path <= DUAL_PATH_TCP; path++)
+    {
+      output << "  " << sPathNames[path] << ": " << mPassed[path] << " records passed on, "
+	     << mDuplicates[path] << " duplicates, " << mLate[path] << " too late";
+      if (mOther[path] > 0)
+	{
+	  output << ", " << mOther[path] << " of other types";
+	}
+      output << "\n";
+    }
+  output << "  1000Hz blocks missing from both paths: " << mMissing << "\n";
+  output << "  runs of blocks from one path: " << mRunCount << "\n";
+  for (const PathRun &run : mRuns)
+    {
+      output << "    " << run.mFirstIndex << " to " << run.mLastIndex << ", "
+	     << run.mBlocks << " blocks from " << sPathNames[run.mPath] << "\n";
+    }
+  if (mRunCount > mRuns.size ())
+    {
+      output << "    ... and " << mRunCount - mRuns.size () << " more\n";
+    }
+}
+
+
+static void ReceiveUdp (udp::socket &socket, RecordPool &pool, DualPathMerger &merger)
+{
+  udp::endpoint remote;
+  try
+    {
+      while (!ShutdownRequested ())
+	{
+	  /* A datagram's size is known only once it has arrived, so receive
+	     into a pool buffer large enough for any record. */
+	  RecordRef record = pool.Allocate (MAX_RECORD_LENGTH);
+	  size_t length = socket.receive_from (boost::asio::buffer (record.Buffer (), record.Capacity ()), remote);
+	  if ((length >= sizeof (RecordHeader)) && IsValidRecordHeader (record.Data ()))
+	    {
+	      RecordHeader header;
+	      memcpy (&header, record.Data (), sizeof (header));
+	      if (header.mRecordSize <= length)
+		{
+		  record.SetLength (header.mRecordSize);
+		  merger.Offer (record, DUAL_PATH_UDP);
+		}
+	    }
+	}
+    }
+  catch (std::exception &e)
+    {
+      if (!ShutdownRequested ())
+	{
+	  std::cerr << "UDP path ended: " << e.what () << "\n";
+	}
+    }
+}
+
+static void ReceiveTcp (tcp::socket &socket, RecordPool &pool, DualPathMerger &merger)
+{
+  RecordStreamSplitter splitter;
+  std::vector<uint8_t> buffer (DUAL_TCP_READ_BYTES);
+  try
+    {
+      while (!ShutdownRequested ())
+	{
+	  size_t length = socket.read_some (boost::asio::buffer (buffer.data (), buffer.size ()));
+	  splitter.Add (buffer.data (), length,
+			[&pool, &merger] (const uint8_t *record, uint32_t recordLength)
+			{
+			  merger.Offer (pool.Copy (record, recordLength), DUAL_PATH_TCP);
+			});
+	}
+    }
+  catch (std::exception &e)
+    {
+      if (!ShutdownRequested ())
+	{
+	  std::cerr << "TCP path ended: " << e.what () << "\n";
+	}
+    }
+}
+
+int RunDualCapture (MagElementTestOptions &options, Pipeline &pipeline)
+{
+  if (options.mVerboseMode)
+    {
+      std::cerr << "Running UDP and TCP... \n";
+    }
+
+  /* -reorder: records go through the reorder window on their way to the
+     pipeline, as for udp. */
+  std::unique_ptr<ReorderWindow> reorder;
+  if (options.mReorderSlots > 0)
+    {
+      uint32_t slots = options.mReorderSlots;
+      double   holdMs = options.mReorderHoldMs;
+      reorder = std::make_unique<ReorderWindow> (slots, holdMs,
+						 [&pipeline] (const RecordRef &record) { pipeline.Submit (record); });
+    }
+  DualPathMerger merger ([&pipeline, &reorder] (const RecordRef &record)
+			 {
+			   if (reorder)
+			     {
+			       reorder->Add (record, ReorderWindow::Clock::now ());
+			     }
+			   else
+			     {
+			       pipeline.Submit (record);
+			     }
+			 },
+			 options.mVerboseMode);
+
+  boost::asio::io_context io_context;
+  udp::socket udpSocket (io_context);
+  tcp::socket tcpSocket (io_context);
+  try
+    {
+      uint32_t udpPort = (options.mUdpPort != 0) ? options.mUdpPort : (uint32_t)atoi (options.mRemotePort.data ());
+      udpSocket.open (udp::v4 ());
+      udpSocket.bind (udp::endpoint (udp::v4 (), (unsigned short)udpPort));
+      tcp::resolver resolver (io_context);
+      boost::asio::connect (tcpSocket, resolver.resolve (tcp::v4 (), options.mRemote, options.mRemotePort));
+    }
+  catch (std::exception &e)
+    {
+      std::cerr << "\n\nError: Dual path capture can't start: " << e.what () << "\n\n";
+      return 1;
+    }
+
+  /* Each path blocks in its own thread; the merger serializes them. */
+  std::atomic<int> running {2};
+  std::thread udpThread ([&] { ReceiveUdp (udpSocket, pipeline.Pool (), merger); running--; });
+  std::thread tcpThread ([&] { ReceiveTcp (tcpSocket, pipeline.Pool (), merger); running--; });
+  while (!ShutdownRequested () && (running > 0))
+    {
+      std::this_thread::sleep_for (std::chrono::milliseconds (100));
+    }
+
+  /* Wake the threads from their blocking reads. */
+  boost::system::error_code ignored;
+  udpSocket.shutdown (boost::asio::socket_base::shutdown_both, ignored);
+  tcpSocket.shutdown (boost::asio::socket_base::shutdown_both, ignored);
+  udpThread.join ();
+  tcpThread.join ();
+
+  merger.Finish ();
+  if (reorder)
+    {
+      reorder->Flush ();
+      if (options.mVerboseMode)
+	{
+	  reorder->Report (std::cerr);
+	}
+    }
+  merger.Report (std::cout);
+  return 0;
+}
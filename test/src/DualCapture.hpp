@@ -0,0 +1,161 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef DUAL_CAPTURE_HPP
+#define DUAL_CAPTURE_HPP
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "Pipeline.hpp"
+#include "RecordPool.hpp"
+#include "TestOptions.hpp"
+
+/* Bits kept by each sliding bitmap, and the backward jump in key that is
+   taken to be a restart of the instrument rather than a late copy. */
+#define DEDUP_WINDOW_BITS   (1 << 17)
+#define DEDUP_RESTART_KEYS  ((uint64_t)1 << 24)
+
+/* A 1000Hz block still missing when this many later blocks have arrived
+   is counted as missing from both paths, and ends the run it was in. */
+#define DUAL_SETTLE_BLOCKS  4096
+
+/* Only the first few runs are kept for the report; all are counted. */
+#define DUAL_MAX_LISTED     100
+
+enum DualPath
+{
+  DUAL_PATH_UDP = 0,
+  DUAL_PATH_TCP = 1
+};
+
+/* Which keys have been seen, for the last DEDUP_WINDOW_BITS keys up to the
+   highest, with one more bit per key for the caller.  Moving the window
+   forward clears the bits that enter it a word at a time, so each key
+   costs O(1) on average. */
+class SlidingBitmap
+{
+public:
+  enum Result { SEEN_NEW, SEEN_BEFORE, SEEN_TOO_LATE };
+
+  SlidingBitmap ();
+
+  /* \brief Mark key as seen, and set its second bit to mark if it is new.
+     \return  SEEN_NEW if it was not seen before, SEEN_BEFORE if it was,
+     or SEEN_TOO_LATE if it is older than the window. */
+  Result   TestAndSet (uint64_t key, bool mark = false);
+
+  /* \brief True if TestAndSet(key) would forget every key seen so far:
+     the first key, a restart, or a jump forward past the window. */
+  bool     Forgets (uint64_t key) const;
+
+  /* For keys in the window, Top() - DEDUP_WINDOW_BITS < key <= Top(). */
+  bool     Seen (uint64_t key) const { return Bit (mWords, key); }
+  bool     Marked (uint64_t key) const { return Bit (mMarks, key); }
+  uint64_t Top () const { return mTop; }
+
+private:
+  static bool Bit (const std::vector<uint64_t> &words, uint64_t key)
+  {
+    return ((words[(key & (DEDUP_WINDOW_BITS - 1)) >> 6] >> (key & 63)) & 1) != 0;
+  }
+  void     Clear (uint64_t first, uint64_t last);
+  void     ClearAll ();
+
+  std::vector<uint64_t> mWords;
+  std::vector<uint64_t> mMarks;
+  bool                  mStarted = false;
+  uint64_t              mTop = 0;         /* Highest key seen */
+};
+
+/* Takes the records received over both UDP and TCP and passes on the
+   first copy of each, by record type and packet index (1000Hz blocks by
+   mFirstPacketIndex, decimated and heartbeat records by mIndex).  Which
+   path supplied each 1000Hz block is kept with it in the bitmap, and the
+   blocks are gathered, in index order, into runs from one path, which
+   are reported as they end, with -verbose, and listed at the end.  Both
+   receive threads call Offer(); a lock serializes it, and it does O(1)
+   work per record on average. */
+class DualPathMerger
+{
+public:
+  typedef std::function<void (const RecordRef &record)> RecordOutput;
+
+  DualPathMerger (RecordOutput output, bool verbose);
+
+  void Offer (const RecordRef &record, DualPath path);
+
+  /* \brief Close the last run; when both paths have ended. */
+  void Finish ();
+
+  void Report (std::ostream &output) const;
+
+private:
+  struct PathRun
+  {
+    DualPath mPath;
+    uint64_t mFirstIndex;
+    uint64_t mLastIndex;
+    uint64_t mBlocks;
+  };
+
+  void AddBlock (uint64_t index, DualPath path, SlidingBitmap::Result &result);
+  void AdvanceRuns (bool settled);
+  void AddToRun (uint64_t key, DualPath path);
+  void CloseRun ();
+
+  std::mutex           mLock;
+  RecordOutput         mOutput;
+  bool                 mVerbose;
+  SlidingBitmap        mBlocks;                  /* Keyed on block number; marked if from TCP */
+  SlidingBitmap        mDecimated;
+  SlidingBitmap        mHeartbeats;
+
+  uint64_t             mPassed[2] = { 0, 0 };
+  uint64_t             mDuplicates[2] = { 0, 0 };
+  uint64_t             mLate[2] = { 0, 0 };
+  uint64_t             mOther[2] = { 0, 0 };      /* Records of other types, dropped */
+
+  /* Blocks before mCursor have been put into runs, or counted missing */
+  bool                 mHaveCursor = false;
+  uint64_t             mCursor = 0;
+  uint64_t             mFirstKey = 0;            /* Where the runs start */
+  uint64_t             mPhase = 0;               /* mFirstPacketIndex % MFAM_STREAMER_CACHE_SIZE */
+  uint64_t             mMissing = 0;
+
+  bool                 mHaveRun = false;
+  PathRun              mRun;
+  uint64_t             mRunCount = 0;
+  std::vector<PathRun> mRuns;
+};
+
+/* \brief -proto dual: receive the same instrument over UDP, on -udp-port
+   (default -port), and over TCP, from -addr and -port, at once, one
+   thread each, and pass the first copy of each record to the processing
+   pipeline (through -reorder, if given), so that either path fills the
+   gaps of the other.  A path that fails ends, and the other carries on.
+   \return 0 when q is pressed or both paths have ended, 1 if a path
+   can't be opened. */
+int RunDualCapture (MagElementTestOptions &options, Pipeline &pipeline);
+
+#endif
@@ -0,0 +1,95 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "RecordingReader.hpp"
+#include "Extract.hpp"
+
+/* Samples read from the recording at a time. */
+#define EXTRACT_CHUNK_SAMPLES 65536
+
+int RunExtract (MagElementTestOptions &options)
+{
+  RecordingReader reader;
+  if (!reader.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+
+  uint64_t first = options.mExtractAll ? reader.FirstIndex () : options.mExtractFirst;
+  uint64_t end = options.mExtractAll ? reader.EndIndex () : options.mExtractLast + 1;
+  if (end < first)
+    {
+      end = first;
+    }
+
+  std::ofstream csvFile;
+  if (!options.mExtractFileName.empty ())
+    {
+      csvFile.open (options.mExtractFileName);
+      if (!csvFile)
+	{
+	  std::cerr << "\n\nError: CSV file " << options.mExtractFileName << " can't be opened\n\n";
+	  return 1;
+	}
+    }
+  std::ostream &output = csvFile.is_open () ? (std::ostream &)csvFile : std::cout;
+
+  std::vector<double> mag1 (EXTRACT_CHUNK_SAMPLES);
+  std::vector<double> mag2 (EXTRACT_CHUNK_SAMPLES);
+  uint64_t found = 0;
+  output << "index,mag1,mag2\n" << std::fixed << std::setprecision (6);
+  for (uint64_t chunk = first; chunk < end; chunk += EXTRACT_CHUNK_SAMPLES)
+    {
+      uint64_t count = std::min<uint64_t> (EXTRACT_CHUNK_SAMPLES, end - chunk);
+      found += reader.ReadMag (chunk, count, mag1.data (), mag2.data ());
+      for (uint64_t sample = 0; sample < count; sample++)
+	{
+	  output << chunk + sample << ",";
+	  if (!std::isnan (mag1[sample]))
+	    {
+	      output << mag1[sample];
+	    }
+	  output << ",";
+	  if (!std::isnan (mag2[sample]))
+	    {
+	      output << mag2[sample];
+	    }
+	  output << "\n";
+	}
+    }
+
+  if (options.mVerboseMode)
+    {
+      std::cerr << "Extract: indices " << first << " to " << end << " (exclusive), "
+		<< found << " of " << end - first << " samples in the recording, "
+		<< reader.Decimated (first, end).Size () << " decimated and "
+		<< reader.Heartbeats (first, end).Size () << " heartbeat records in range; "
+		<< reader.BlockCount () << " blocks in the file, "
+		<< reader.UnreadableBytes () << " unreadable bytes\n";
+    }
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cmath>
+#include "Fft.hpp"
+
+static const double sPi = 3.14159265358979323846;
+
+bool RealFft::IsValidLength (uint32_t length)
+{
+  return (length >= 4) && ((length & (length - 1)) == 0);
+}
+
+RealFft::RealFft (uint32_t length)
+  : mLength (length), mHalf (length / 2),
+    mBitReverse (mHalf), mTwiddleRe (mHalf / 2), mTwiddleIm (mHalf / 2),
+    mSplitRe (mHalf + 1), mSplitIm (mHalf + 1),
+    mWorkRe (mHalf), mWorkIm (mHalf)
+{
+  uint32_t bits = 0;
+  while ((1u << bits) < mHalf)
+    {
+      bits++;
+    }
+  for (uint32_t index = 0; index < mHalf; index++)
+    {
+      uint32_t reversed = 0;
+      for (uint32_t bit = 0; bit < bits; bit++)
+	{
+	  if (index & (1u << bit))
+	    {
+	      reversed |= 1u << (bits - 1 - bit);
+	    }
+	}
+      mBitReverse[index] = reversed;
+    }
+  for (uint32_t k = 0; k < mHalf / 2; k++)
+    {
+      mTwiddleRe[k] = std::cos (2.0 * sPi * k / mHalf);
+      mTwiddleIm[k] = -std::sin (2.0 * sPi * k / mHalf);
+    }
+  for (uint32_t k = 0; k <= mHalf; k++)
+    {
+      mSplitRe[k] = std::cos (2.0 * sPi * k / mLength);
+      mSplitIm[k] = -std::sin (2.0 * sPi * k / mLength);
+    }
+}
+
+/* In-place iterative decimation-in-time FFT of mWork, which must already be
+   in bit-reversed order. */
+void RealFft::ComplexForward ()
+{
+  double *re = mWorkRe.data ();
+  double *im = mWorkIm.data ();
+  for (uint32_t span = 1; span < mHalf; span <<= 1)
+    {
+      uint32_t twiddleStep = mHalf / (2 * span);
+      for (uint32_t start = 0; start < mHalf; start += 2 * span)
+	{
+	  for (uint32_t k = 0; k < span; k++)
+	    {
+	      double wr = mTwiddleRe[k * twiddleStep];
+	      double wi = mTwiddleIm[k * twiddleStep];
+	      uint32_t top = start + k;
+	      uint32_t bottom = top + span;
+	      double tr = re[bottom] * wr - im[bottom] * wi;
+	      double ti = re[bottom] * wi + im[bottom] * wr;
+	      re[bottom] = re[top] - tr;
+	      im[bottom] = im[top] - ti;
+	      re[top] += tr;
+	      im[top] += ti;
+	    }
+	}
+    }
+}
+
+void RealFft::Forward (const double *input, double *re, double *im)
+{
+  /* Pack even samples as real parts, odd samples as imaginary parts. */
+  for (uint32_t index = 0; index < mHalf; index++)
+    {
+      uint32_t target = mBitReverse[index];
+      mWorkRe[target] = input[2 * index];
+      mWorkIm[target] = input[2 * index + 1];
+    }
+  ComplexForward ();
+
+  /* Separate the spectra of the even and odd samples, and combine. */
+  for (uint32_t k = 0; k <= mHalf; k++)
+    {
+      uint32_t a = k % mHalf;
+      uint32_t b = (mHalf - k) % mHalf;
+      double evenRe = 0.5 * (mWorkRe[a] + mWorkRe[b]);
+      double evenIm = 0.5 * (mWorkIm[a] - mWorkIm[b]);
+      double oddRe  = 0.5 * (mWorkIm[a] + mWorkIm[b]);
+      double oddIm  = -0.5 * (mWorkRe[a] - mWorkRe[b]);
+      re[k] = evenRe + mSplitRe[k] * oddRe - mSplitIm[k] * oddIm;
+      im[k] = evenIm + mSplitRe[k] * oddIm + mSplitIm[k] * oddRe;
+    }
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <stdint.h>
+#include <vector>
+
+/* Radix-2 FFT of real input, for power-of-two lengths.  The transform is
+   done as a complex FFT of half the length on the even/odd samples packed
+   into real/imaginary parts, then split into the real spectrum.  All tables
+   and work space are allocated by the constructor, so Forward() does no
+   allocation. */
+class RealFft
+{
+public:
+  /* length must be a power of two, 4 or more. */
+  explicit RealFft (uint32_t length);
+
+  uint32_t Length () const { return mLength; }
+  uint32_t BinCount () const { return mLength / 2 + 1; }
+
+  /* Transform length samples of input into BinCount() bins, 0 (DC) to
+     length/2 (Nyquist).  Unnormalized: bin k is sum x[n] e^(-2 pi i k n / length). */
+  void Forward (const double *input, double *re, double *im);
+
+  static bool IsValidLength (uint32_t length);
+
+private:
+  void ComplexForward ();
+
+  uint32_t              mLength;
+  uint32_t              mHalf;
+  std::vector<uint32_t> mBitReverse;   /* Permutation for the half-length FFT */
+  std::vector<double>   mTwiddleRe;    /* e^(-2 pi i k / mHalf), k < mHalf / 2 */
+  std::vector<double>   mTwiddleIm;
+  std::vector<double>   mSplitRe;      /* e^(-2 pi i k / mLength), k <= mHalf */
+  std::vector<double>   mSplitIm;
+  std::vector<double>   mWorkRe;
+  std::vector<double>   mWorkIm;
+};
+
+#endif
@@ -0,0 +1,437 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "BatchCheck.hpp"
+#include "Checksum.hpp"
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "RecordValidation.hpp"
+#include "TestClient.hpp"
+#include "FileFollow.hpp"
+
+/* The longest wait for a change before looking anyway, and the most
+   read from the file at once. */
+#define FOLLOW_POLL_MS    250
+#define FOLLOW_READ_BYTES (1 << 20)
+
+/* Waits for something to change in the directory that holds the
+   recording: with inotify on Linux, elsewhere by sleeping. */
+class ChangeWatcher
+{
+public:
+  explicit ChangeWatcher (const std::string &directory);
+  ~ChangeWatcher ();
+
+  /* \brief Wait up to FOLLOW_POLL_MS for a change.
+     \return  True if a file may have been added, renamed or removed, so
+     that the segments should be listed again. */
+  bool Wait ();
+
+private:
+  int mFd = -1;
+};
+
+#ifdef __linux__
+ChangeWatcher::ChangeWatcher (const std::string &directory)
+{
+  mFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if ((mFd >= 0) &&
+      (inotify_add_watch (mFd, directory.c_str (), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE |
+			  IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0))
+    {
+      std::cerr << "Can't watch " << directory << " (" << strerror (errno)
+		<< "); looking for changes every " << FOLLOW_POLL_MS << " ms\n";
+      close (mFd);
+      mFd = -1;
+    }
+}
+
+ChangeWatcher::~ChangeWatcher ()
+{
+  if (mFd >= 0)
+    {
+      close (mFd);
+    }
+}
+
+bool ChangeWatcher::Wait ()
+{
+  if (mFd < 0)
+    {
+      std::this_thread::sleep_for (std::chrono::milliseconds (FOLLOW_POLL_MS));
+      return true;
+    }
+  struct pollfd watch = { mFd, POLLIN, 0 };
+  if (poll (&watch, 1, FOLLOW_POLL_MS) <= 0)
+    {
+      return false;
+    }
+  bool listAgain = false;
+  alignas (struct inotify_event) char events[4096];
+  ssize_t length;
+  while ((length = read (mFd, events, sizeof (events))) > 0)
+    {
+      for (ssize_t offset = 0; offset < length; )
+	{
+	  const struct inotify_event *event = (const struct inotify_event *)(events + offset);
+	  if ((event->mask & (IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_Q_OVERFLOW)) != 0)
+	    {
+	      listAgain = true;
+	    }
+	  offset += sizeof (struct inotify_event) + event->len;
+	}
+    }
+  return listAgain;
+}
+#else
+ChangeWatcher::ChangeWatcher (const std::string &directory)
+{
+}
+
+ChangeWatcher::~ChangeWatcher ()
+{
+}
+
+bool ChangeWatcher::Wait ()
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (FOLLOW_POLL_MS));
+  return true;
+}
+#endif
+
+/* Reads one segment of the recording as it grows, keeping the checks
+   of RecordValidation across segments. */
+class RecordingFollower
+{
+public:
+  explicit RecordingFollower (Pipeline &pipeline) : mPipeline (pipeline) {}
+  ~RecordingFollower () { Close (); }
+
+  /* \brief Start following fileName from its first byte. */
+  bool Open (const std::string &fileName);
+
+  /* \brief Read and check the bytes appended since the last call. */
+  void ReadAppended ();
+
+  /* \brief True if the file has been cut short, or replaced by another of
+     the same name, since it was opened. */
+  bool Replaced () const;
+
+  /* \brief Stop following the segment; a partial record left at its end
+     was cut short. */
+  void FinishSegment ();
+
+  bool                    IsOpen () const { return mFile != nullptr; }
+  const std::string      &FileName () const { return mFileName; }
+  const RecordValidation &Validation () const { return mValidation; }
+
+private:
+  void Close ();
+  void HandleRecord (const uint8_t *record, uint32_t length);
+  void ReportSkipped ();
+  bool CheckCoveredBytes (uint64_t offset, const ChecksumPacket &packet);
+
+  Pipeline             &mPipeline;
+  std::string           mFileName;
+  FILE                 *mFile = nullptr;
+  uint64_t              mReadOffset = 0;  /* Bytes read from the segment */
+  uint64_t              mRecordEnd = 0;   /* End of the last record or skipped range */
+  uint64_t              mSkippedSeen = 0;
+  RecordStreamSplitter  mSplitter;
+  RecordChecksum        mChecksum;
+  RecordValidation      mValidation;
+  std::vector<uint8_t>  mBuffer;
+};
+
+bool RecordingFollower::Open (const std::string &fileName)
+{
+  Close ();
+  mFile = fopen (fileName.c_str (), "rb");
+  if (mFile == nullptr)
+    {
+      std::cerr << "\n\nError: Data file " << fileName << " can't be opened to validate data\n\n";
+      return false;
+    }
+  mFileName = fileName;
+  mReadOffset = 0;
+  mRecordEnd = 0;
+  mChecksum = RecordChecksum ();
+  std::cerr << "Following " << fileName << "\n";
+  return true;
+}
+
+void RecordingFollower::Close ()
+{
+  if (mFile != nullptr)
+    {
+      fclose (mFile);
+      mFile = nullptr;
+    }
+}
+
+void RecordingFollower::ReadAppended ()
+{
+  if (mFile == nullptr)
+    {
+      return;
+    }
+  mBuffer.resize (FOLLOW_READ_BYTES);
+  while (!ShutdownRequested ())
+    {
+      size_t bytesRead = fread (mBuffer.data (), 1, mBuffer.size (), mFile);
+      if (bytesRead > 0)
+	{
+	  mReadOffset += bytesRead;
+	  mSplitter.Add (mBuffer.data (), bytesRead,
+			 [this] (const uint8_t *record, uint32_t length) { HandleRecord (record, length); });
+	  ReportSkipped ();
+	}
+      if (bytesRead < mBuffer.size ())
+	{
+	  /* At the end for now; the next read continues from here. */
+	  clearerr (mFile);
+	  break;
+	}
+    }
+}
+
+bool RecordingFollower::Replaced () const
+{
+  if (mFile == nullptr)
+    {
+      return false;
+    }
+  std::error_code error;
+  uint64_t size = std::filesystem::file_size (mFileName, error);
+  if (!error && (size < mReadOffset))
+    {
+      return true;
+    }
+#ifdef __linux__
+  struct stat named, opened;
+  if ((stat (mFileName.c_str (), &named) == 0) && (fstat (fileno (mFile), &opened) == 0) &&
+      ((named.st_ino != opened.st_ino) || (named.st_dev != opened.st_dev)))
+    {
+      return true;
+    }
+#endif
+  return false;
+}
+
+void RecordingFollower::FinishSegment ()
+{
+  size_t partial = mSplitter.PartialBytes ();
+  if (partial > 0)
+    {
+      mValidation.mTruncated = true;
+      mValidation.mTruncatedTail = { mRecordEnd, partial };
+      std::cerr << "Alert: " << mFileName << ": record cut short, " << partial
+		<< " bytes at offset " << mRecordEnd << "\n";
+      mSplitter.Reset ();
+      mSkippedSeen = mSplitter.SkippedBytes ();
+    }
+  Close ();
+}
+
+/* Bytes the splitter passed over since the last record. */
+void RecordingFollower::ReportSkipped ()
+{
+  uint64_t skipped = mSplitter.SkippedBytes () - mSkippedSeen;
+  if (skipped == 0)
+    {
+      return;
+    }
+  mSkippedSeen += skipped;
+  mValidation.AddUnreadable (mRecordEnd, skipped);
+  std::cerr << "Alert: " << mFileName << ": " << skipped << " unreadable bytes at offset "
+	    << mRecordEnd << "\n";
+  mRecordEnd += skipped;
+}
+
+/* As for file-check: a checksum that covers more than the records seen
+   since the one before it is checked against the bytes read again from
+   the file. */
+bool RecordingFollower::CheckCoveredBytes (uint64_t offset, const ChecksumPacket &packet)
+{
+  fpos_t position;
+  if ((packet.mByteCount > offset) || (fgetpos (mFile, &position) != 0))
+    {
+      return false;
+    }
+  /* Relative to the read position, mReadOffset, which keeps the seek
+     within a long even when the segment is larger than 2 GB. */
+  long back = (long)(mReadOffset - (offset - packet.mByteCount));
+  std::vector<uint8_t> covered (packet.mByteCount);
+  bool match = (fseek (mFile, -back, SEEK_CUR) == 0) &&
+    (fread (covered.data (), 1, covered.size (), mFile) == covered.size ()) &&
+    (Crc32c (0, covered.data (), covered.size ()) == packet.mCrc32c);
+  fsetpos (mFile, &position);
+  return match;
+}
+
+void RecordingFollower::HandleRecord (const uint8_t *record, uint32_t length)
+{
+  ReportSkipped ();
+  uint64_t offset = mRecordEnd;
+  mRecordEnd += length;
+
+  RecordHeader header;
+  memcpy (&header, record, sizeof (header));
+  switch (header.mRecordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      {
+	bool     haveIndex = mValidation.mHaveBlockIndex;
+	uint64_t lastIndex = mValidation.mLastBlockIndex;
+	uint64_t gaps = mValidation.mGapCount;
+	uint64_t index = GetRecordIndex (record);
+	mValidation.mBlocks++;
+	mValidation.AddBlockIndex (index);
+	if (haveIndex && (mValidation.mGapCount != gaps))
+	  {
+	    std::cerr << "Alert: " << mFileName << ": index gap, block " << lastIndex
+		      << " then " << index << ", at offset " << offset << "\n";
+	  }
+      }
+      break;
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      mValidation.mDecimated++;
+      break;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      mValidation.mHeartbeats++;
+      break;
+    case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+      mValidation.mGradiometer++;
+      break;
+    case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+    case GM_MAG_ELEMENT_ANOMALY_FORMAT:
+    case GM_MAG_ELEMENT_COMPENSATED_FORMAT:
+    case GM_MAG_ELEMENT_RESAMPLED_FORMAT:
+    case GM_MAG_ELEMENT_FIXED_POINT_FORMAT:
+    case GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT:
+      mValidation.mOtherDerived++;
+      break;
+    case GM_MAG_ELEMENT_CHECKSUM_FORMAT:
+      {
+	/* Checked here and not passed on, as in file-check. */
+	ChecksumPacket packet;
+	memcpy (&packet, record, sizeof (packet));
+	uint32_t runningBytes = mChecksum.Bytes ();
+	bool match = mChecksum.Check (packet);
+	if (!match && (runningBytes != packet.mByteCount))
+	  {
+	    match = CheckCoveredBytes (offset, packet);
+	  }
+	mValidation.mChecksums++;
+	if (!match)
+	  {
+	    mValidation.mChecksumFailures++;
+	    if (mValidation.mBadChecksums.size () < VALIDATION_MAX_LISTED)
+	      {
+		uint64_t covered = std::min<uint64_t> (packet.mByteCount, offset);
+		mValidation.mBadChecksums.push_back ({ offset - covered, covered });
+	      }
+	    std::cerr << "Alert: " << mFileName << ": checksum mismatch, " << packet.mRecordCount
+		      << " records from index " << packet.mFirstPacketIndex
+		      << ", checksum at offset " << offset << "\n";
+	  }
+      }
+      return;
+    }
+  mChecksum.Add (record, length);
+  mPipeline.Submit (mPipeline.Pool ().Copy (record, length));
+}
+
+int RunFileFollow (MagElementTestOptions &options, Pipeline &pipeline)
+{
+  namespace fs = std::filesystem;
+  std::error_code error;
+  fs::path path (options.mFileNameToSave);
+  fs::path directory = fs::is_directory (path, error) ? path : path.parent_path ();
+  if (directory.empty ())
+    {
+      directory = ".";
+    }
+
+  ChangeWatcher      watcher (directory.string ());
+  RecordingFollower  follower (pipeline);
+  bool               listSegments = true;
+  bool               waiting = false;
+  while (!ShutdownRequested ())
+    {
+      bool switched = false;
+      if (listSegments)
+	{
+	  /* Start with the latest segment, then move through the later ones
+	     in name order as they appear. */
+	  std::vector<std::string> segments = ListFiles (options.mFileNameToSave);
+	  if (!follower.IsOpen () && !segments.empty ())
+	    {
+	      switched = follower.Open (segments.back ());
+	    }
+	  else if (follower.IsOpen ())
+	    {
+	      auto next = std::upper_bound (segments.begin (), segments.end (), follower.FileName ());
+	      if (next != segments.end ())
+		{
+		  follower.ReadAppended ();
+		  follower.FinishSegment ();
+		  switched = follower.Open (*next);
+		}
+	    }
+	  if (!follower.IsOpen () && !waiting)
+	    {
+	      std::cerr << "Waiting for " << options.mFileNameToSave << "\n";
+	      waiting = true;
+	    }
+	}
+      if (follower.Replaced ())
+	{
+	  std::string fileName = follower.FileName ();
+	  std::cerr << "Alert: " << fileName << ": cut short or replaced; reading it again from the start\n";
+	  follower.ReadAppended ();
+	  follower.FinishSegment ();
+	  follower.Open (fileName);
+	}
+      follower.ReadAppended ();
+      listSegments = switched || watcher.Wait ();
+    }
+
+  const RecordValidation &validation = follower.Validation ();
+  std::cout << "Followed " << options.mFileNameToSave << ":\n";
+  validation.Report (std::cout);
+  return validation.Clean () ? 0 : 1;
+}
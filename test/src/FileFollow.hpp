@@ -0,0 +1,41 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef FILE_FOLLOW_HPP
+#define FILE_FOLLOW_HPP
+
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* \brief -proto file-check -follow: check a recording while it is being
+   written.  -file names the recording, or a directory or pattern of
+   segments (as for batch-check), of which the last by name is followed;
+   when a later segment appears, the rest of the current one is read and
+   the new one is followed from its start.  Only the bytes appended since
+   the last read are read, when inotify reports a change (or every
+   FOLLOW_POLL_MS without it), and each whole record goes through the
+   processing pipeline.  Index gaps, unreadable bytes, failed checksums
+   and records cut short are reported on cerr as they are found, and
+   summed up once q is pressed.
+   \return 0 if nothing was found wrong, 1 if something was. */
+int RunFileFollow (MagElementTestOptions &options, Pipeline &pipeline);
+
+#endif
@@ -0,0 +1,213 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstring>
+#include "FixedPoint.hpp"
+
+CicDecimator::CicDecimator (uint32_t decimation, uint32_t order)
+  : mOrder (order < 1 ? 1 : (order > FIXED_POINT_MAX_ORDER ? FIXED_POINT_MAX_ORDER : order)),
+    mGain (1)
+{
+  for (uint32_t stage = 0; stage < mOrder; stage++)
+    {
+      mGain *= decimation;
+    }
+  Reset ();
+}
+
+uint32_t CicDecimator::RegisterBits (uint32_t decimation, uint32_t order)
+{
+  /* Bits of the gain, stopping once it is clearly too large. */
+  uint64_t gain = 1;
+  for (uint32_t stage = 0; (stage < order) && (gain <= ((uint64_t)1 << 40)); stage++)
+    {
+      gain *= decimation;
+    }
+  uint32_t bits = 0;
+  while (((uint64_t)1 << bits) < gain)
+    {
+      bits++;
+    }
+  return FIXED_POINT_INPUT_BITS + bits;
+}
+
+void CicDecimator::Reset ()
+{
+  memset (mIntegrators, 0, sizeof (mIntegrators));
+  memset (mCombs, 0, sizeof (mCombs));
+}
+
+/* A stage at a time over the whole block, so that each pass is a simple
+   running sum. */
+void CicDecimator::Integrate (uint64_t *mag1, uint64_t *mag2, uint32_t count)
+{
+  uint64_t *channels[2] = { mag1, mag2 };
+  for (int channel = 0; channel < 2; channel++)
+    {
+      uint64_t *values = channels[channel];
+      for (uint32_t stage = 0; stage < mOrder; stage++)
+	{
+	  uint64_t sum = mIntegrators[channel][stage];
+	  for (uint32_t index = 0; index < count; index++)
+	    {
+	      sum += values[index];
+	      values[index] = sum;
+	    }
+	  mIntegrators[channel][stage] = sum;
+	}
+    }
+}
+
+void CicDecimator::Comb (uint64_t integrated1, uint64_t integrated2, uint64_t sums[2])
+{
+  uint64_t values[2] = { integrated1, integrated2 };
+  for (int channel = 0; channel < 2; channel++)
+    {
+      for (uint32_t stage = 0; stage < mOrder; stage++)
+	{
+	  uint64_t previous = mCombs[channel][stage];
+	  mCombs[channel][stage] = values[channel];
+	  values[channel] -= previous;
+	}
+      sums[channel] = values[channel];
+    }
+}
+
+
+FixedPointProcessor::FixedPointProcessor (uint32_t decimation, uint32_t order)
+  : mDecimation (decimation > 0 ? decimation : 1),
+    mDecimator (mDecimation, order)
+{
+  mSpan = order * (mDecimation - 1) + 1;
+  memset (&mPacket, 0, sizeof (mPacket));
+  mPacket.mRecordType = GM_MAG_ELEMENT_FIXED_POINT_FORMAT;
+  mPacket.mRecordSize = sizeof (FixedPointPacket);
+  mPacket.mDecimation = mDecimation;
+  mPacket.mOrder = (uint8_t)order;
+  mPacket.mGain = mDecimator.Gain ();
+}
+
+void FixedPointProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodeRawBlock (streamerPacket, mDecoded);
+  if (mHaveIndex && (mDecoded.mFirstPacketIndex != mNextIndex))
+    {
+      Restart ();
+    }
+  if (!mHaveIndex)
+    {
+      mPhase = mDecimation - (uint32_t)(mDecoded.mFirstPacketIndex % mDecimation);
+      mHaveIndex = true;
+    }
+  mNextIndex = mDecoded.mFirstPacketIndex + MFAM_STREAMER_CACHE_SIZE;
+
+  /* Hold the last valid value over invalid samples, and note how long
+     each sensor has been valid at each sample. */
+  const uint32_t *values[2] = { mDecoded.mMag1, mDecoded.mMag2 };
+  const uint8_t  *valid[2] = { mDecoded.mMag1Valid, mDecoded.mMag2Valid };
+  for (int channel = 0; channel < 2; channel++)
+    {
+      uint32_t held = mLastValid[channel];
+      uint32_t run = mValidRun[channel];
+      for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+	{
+	  if (valid[channel][index])
+	    {
+	      held = values[channel][index];
+	      run += (run < mSpan) ? 1 : 0;
+	    }
+	  else
+	    {
+	      run = 0;
+	    }
+	  mIntegrated[channel][index] = held;
+	  mRunAt[channel][index] = run;
+	}
+      mLastValid[channel] = held;
+      mValidRun[channel] = run;
+    }
+
+  mDecimator.Integrate (mIntegrated[0], mIntegrated[1], MFAM_STREAMER_CACHE_SIZE);
+  uint32_t sample = mPhase - 1;
+  while (sample < MFAM_STREAMER_CACHE_SIZE)
+    {
+      EndOutputSample (mDecoded.mFirstPacketIndex + sample, sample);
+      sample += mDecimation;
+    }
+  mPhase = sample + 1 - MFAM_STREAMER_CACHE_SIZE;
+}
+
+/* A gap: start again, as if the instrument had just started. */
+void FixedPointProcessor::Restart ()
+{
+  FlushPacket ();
+  mHaveIndex = false;
+  mDecimator.Reset ();
+  mValidRun[0] = 0;
+  mValidRun[1] = 0;
+}
+
+void FixedPointProcessor::EndOutputSample (uint64_t packetIndex, uint32_t sample)
+{
+  uint64_t sums[2];
+  mDecimator.Comb (mIntegrated[0][sample], mIntegrated[1][sample], sums);
+
+  uint32_t slot = mPacket.mSampleCount;
+  if (slot == 0)
+    {
+      mPacket.mFirstPacketIndex = packetIndex + 1 - mDecimation;
+      mPacket.mMag1ValidMask = 0;
+      mPacket.mMag2ValidMask = 0;
+    }
+  /* Each true sum fits in 63 bits, so the wrapped difference is exact. */
+  mPacket.mMag1[slot] = (int64_t)sums[0];
+  mPacket.mMag2[slot] = (int64_t)sums[1];
+  mPacket.mDifference[slot] = (int64_t)(sums[0] - sums[1]);
+  if (mRunAt[0][sample] >= mSpan)
+    {
+      mPacket.mMag1ValidMask |= (uint64_t)1 << slot;
+    }
+  if (mRunAt[1][sample] >= mSpan)
+    {
+      mPacket.mMag2ValidMask |= (uint64_t)1 << slot;
+    }
+  mPacket.mSampleCount = slot + 1;
+  if (mPacket.mSampleCount == MFAM_STREAMER_CACHE_SIZE)
+    {
+      FlushPacket ();
+    }
+}
+
+void FixedPointProcessor::FlushPacket ()
+{
+  if (mPacket.mSampleCount > 0)
+    {
+      Emit (&mPacket, sizeof (mPacket));
+    }
+  mPacket.mSampleCount = 0;
+}
+
+/* A partly accumulated output sample is dropped; it would not be the
+   filter's output. */
+void FixedPointProcessor::Finish ()
+{
+  FlushPacket ();
+}
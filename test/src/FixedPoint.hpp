@@ -0,0 +1,115 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+
+#include <stdint.h>
+#include "DerivedRecords.hpp"
+#include "DecodedColumns.hpp"
+#include "RecordProcessor.hpp"
+
+/* Bits in the raw mag samples, the widest result the CIC may produce (so
+   that it is a positive int64_t), and its most stages. */
+#define FIXED_POINT_INPUT_BITS    32
+#define FIXED_POINT_REGISTER_BITS 63
+#define FIXED_POINT_MAX_ORDER     6
+
+/* Cascaded integrator-comb decimator for mag1 and mag2: order running
+   sums at the raw rate, then order differences at the output rate, which
+   is a moving sum of decimation samples applied order times.  All of it
+   is in unsigned 64-bit arithmetic, which wraps; the integrators overflow,
+   but the output is exact as long as the true result fits, which takes
+   FIXED_POINT_INPUT_BITS + order * log2 (decimation) bits (Hogenauer).
+   There are no coefficients to round and no divisions, so the result is
+   the same on every platform. */
+class CicDecimator
+{
+public:
+  CicDecimator (uint32_t decimation, uint32_t order);
+
+  /* \return  Bits the output needs; at most FIXED_POINT_REGISTER_BITS
+     for it to be exact. */
+  static uint32_t RegisterBits (uint32_t decimation, uint32_t order);
+
+  /* \return  The DC gain, decimation to the power order. */
+  uint64_t Gain () const { return mGain; }
+
+  void Reset ();
+
+  /* \brief Run the integrators over count samples of each channel, in
+     place: each sample is replaced by the last integrator's value once it
+     has been added. */
+  void Integrate (uint64_t *mag1, uint64_t *mag2, uint32_t count);
+
+  /* \brief Run the combs, once every decimation samples, on the last
+     integrator's values at that sample.
+     \param sums  mag1 and mag2, times Gain(). */
+  void Comb (uint64_t integrated1, uint64_t integrated2, uint64_t sums[2]);
+
+private:
+  uint32_t mOrder;
+  uint64_t mGain;
+  uint64_t mIntegrators[2][FIXED_POINT_MAX_ORDER];
+  uint64_t mCombs[2][FIXED_POINT_MAX_ORDER];
+};
+
+/* The fixed-point path for the 1000Hz blocks: mag1, mag2 and their
+   difference, decimated with a CicDecimator and emitted as
+   FixedPointPacket records of the filter's integer sums.  They become nT
+   only in the console output, which divides by the gain.  The difference
+   is taken between the two sums, and is as exact as they are.
+
+   Output samples end at multiples of the decimation in packet index,
+   like the gradiometer's.  An invalid or dead-zone sample is replaced
+   with the sensor's last valid one, and clears the sensor's valid bit in
+   every output whose span includes it; a gap in the index restarts the
+   decimator, and its outputs are invalid until a full span has passed. */
+class FixedPointProcessor : public RecordProcessor
+{
+public:
+  FixedPointProcessor (uint32_t decimation, uint32_t order);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void Finish () override;
+
+private:
+  void Restart ();
+  void EndOutputSample (uint64_t packetIndex, uint32_t sample);
+  void FlushPacket ();
+
+  uint32_t         mDecimation;
+  uint32_t         mSpan;              /* Raw samples in each output */
+  CicDecimator     mDecimator;
+  DecodedRawBlock  mDecoded;
+  uint64_t         mIntegrated[2][MFAM_STREAMER_CACHE_SIZE];
+
+  bool             mHaveIndex = false;
+  uint64_t         mNextIndex = 0;
+  uint32_t         mPhase = 0;         /* Raw samples to the next output */
+  uint32_t         mLastValid[2] = {};
+  uint32_t         mValidRun[2] = {};  /* Valid samples in a row, up to mSpan */
+  uint32_t         mRunAt[2][MFAM_STREAMER_CACHE_SIZE];
+
+  FixedPointPacket mPacket;
+};
+
+#endif
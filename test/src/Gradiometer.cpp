@@ -0,0 +1,134 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstring>
+#include "SimdKernels.hpp"
+#include "Gradiometer.hpp"
+
+GradiometerProcessor::GradiometerProcessor (uint32_t decimation)
+  : mDecimation (decimation > 0 ? decimation : 1)
+{
+  memset (&mPacket, 0, sizeof (mPacket));
+  mPacket.mRecordType = GM_MAG_ELEMENT_GRADIOMETER_FORMAT;
+  mPacket.mRecordSize = sizeof (GradiometerPacket);
+  mPacket.mDecimation = mDecimation;
+}
+
+void GradiometerProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodeRawBlock (streamerPacket, mDecoded);
+
+  /* Output samples never span a gap in the input. */
+  if (mHaveIndex && (mDecoded.mFirstPacketIndex != mNextIndex))
+    {
+      if (mAccumulating)
+	{
+	  EndOutputSample ();
+	}
+      FlushPacket ();
+    }
+  mHaveIndex = true;
+  mNextIndex = mDecoded.mFirstPacketIndex + MFAM_STREAMER_CACHE_SIZE;
+
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      mMask[index] = (mDecoded.mMag1Valid[index] && mDecoded.mMag2Valid[index]) ? 0xFFFFFFFFu : 0;
+    }
+  MaskedDifferenceAndSum (mDecoded.mMag1, mDecoded.mMag2, mMask,
+			  mDifference, mSum, MFAM_STREAMER_CACHE_SIZE);
+
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      uint64_t packetIndex = mDecoded.mFirstPacketIndex + index;
+      if (mAccumulating && (packetIndex - mOutputIndex >= mDecimation))
+	{
+	  EndOutputSample ();
+	}
+      if (!mAccumulating)
+	{
+	  StartOutputSample (packetIndex - (packetIndex % mDecimation));
+	}
+      /* Masked samples contribute zero to the totals. */
+      mDifferenceTotal += mDifference[index];
+      mSumTotal += mSum[index];
+      mValidCount += mMask[index] & 1;
+    }
+
+  /* Without decimation every block completes its outputs. */
+  if (mDecimation == 1)
+    {
+      EndOutputSample ();
+    }
+}
+
+void GradiometerProcessor::StartOutputSample (uint64_t packetIndex)
+{
+  if (mPacket.mSampleCount == 0)
+    {
+      mPacket.mFirstPacketIndex = packetIndex;
+      mPacket.mValidMask = 0;
+    }
+  mAccumulating = true;
+  mOutputIndex = packetIndex;
+  mDifferenceTotal = 0;
+  mSumTotal = 0;
+  mValidCount = 0;
+}
+
+void GradiometerProcessor::EndOutputSample ()
+{
+  uint32_t slot = mPacket.mSampleCount++;
+  if (mValidCount > 0)
+    {
+      mPacket.mDifference[slot] = MAG_DATA_AS_FLOAT ((double)mDifferenceTotal / mValidCount);
+      mPacket.mSum[slot] = MAG_DATA_AS_FLOAT ((double)mSumTotal / mValidCount);
+      mPacket.mValidMask |= (uint64_t)1 << slot;
+    }
+  else
+    {
+      mPacket.mDifference[slot] = 0.0;
+      mPacket.mSum[slot] = 0.0;
+    }
+  mAccumulating = false;
+  if (mPacket.mSampleCount == MFAM_STREAMER_CACHE_SIZE)
+    {
+      FlushPacket ();
+    }
+}
+
+void GradiometerProcessor::FlushPacket ()
+{
+  if (mPacket.mSampleCount > 0)
+    {
+      Emit (&mPacket, sizeof (mPacket));
+    }
+  mPacket.mSampleCount = 0;
+  mPacket.mValidMask = 0;
+}
+
+void GradiometerProcessor::Finish ()
+{
+  if (mAccumulating)
+    {
+      EndOutputSample ();
+    }
+  FlushPacket ();
+}
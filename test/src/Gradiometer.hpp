@@ -0,0 +1,70 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef GRADIOMETER_HPP
+#define GRADIOMETER_HPP
+
+#include <stdint.h>
+#include "DerivedRecords.hpp"
+#include "DecodedColumns.hpp"
+#include "RecordProcessor.hpp"
+
+/* Derives the gradiometer channel, mag1 - mag2, and the sum mag1 + mag2
+   from each 1000Hz block.  Differences and sums are formed in integer LSBs,
+   a whole block at a time with the SIMD kernels, and scaled to nT only when
+   the output record is filled.  Samples with either sensor invalid or in the
+   dead zone are left out.  With a decimation factor above 1, each output is
+   the mean of the valid samples in decimation raw samples; output samples
+   are aligned to multiples of the decimation in packet index.  Results are
+   emitted as GradiometerPacket records. */
+class GradiometerProcessor : public RecordProcessor
+{
+public:
+  explicit GradiometerProcessor (uint32_t decimation);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void Finish () override;
+
+private:
+  void StartOutputSample (uint64_t packetIndex);
+  void EndOutputSample ();
+  void FlushPacket ();
+
+  uint32_t          mDecimation;
+  DecodedRawBlock   mDecoded;
+  uint32_t          mMask[MFAM_STREAMER_CACHE_SIZE];
+  int64_t           mDifference[MFAM_STREAMER_CACHE_SIZE];
+  int64_t           mSum[MFAM_STREAMER_CACHE_SIZE];
+
+  bool              mHaveIndex = false;
+  uint64_t          mNextIndex = 0;
+
+  /* Output sample being accumulated */
+  bool              mAccumulating = false;
+  uint64_t          mOutputIndex = 0;
+  int64_t           mDifferenceTotal = 0;
+  int64_t           mSumTotal = 0;
+  uint32_t          mValidCount = 0;
+
+  GradiometerPacket mPacket;
+};
+
+#endif
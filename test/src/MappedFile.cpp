@@ -0,0 +1,171 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <iostream>
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile ()
+{
+  Close ();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open (const std::string &fileName)
+{
+  Close ();
+  HANDLE file = CreateFileA (fileName.c_str (), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+			     nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    {
+      std::cerr << "Error: Can't open " << fileName << "\n";
+      return false;
+    }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx (file, &size))
+    {
+      std::cerr << "Error: Can't get the size of " << fileName << "\n";
+      CloseHandle (file);
+      return false;
+    }
+  mFileHandle = file;
+  mSize = (uint64_t)size.QuadPart;
+  mIsOpen = true;
+  if (mSize == 0)
+    {
+      return true;
+    }
+
+  HANDLE mapping = CreateFileMappingA (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+    {
+      std::cerr << "Error: Can't map " << fileName << "\n";
+      Close ();
+      return false;
+    }
+  mMappingHandle = mapping;
+  mData = (const uint8_t *)MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mData == nullptr)
+    {
+      std::cerr << "Error: Can't map " << fileName << "\n";
+      Close ();
+      return false;
+    }
+  return true;
+}
+
+void MappedFile::Close ()
+{
+  if (mData != nullptr)
+    {
+      UnmapViewOfFile (mData);
+    }
+  if (mMappingHandle != nullptr)
+    {
+      CloseHandle ((HANDLE)mMappingHandle);
+    }
+  if (mFileHandle != nullptr)
+    {
+      CloseHandle ((HANDLE)mFileHandle);
+    }
+  mData = nullptr;
+  mMappingHandle = nullptr;
+  mFileHandle = nullptr;
+  mSize = 0;
+  mIsOpen = false;
+}
+
+void MappedFile::AdviseSequential ()
+{
+  /* FILE_FLAG_SEQUENTIAL_SCAN was given when the file was opened. */
+}
+
+#else
+
+bool MappedFile::Open (const std::string &fileName)
+{
+  Close ();
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      std::cerr << "Error: Can't open " << fileName << "\n";
+      return false;
+    }
+  struct stat status;
+  if (fstat (fd, &status) != 0)
+    {
+      std::cerr << "Error: Can't get the size of " << fileName << "\n";
+      close (fd);
+      return false;
+    }
+  mFileDescriptor = fd;
+  mSize = (uint64_t)status.st_size;
+  mIsOpen = true;
+  if (mSize == 0)
+    {
+      return true;
+    }
+
+  void *mapping = mmap (nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED)
+    {
+      std::cerr << "Error: Can't map " << fileName << "\n";
+      Close ();
+      return false;
+    }
+  mData = (const uint8_t *)mapping;
+  return true;
+}
+
+void MappedFile::Close ()
+{
+  if (mData != nullptr)
+    {
+      munmap ((void *)mData, mSize);
+    }
+  if (mFileDescriptor >= 0)
+    {
+      close (mFileDescriptor);
+    }
+  mData = nullptr;
+  mFileDescriptor = -1;
+  mSize = 0;
+  mIsOpen = false;
+}
+
+void MappedFile::AdviseSequential ()
+{
+  if (mData != nullptr)
+    {
+      madvise ((void *)mData, mSize, MADV_SEQUENTIAL);
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <stdint.h>
+#include <string>
+
+/* Read-only memory mapping of a recording.  The whole file is mapped
+   at once; the operating system pages it in as it is touched, so even
+   very large recordings can be walked without copying them into
+   program buffers. */
+class MappedFile
+{
+public:
+  MappedFile () = default;
+  ~MappedFile ();
+
+  MappedFile (const MappedFile &) = delete;
+  MappedFile &operator= (const MappedFile &) = delete;
+
+  /* Map the named file.  Returns false, with a message on cerr, if the
+     file can't be opened or mapped.  An empty file maps successfully,
+     with Data() == nullptr and Size() == 0. */
+  bool Open (const std::string &fileName);
+  void Close ();
+
+  /* Hint to the kernel that the mapping will be read front to back. */
+  void AdviseSequential ();
+
+  const uint8_t *Data () const { return mData; }
+  uint64_t       Size () const { return mSize; }
+  bool           IsOpen () const { return mIsOpen; }
+
+private:
+  const uint8_t *mData = nullptr;
+  uint64_t       mSize = 0;
+  bool           mIsOpen = false;
+#ifdef _WIN32
+  void          *mFileHandle = nullptr;
+  void          *mMappingHandle = nullptr;
+#else
+  int            mFileDescriptor = -1;
+#endif
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "BatchCheck.hpp"
+#include "DerivedRecords.hpp"
+#include "MappedFile.hpp"
+#include "RecordUtilities.hpp"
+#include "StreamMerge.hpp"
+#include "TestClient.hpp"
+#include "Merge.hpp"
+
+/* One instrument's recording, from one -file entry, read front to back.
+   A directory or pattern names the segments of that recording, which are
+   read one after another in name order. */
+struct MergeInput
+{
+  std::string                              mName;
+  std::vector<std::unique_ptr<MappedFile>> mFiles;
+  size_t                                   mFile = 0;      /* The segment being read */
+  uint64_t                                 mOffset = 0;    /* ... and the position in it */
+  uint64_t                                 mSkippedBytes = 0;
+};
+
+/* \brief Find the next whole record of an input.
+   \return  false at the end of its last segment. */
+static bool NextRecord (MergeInput &input, const uint8_t *&record, uint32_t &length)
+{
+  for (; input.mFile < input.mFiles.size (); input.mFile++, input.mOffset = 0)
+    {
+      const uint8_t *data = input.mFiles[input.mFile]->Data ();
+      uint64_t size = input.mFiles[input.mFile]->Size ();
+      while (input.mOffset + sizeof (RecordHeader) <= size)
+	{
+	  RecordHeader header;
+	  memcpy (&header, data + input.mOffset, sizeof (header));
+	  if (IsValidRecordHeader (data + input.mOffset) && (input.mOffset + header.mRecordSize <= size))
+	    {
+	      record = data + input.mOffset;
+	      length = header.mRecordSize;
+	      input.mOffset += header.mRecordSize;
+	      return true;
+	    }
+	  uint64_t next = FindNextRecord (data, size, input.mOffset + 1);
+	  input.mSkippedBytes += next - input.mOffset;
+	  input.mOffset = next;
+	}
+      input.mSkippedBytes += size - input.mOffset;
+    }
+  return false;
+}
+
+int RunMerge (MagElementTestOptions &options, Pipeline &pipeline)
+{
+  std::vector<std::unique_ptr<MergeInput>> inputs;
+  std::stringstream list (options.mFileNameToSave);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      std::vector<std::string> fileNames = ListFiles (item);
+      if (fileNames.empty ())
+	{
+	  std::cerr << "\n\nError: No files match " << item << "\n\n";
+	  return 1;
+	}
+      auto input = std::make_unique<MergeInput> ();
+      input->mName = item;
+      for (const std::string &fileName : fileNames)
+	{
+	  auto file = std::make_unique<MappedFile> ();
+	  if (!file->Open (fileName))
+	    {
+	      return 1;
+	    }
+	  file->AdviseSequential ();
+	  input->mFiles.push_back (std::move (file));
+	}
+      inputs.push_back (std::move (input));
+    }
+
+  auto startTime = std::chrono::steady_clock::now ();
+  uint64_t sources = 0;
+  bool     haveLast = false;
+  uint32_t lastInput = 0;
+  StreamMerger *mergerPointer = nullptr;
+  StreamMerger::MergeOutput output = [&] (uint32_t input, int64_t time, const RecordRef &record)
+    {
+      if (!haveLast || (input != lastInput))
+	{
+	  MergeSourcePacket packet;
+	  memset (&packet, 0, sizeof (packet));
+	  packet.mRecordType = GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT;
+	  packet.mRecordSize = sizeof (packet);
+	  packet.mFirstPacketIndex = GetRecordIndex (record.Data ());
+	  packet.mInput = input;
+	  packet.mTimeNanoseconds = time;
+	  memcpy (packet.mSerialNumber, mergerPointer->SerialNumber (input), sizeof (packet.mSerialNumber));
+	  pipeline.Submit (pipeline.Pool ().Copy (&packet, sizeof (packet)));
+	  haveLast = true;
+	  lastInput = input;
+	  sources++;
+	}
+      pipeline.Submit (record);
+    };
+  StreamMerger merger ((uint32_t)inputs.size (), options.mMergeBufferRecords, output);
+  mergerPointer = &merger;
+
+  /* Read from whichever input the merge is waiting on; the others are
+     read only as far as their next record. */
+  uint32_t next;
+  while (merger.NextStarved (next))
+    {
+      if (ShutdownRequested ())
+	{
+	  break;
+	}
+      const uint8_t *record;
+      uint32_t length;
+      if (NextRecord (*inputs[next], record, length))
+	{
+	  merger.Add (next, pipeline.Pool ().Copy (record, length));
+	}
+      else
+	{
+	  merger.Finish (next);
+	}
+    }
+
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+  std::vector<std::string> names;
+  uint64_t skippedBytes = 0;
+  for (const auto &input : inputs)
+    {
+      names.push_back (input->mName);
+      skippedBytes += input->mSkippedBytes;
+    }
+  merger.Report (std::cerr, names);
+  if (skippedBytes > 0)
+    {
+      std::cerr << "  " << skippedBytes << " unreadable bytes skipped\n";
+    }
+  std::cerr << "  " << sources << " merge source records, " << seconds << " s\n";
+  return 0;
+}
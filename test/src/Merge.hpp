@@ -0,0 +1,39 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef MERGE_HPP
+#define MERGE_HPP
+
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* \brief -proto merge: merge the recordings of several instruments,
+   named by -file (a comma-separated list of files, directories or
+   patterns, in input order; the files matched by one entry are the
+   segments of one instrument's recording), into one stream in time order on the
+   instruments' common PPS time base, and pass it through the processing
+   pipeline.  A merge source record goes before each run of records from
+   one input.  With -out, the stream is also written to that file as a
+   recording.
+   \return 0 on success, 1 if a recording can't be read. */
+int RunMerge (MagElementTestOptions &options, Pipeline &pipeline);
+
+#endif
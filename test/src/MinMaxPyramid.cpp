@@ -0,0 +1,295 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include "SimdKernels.hpp"
+#include "MinMaxPyramid.hpp"
+
+/* Samples read from the recording at a time while building; a multiple
+   of the level 0 bucket width. */
+#define PYRAMID_CHUNK_SAMPLES 65536
+
+static const char sPyramidMagic[8] = { 'M', 'E', 'P', 'Y', 'R', 'A', 'M', 'D' };
+static const PyramidBucket sEmptyBucket = { 0xFFFFFFFF, 0, 0, 0 };
+
+/* Buckets in a level whose buckets are 2^shift indices wide; at least one,
+   so that even an empty recording has a top level. */
+static uint64_t LevelBucketCount (uint64_t span, uint32_t shift)
+{
+  uint64_t count = (shift < 64) ? ((span >> shift) + ((span & ((1ull << shift) - 1)) ? 1 : 0)) : 0;
+  return (count > 0) ? count : 1;
+}
+
+/* Summarise the selected samples in one bucket. */
+static void SummariseSamples (const uint32_t *values, const uint8_t *flags, uint8_t flag,
+			      size_t count, PyramidBucket &bucket)
+{
+  uint32_t minimum, maximum;
+  uint64_t sum;
+  bucket.mCount = MaskedMinMaxSum (values, flags, flag, count, minimum, maximum, sum);
+  bucket.mMinimum = minimum;
+  bucket.mMaximum = maximum;
+  bucket.mSum = sum;
+}
+
+bool BuildPyramid (const RecordingReader &reader, uint64_t recordingSize, const std::string &fileName)
+{
+  uint64_t first = reader.FirstIndex ();
+  uint64_t span = reader.EndIndex () - first;
+  if (span > PYRAMID_MAXIMUM_SPAN)
+    {
+      std::cerr << "\n\nError: The recording covers " << span
+		<< " packet indices, more than a pyramid can hold\n\n";
+      return false;
+    }
+
+  /* levels[level * PYRAMID_CHANNELS + channel] */
+  std::vector<std::vector<PyramidBucket>> levels;
+  uint32_t shift = PYRAMID_BASE_SHIFT;
+  for (;;)
+    {
+      uint64_t count = LevelBucketCount (span, shift);
+      for (int channel = 0; channel < PYRAMID_CHANNELS; channel++)
+	{
+	  levels.emplace_back (count, sEmptyBucket);
+	}
+      if (count == 1)
+	{
+	  break;
+	}
+      shift++;
+    }
+  uint32_t levelCount = (uint32_t)(levels.size () / PYRAMID_CHANNELS);
+
+  /* Level 0, straight from the samples. */
+  const uint64_t bucketWidth = 1ull << PYRAMID_BASE_SHIFT;
+  std::vector<uint32_t> mag[PYRAMID_CHANNELS];
+  for (int channel = 0; channel < PYRAMID_CHANNELS; channel++)
+    {
+      mag[channel].resize (PYRAMID_CHUNK_SAMPLES);
+    }
+  std::vector<uint8_t> valid (PYRAMID_CHUNK_SAMPLES);
+  for (uint64_t chunk = 0; chunk < span; chunk += PYRAMID_CHUNK_SAMPLES)
+    {
+      uint64_t count = std::min<uint64_t> (PYRAMID_CHUNK_SAMPLES, span - chunk);
+      if (reader.ReadMag (first + chunk, count, mag[0].data (), mag[1].data (), valid.data ()) == 0)
+	{
+	  continue;
+	}
+      for (uint64_t offset = 0; offset < count; offset += bucketWidth)
+	{
+	  size_t samples = (size_t)std::min (bucketWidth, count - offset);
+	  uint64_t bucket = (chunk + offset) >> PYRAMID_BASE_SHIFT;
+	  for (int channel = 0; channel < PYRAMID_CHANNELS; channel++)
+	    {
+	      SummariseSamples (mag[channel].data () + offset, valid.data () + offset,
+				(uint8_t)(1 << channel), samples, levels[channel][bucket]);
+	    }
+	}
+    }
+
+  /* Each higher level from the one below. */
+  for (uint32_t level = 1; level < levelCount; level++)
+    {
+      for (int channel = 0; channel < PYRAMID_CHANNELS; channel++)
+	{
+	  const std::vector<PyramidBucket> &below = levels[(level - 1) * PYRAMID_CHANNELS + channel];
+	  std::vector<PyramidBucket> &above = levels[level * PYRAMID_CHANNELS + channel];
+	  for (size_t bucket = 0; bucket < above.size (); bucket++)
+	    {
+	      above[bucket] = below[2 * bucket];
+	      if (2 * bucket + 1 < below.size ())
+		{
+		  MergeBucket (above[bucket], below[2 * bucket + 1]);
+		}
+	    }
+	}
+    }
+
+  PyramidFileHeader header = {};
+  memcpy (header.mMagic, sPyramidMagic, sizeof (header.mMagic));
+  header.mVersion = PYRAMID_VERSION;
+  header.mBaseShift = PYRAMID_BASE_SHIFT;
+  header.mFirstIndex = first;
+  header.mEndIndex = first + span;
+  header.mRecordingSize = recordingSize;
+  header.mLevelCount = levelCount;
+  header.mChannelCount = PYRAMID_CHANNELS;
+
+  FILE *output = fopen (fileName.c_str (), "wb");
+  if (output == nullptr)
+    {
+      std::cerr << "\n\nError: Pyramid file " << fileName << " can't be opened\n\n";
+      return false;
+    }
+  bool writeFailed = (fwrite (&header, sizeof (header), 1, output) != 1);
+  for (const std::vector<PyramidBucket> &buckets : levels)
+    {
+      if (!writeFailed && (fwrite (buckets.data (), sizeof (PyramidBucket), buckets.size (), output) != buckets.size ()))
+	{
+	  writeFailed = true;
+	}
+    }
+  if (fclose (output) != 0)
+    {
+      writeFailed = true;
+    }
+  if (writeFailed)
+    {
+      std::cerr << "\n\nError: Pyramid file " << fileName << " not written\n\n";
+      remove (fileName.c_str ());
+      return false;
+    }
+  return true;
+}
+
+
+bool MinMaxPyramid::Open (const std::string &fileName)
+{
+  Close ();
+  if (!mFile.Open (fileName))
+    {
+      return false;
+    }
+
+  bool complete = false;
+  if (mFile.Size () >= sizeof (mHeader))
+    {
+      memcpy (&mHeader, mFile.Data (), sizeof (mHeader));
+      complete = (memcmp (mHeader.mMagic, sPyramidMagic, sizeof (sPyramidMagic)) == 0) &&
+	(mHeader.mVersion == PYRAMID_VERSION) && (mHeader.mChannelCount == PYRAMID_CHANNELS) &&
+	(mHeader.mBaseShift < 32) && (mHeader.mEndIndex >= mHeader.mFirstIndex) &&
+	(mHeader.mEndIndex - mHeader.mFirstIndex <= PYRAMID_MAXIMUM_SPAN) &&
+	(mHeader.mLevelCount > 0) && (mHeader.mLevelCount <= 64 - mHeader.mBaseShift);
+    }
+  if (complete)
+    {
+      /* The levels must be exactly those BuildPyramid writes. */
+      const PyramidBucket *next = (const PyramidBucket *)(mFile.Data () + sizeof (mHeader));
+      uint64_t bytes = sizeof (mHeader);
+      for (uint32_t level = 0; level < mHeader.mLevelCount; level++)
+	{
+	  uint64_t count = BucketCount (level);
+	  if ((count == 1) != (level + 1 == mHeader.mLevelCount))
+	    {
+	      complete = false;
+	      break;
+	    }
+	  for (int channel = 0; channel < PYRAMID_CHANNELS; channel++)
+	    {
+	      mLevels.push_back (next);
+	      next += count;
+	      bytes += count * sizeof (PyramidBucket);
+	    }
+	}
+      complete = complete && (bytes == mFile.Size ());
+    }
+  if (!complete)
+    {
+      std::cerr << "\n\nError: " << fileName << " is not a complete pyramid file\n\n";
+      Close ();
+      return false;
+    }
+  return true;
+}
+
+void MinMaxPyramid::Close ()
+{
+  mFile.Close ();
+  mHeader = {};
+  mLevels.clear ();
+}
+
+uint64_t MinMaxPyramid::BucketCount (uint32_t level) const
+{
+  return LevelBucketCount (mHeader.mEndIndex - mHeader.mFirstIndex, mHeader.mBaseShift + level);
+}
+
+uint64_t MinMaxPyramid::ColumnStart (uint64_t first, uint64_t end, uint32_t pixels, uint32_t pixel)
+{
+  /* first + span * pixel / pixels, without overflowing. */
+  uint64_t span = end - first;
+  return first + (span / pixels) * pixel + (span % pixels) * pixel / pixels;
+}
+
+void MinMaxPyramid::Query (uint32_t channel, uint64_t first, uint64_t end, uint32_t pixels,
+			   std::vector<PyramidBucket> &columns, const RecordingReader *reader) const
+{
+  columns.assign (pixels, sEmptyBucket);
+  if (!IsOpen () || (pixels == 0) || (end <= first) || (channel >= PYRAMID_CHANNELS))
+    {
+      return;
+    }
+  uint64_t low = std::max (first, mHeader.mFirstIndex);
+  uint64_t high = std::min (end, mHeader.mEndIndex);
+  if (low >= high)
+    {
+      return;
+    }
+  uint64_t narrowest = (end - first) / pixels;
+
+  if ((narrowest < (1ull << mHeader.mBaseShift)) && (reader != nullptr))
+    {
+      /* Fewer samples than pixels times a level 0 bucket: use them all. */
+      std::vector<uint32_t> values (high - low);
+      std::vector<uint8_t>  flags (high - low);
+      reader->ReadMag (low, high - low, (channel == 0) ? values.data () : nullptr,
+		       (channel == 1) ? values.data () : nullptr, flags.data ());
+      for (uint32_t pixel = 0; pixel < pixels; pixel++)
+	{
+	  uint64_t start = std::max (ColumnStart (first, end, pixels, pixel), low);
+	  uint64_t stop = std::min (ColumnStart (first, end, pixels, pixel + 1), high);
+	  if (start < stop)
+	    {
+	      SummariseSamples (values.data () + (start - low), flags.data () + (start - low),
+				(uint8_t)(1 << channel), (size_t)(stop - start), columns[pixel]);
+	    }
+	}
+      return;
+    }
+
+  uint32_t level = 0;
+  while ((level + 1 < mHeader.mLevelCount) &&
+	 ((1ull << (mHeader.mBaseShift + level + 1)) <= narrowest))
+    {
+      level++;
+    }
+  uint32_t shift = mHeader.mBaseShift + level;
+  const PyramidBucket *buckets = mLevels[level * PYRAMID_CHANNELS + channel];
+  uint64_t lastBucket = BucketCount (level) - 1;
+  for (uint32_t pixel = 0; pixel < pixels; pixel++)
+    {
+      uint64_t start = std::max (ColumnStart (first, end, pixels, pixel), low);
+      uint64_t stop = std::min (ColumnStart (first, end, pixels, pixel + 1), high);
+      if (start >= stop)
+	{
+	  continue;
+	}
+      uint64_t bucketEnd = std::min ((stop - 1 - mHeader.mFirstIndex) >> shift, lastBucket);
+      for (uint64_t bucket = (start - mHeader.mFirstIndex) >> shift; bucket <= bucketEnd; bucket++)
+	{
+	  MergeBucket (columns[pixel], buckets[bucket]);
+	}
+    }
+}
@@ -0,0 +1,135 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef MIN_MAX_PYRAMID_HPP
+#define MIN_MAX_PYRAMID_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "gmplatform.h"
+#include "MappedFile.hpp"
+#include "RecordingReader.hpp"
+
+/* Min/max/mean pyramid of mag1 and mag2, kept beside a recording in a
+   sidecar file ("savefile.bin.pyr"), so that a plot of any stretch of the
+   recording, from the whole of it down to single samples, can be drawn
+   from a few buckets per pixel instead of every sample.
+
+   Level 0 buckets each summarise 2^PYRAMID_BASE_SHIFT consecutive packet
+   indices, counted from the first index in the recording; each bucket of
+   level L + 1 merges two of level L, up to a level with a single bucket.
+   Only valid samples outside the dead zone are counted; a bucket with no
+   such samples has mCount 0.  Values are in LSBs. */
+
+#define PYRAMID_BASE_SHIFT 6
+#define PYRAMID_CHANNELS   2          /* mag1, mag2 */
+#define PYRAMID_VERSION    1
+
+/* Longest recording, in packet indices, that a pyramid can cover; this
+   keeps the sums and counts of the top bucket from overflowing. */
+#define PYRAMID_MAXIMUM_SPAN 0xFFFFFFFFull
+
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_PyramidBucket
+{
+  uint32_t mMinimum;       /* 0xFFFFFFFF if mCount is 0 */
+  uint32_t mMaximum;
+  uint64_t mSum;
+  uint32_t mCount;         /* Samples summarised */
+} PyramidBucket;
+
+static_assert ((sizeof(PyramidBucket) == 20), "Not expected size");
+
+/* Sidecar layout: this header, then for each level from 0 up, for each
+   channel, that level's buckets.  Level L has
+   ceil((mEndIndex - mFirstIndex) / 2^(mBaseShift + L)) buckets.  All
+   fields are little-endian. */
+PACKED_PRAGMA
+typedef struct PACKED_SPEC s_PyramidFileHeader
+{
+  char     mMagic[8];      /* "MEPYRAMD" */
+  uint32_t mVersion;       /* PYRAMID_VERSION */
+  uint32_t mBaseShift;     /* Level 0 buckets hold 2^mBaseShift indices */
+  uint64_t mFirstIndex;    /* Packet index at the start of bucket 0 */
+  uint64_t mEndIndex;      /* One past the last packet index covered */
+  uint64_t mRecordingSize; /* Size in bytes of the recording summarised */
+  uint32_t mLevelCount;
+  uint32_t mChannelCount;  /* PYRAMID_CHANNELS */
+} PyramidFileHeader ALIGN_1_SPEC;
+
+static_assert ((sizeof(PyramidFileHeader) == 48), "Not expected size");
+
+/* \brief Merge bucket from into bucket into. */
+inline void MergeBucket (PyramidBucket &into, const PyramidBucket &from)
+{
+  into.mMinimum = (from.mMinimum < into.mMinimum) ? from.mMinimum : into.mMinimum;
+  into.mMaximum = (from.mMaximum > into.mMaximum) ? from.mMaximum : into.mMaximum;
+  into.mSum += from.mSum;
+  into.mCount += from.mCount;
+}
+
+/* \brief Build the pyramid for an open recording in one pass over its
+   samples, and write it to fileName, replacing any file of that name.
+   recordingSize is stored so that a stale sidecar can be recognised.
+   \return false, with a message on cerr, on failure. */
+bool BuildPyramid (const RecordingReader &reader, uint64_t recordingSize, const std::string &fileName);
+
+/* A sidecar file, mapped read-only. */
+class MinMaxPyramid
+{
+public:
+  /* Map and check a sidecar.  Returns false, with a message on cerr, if
+     it can't be read or isn't a complete pyramid. */
+  bool Open (const std::string &fileName);
+  void Close ();
+  bool IsOpen () const { return mFile.IsOpen (); }
+
+  uint64_t FirstIndex () const { return mHeader.mFirstIndex; }
+  uint64_t EndIndex () const { return mHeader.mEndIndex; }
+  uint64_t RecordingSize () const { return mHeader.mRecordingSize; }
+  uint32_t LevelCount () const { return mHeader.mLevelCount; }
+
+  /* \brief Summarise channel (0 = mag1, 1 = mag2) over packet indices
+     [first, end), divided evenly into pixels columns, replacing the
+     contents of columns.  Each column is built from the coarsest level
+     whose buckets are no wider than the column, which takes at most three
+     buckets per column, so the cost is O(pixels) whatever the range; the
+     buckets at each edge of a column may reach a little beyond it.  When
+     columns are narrower than a level 0 bucket and reader is given (the
+     recording the sidecar was built from), they are computed from the
+     samples themselves, exactly. */
+  void Query (uint32_t channel, uint64_t first, uint64_t end, uint32_t pixels,
+	      std::vector<PyramidBucket> &columns, const RecordingReader *reader = nullptr) const;
+
+  /* \brief First packet index of column pixel of a Query(). */
+  static uint64_t ColumnStart (uint64_t first, uint64_t end, uint32_t pixels, uint32_t pixel);
+
+private:
+  uint64_t BucketCount (uint32_t level) const;
+
+  MappedFile                          mFile;
+  PyramidFileHeader                   mHeader = {};
+  /* Start of each level's buckets for each channel, in the mapping */
+  std::vector<const PyramidBucket *>  mLevels;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "CaptureFile.hpp"
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "TestClient.hpp"
+#include "Pcap.hpp"
+
+int RunPcap (MagElementTestOptions &options, Pipeline &pipeline)
+{
+  CaptureFile capture;
+  if (!capture.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+  auto startTime = std::chrono::steady_clock::now ();
+  uint16_t port = options.mRemotePortIsValid ? (uint16_t)atoi (options.mRemotePort.data ()) : 0;
+
+  uint64_t packets = 0, otherTraffic = 0, unknownLink = 0, notIp = 0;
+  uint64_t fragments = 0, truncated = 0, datagrams = 0, datagramSkipped = 0;
+  uint64_t partialBytes = 0, records = 0, recordBytes = 0;
+  uint64_t blocks = 0, decimated = 0, heartbeats = 0, others = 0;
+
+  RecordCallback submit = [&] (const uint8_t *data, uint32_t length)
+    {
+      RecordRef record = pipeline.Pool ().Allocate (length);
+      memcpy (record.Buffer (), data, length);
+      pipeline.Submit (record);
+      records++;
+      recordBytes += length;
+      switch (((const RecordHeader *)data)->mRecordType)
+	{
+	case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+	  blocks++;
+	  break;
+	case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+	  decimated++;
+	  break;
+	case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+	  heartbeats++;
+	  break;
+	default:
+	  others++;
+	  break;
+	}
+    };
+
+  /* One splitter per direction of each TCP connection */
+  TcpReassembler tcp;
+  std::vector<RecordStreamSplitter> streams;
+  TcpReassembler::StreamOutput streamOutput =
+    [&] (uint32_t stream, const uint8_t *data, size_t length, bool afterGap)
+    {
+      if (stream >= streams.size ())
+	{
+	  streams.resize (stream + 1);
+	}
+      if (afterGap)
+	{
+	  streams[stream].Reset ();
+	}
+      streams[stream].Add (data, length, submit);
+    };
+
+  CapturedPacket packet;
+  TransportSegment segment;
+  while (capture.Next (packet))
+    {
+      if (ShutdownRequested ())
+	{
+	  break;
+	}
+      packets++;
+      switch (DecodeTransport (packet, segment))
+	{
+	case DecodeResult::Decoded:
+	  break;
+	case DecodeResult::UnknownLinkType:
+	  unknownLink++;
+	  continue;
+	case DecodeResult::Fragment:
+	  fragments++;
+	  continue;
+	case DecodeResult::Truncated:
+	  truncated++;
+	  continue;
+	case DecodeResult::NotIp:
+	  notIp++;
+	  continue;
+	default:
+	  otherTraffic++;
+	  continue;
+	}
+      if ((port != 0) && (segment.mFlow.mSourcePort != port) && (segment.mFlow.mDestinationPort != port))
+	{
+	  otherTraffic++;
+	  continue;
+	}
+
+      if (segment.mProtocol == CAPTURE_PROTOCOL_UDP)
+	{
+	  /* The instrument sends a whole number of records in each datagram. */
+	  datagrams++;
+	  size_t used = SplitRecords (segment.mPayload, segment.mLength, submit, datagramSkipped);
+	  partialBytes += segment.mLength - used;
+	}
+      else
+	{
+	  tcp.Add (segment, streamOutput);
+	}
+    }
+  tcp.Flush (streamOutput);
+
+  uint64_t streamSkipped = 0;
+  for (RecordStreamSplitter &stream : streams)
+    {
+      stream.Reset ();
+      streamSkipped += stream.SkippedBytes ();
+    }
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+
+  std::cerr << options.mFileNameToSave << " (" << (capture.IsPcapNg () ? "pcapng" : "pcap") << "): "
+	    << packets << " packets, " << records << " records (" << blocks << " 1000Hz blocks, "
+	    << decimated << " decimated, " << heartbeats << " heartbeats, " << others << " other), "
+	    << recordBytes << " bytes in " << seconds << " s";
+  if (seconds > 0.0)
+    {
+      std::cerr << ", " << recordBytes / seconds / 1.0e6 << " MB/s";
+    }
+  std::cerr << "\n";
+  std::cerr << "UDP: " << datagrams << " datagrams, " << datagramSkipped << " bytes outside records, "
+	    << partialBytes << " bytes in partial records\n";
+  std::cerr << "TCP: " << tcp.StreamCount () << " streams, " << tcp.Segments () << " segments, "
+	    << tcp.OutOfOrderSegments () << " out of order, " << tcp.RetransmittedBytes ()
+	    << " bytes retransmitted, " << tcp.MissingBytes () << " bytes missing, "
+	    << streamSkipped << " bytes outside records\n";
+  std::cerr << "Not used: " << otherTraffic << " packets of other traffic, " << notIp << " not IP, "
+	    << unknownLink << " of unknown link type, " << fragments << " IP fragments, "
+	    << truncated << " truncated";
+  if (capture.UnreadableBytes () > 0)
+    {
+      std::cerr << "; " << capture.UnreadableBytes () << " unreadable bytes at the end of the capture";
+    }
+  std::cerr << "\n";
+  return 0;
+}
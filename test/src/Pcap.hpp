@@ -0,0 +1,37 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PCAP_HPP
+#define PCAP_HPP
+
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* \brief -proto pcap: read the MagElement records from a tcpdump or
+   Wireshark capture (pcap or pcapng), named by -file, and pass them
+   through the processing pipeline as fast as they can be read, as if
+   they had been received.  Records are taken from every UDP datagram
+   and reassembled TCP stream, or only those to or from -port if it was
+   given.  With -out, they are also written to that file as a recording.
+   \return 0 on success, 1 if the capture can't be read. */
+int RunPcap (MagElementTestOptions &options, Pipeline &pipeline);
+
+#endif
@@ -0,0 +1,389 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include "RecordUtilities.hpp"
+#include "Pipeline.hpp"
+
+/* Wait a little longer each time that a queue is found full or empty:
+   yield at first, so that a busy pipeline keeps its latency low, then
+   sleep, so that an idle one doesn't keep a core busy. */
+static void Backoff (uint32_t &attempt)
+{
+  if (attempt < 64)
+    {
+      std::this_thread::yield ();
+    }
+  else if (attempt < 1024)
+    {
+      std::this_thread::sleep_for (std::chrono::microseconds (50));
+    }
+  else
+    {
+      std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    }
+  attempt++;
+}
+
+
+ProcessorStage::ProcessorStage (std::unique_ptr<RecordProcessor> processor, RecordPool &pool)
+  : mProcessor (std::move (processor)), mPool (pool)
+{
+  mProcessor->SetOutput ([this] (const uint8_t *record, uint32_t length)
+  {
+    Forward (mPool.Copy (record, length));
+  });
+}
+
+void ProcessorStage::HandleRecord (const RecordRef &recordRef)
+{
+  Forward (recordRef);
+
+  const uint8_t *record = recordRef.Data ();
+  const RecordHeader *header = (const RecordHeader *)record;
+  switch (header->mRecordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      mProcessor->HandleRawDataBlock (*(const StreamerPacket *)record);
+      break;
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      mProcessor->HandleDecimatedPacket (*(const IndexedMagElementDecimatedMagPacketWithHeader *)record);
+      break;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      mProcessor->HandleStatusPacket (*(const GmMagElementStatusPacket *)record);
+      break;
+    default:
+      break;
+    }
+}
+
+void ProcessorStage::Finish ()
+{
+  mProcessor->Finish ();
+}
+
+
+RecordBatch::RecordBatch (uint32_t batchSize)
+  : mBatchSize (batchSize)
+{
+  mRecords.reserve (batchSize);
+}
+
+bool RecordBatch::Append (const RecordRef &record)
+{
+  if (Full ())
+    {
+      return false;
+    }
+  mRecords.push_back (record);
+  return true;
+}
+
+void RecordBatch::Clear ()
+{
+  mRecords.clear ();
+  mEndOfStream = false;
+}
+
+
+PipelineLink::PipelineLink (uint32_t batchSize, uint32_t queueDepth)
+  : mFull (queueDepth),
+    mEmpty (queueDepth + 2)
+{
+  /* One batch being filled, one being drained, and queueDepth queued. */
+  for (uint32_t index = 0; index < queueDepth + 2; index++)
+    {
+      mPool.push_back (std::make_unique<RecordBatch> (batchSize));
+    }
+  mCurrent = mPool[0].get ();
+  for (size_t index = 1; index < mPool.size (); index++)
+    {
+      mEmpty.TryPush (mPool[index].get ());
+    }
+}
+
+void PipelineLink::HandleRecord (const RecordRef &record)
+{
+  mCurrent->Append (record);
+  mRecords++;
+  if (mCurrent->Full ())
+    {
+      Send ();
+    }
+}
+
+void PipelineLink::Finish ()
+{
+  mCurrent->mEndOfStream = true;
+  Send ();
+}
+
+void PipelineLink::Send ()
+{
+  uint32_t attempt = 0;
+  while (!mFull.TryPush (mCurrent))
+    {
+      if (attempt == 0)
+	{
+	  mStalls++;
+	}
+      Backoff (attempt);
+    }
+  mBatches++;
+
+  attempt = 0;
+  while (!mEmpty.TryPop (mCurrent))
+    {
+      Backoff (attempt);
+    }
+}
+
+RecordBatch *PipelineLink::Receive ()
+{
+  RecordBatch *batch = nullptr;
+  uint32_t attempt = 0;
+  while (!mFull.TryPop (batch))
+    {
+      Backoff (attempt);
+    }
+  return batch;
+}
+
+void PipelineLink::Release (RecordBatch *batch)
+{
+  batch->Clear ();
+  mEmpty.TryPush (batch);
+}
+
+
+/* Batch sizes and queue depths above this are surely mistakes. */
+#define PIPELINE_MAX_COUNT 65536
+
+static bool ParseCount (const std::string &text, uint32_t &value)
+{
+  char *end = nullptr;
+  unsigned long parsed = strtoul (text.c_str (), &end, 10);
+  if ((end == text.c_str ()) || (*end != '\0') || (parsed < 1) || (parsed > PIPELINE_MAX_COUNT))
+    {
+      return false;
+    }
+  value = (uint32_t)parsed;
+  return true;
+}
+
+bool LoadPipelineDescription (const std::string &fileName, PipelineDescription &description)
+{
+  std::ifstream input (fileName);
+  if (!input)
+    {
+      std::cerr << "\n\nError: Pipeline file " << fileName << " can't be opened\n\n";
+      return false;
+    }
+
+  std::string line;
+  int lineNumber = 0;
+  bool newThread = false;
+  while (std::getline (input, line))
+    {
+      lineNumber++;
+      size_t comment = line.find ('#');
+      if (comment != std::string::npos)
+	{
+	  line.erase (comment);
+	}
+
+      std::istringstream words (line);
+      std::string keyword;
+      if (!(words >> keyword))
+	{
+	  continue;
+	}
+      std::vector<std::string> arguments;
+      std::string word;
+      while (words >> word)
+	{
+	  arguments.push_back (word);
+	}
+
+      if ((keyword == "batch") || (keyword == "queue"))
+	{
+	  uint32_t count = 0;
+	  if ((arguments.size () != 1) || !ParseCount (arguments[0], count))
+	    {
+	      std::cerr << "\n\nError: " << fileName << " line " << lineNumber << ": "
+			<< keyword << " must be followed by a number, 1 to " << PIPELINE_MAX_COUNT << "\n\n";
+	      return false;
+	    }
+	  if (keyword == "batch")
+	    {
+	      description.mBatchSize = count;
+	    }
+	  else
+	    {
+	      description.mQueueDepth = count;
+	    }
+	}
+      else if (keyword == "thread")
+	{
+	  if (!arguments.empty ())
+	    {
+	      std::cerr << "\n\nError: " << fileName << " line " << lineNumber << ": "
+			<< "thread takes no arguments\n\n";
+	      return false;
+	    }
+	  newThread = true;
+	}
+      else
+	{
+	  PipelineStageDescription stage;
+	  stage.mName = keyword;
+	  stage.mArguments = arguments;
+	  stage.mNewThread = newThread;
+	  stage.mLine = lineNumber;
+	  description.mStages.push_back (stage);
+	  newThread = false;
+	}
+    }
+
+  if (newThread)
+    {
+      std::cerr << "\n\nError: " << fileName << ": thread must be followed by a stage\n\n";
+      return false;
+    }
+  return true;
+}
+
+
+Pipeline::Pipeline (RecordPool &pool, uint32_t batchSize, uint32_t queueDepth)
+  : mPool (pool), mBatchSize (batchSize), mQueueDepth (queueDepth)
+{
+  mSegments.push_back (std::make_unique<Segment> ());
+}
+
+Pipeline::~Pipeline ()
+{
+  Finish ();
+}
+
+void Pipeline::AddStage (std::unique_ptr<PipelineStage> stage, bool newThread)
+{
+  if (newThread)
+    {
+      auto link = std::make_unique<PipelineLink> (mBatchSize, mQueueDepth);
+      mSegments.back ()->mStages.push_back (link.get ());
+      mLinks.push_back (link.get ());
+
+      auto segment = std::make_unique<Segment> ();
+      segment->mInput = link.get ();
+      mSegments.push_back (std::move (segment));
+      mOwnedStages.push_back (std::move (link));
+    }
+  mSegments.back ()->mStages.push_back (stage.get ());
+  mOwnedStages.push_back (std::move (stage));
+}
+
+void Pipeline::Start ()
+{
+  for (auto &segment : mSegments)
+    {
+      for (size_t index = 0; index + 1 < segment->mStages.size (); index++)
+	{
+	  segment->mStages[index]->SetNext (segment->mStages[index + 1]);
+	}
+    }
+  mFirst = mSegments[0]->mStages.empty () ? nullptr : mSegments[0]->mStages[0];
+  for (PipelineStage *stage : mSegments[0]->mStages)
+    {
+      stage->Start ();
+    }
+
+  for (size_t index = 1; index < mSegments.size (); index++)
+    {
+      mSegments[index]->mThread = std::thread (RunSegment, mSegments[index].get ());
+    }
+  mStarted = true;
+}
+
+void Pipeline::RunSegment (Segment *segment)
+{
+  for (PipelineStage *stage : segment->mStages)
+    {
+      stage->Start ();
+    }
+
+  PipelineStage *first = segment->mStages[0];
+  while (true)
+    {
+      RecordBatch *batch = segment->mInput->Receive ();
+      for (uint32_t index = 0; index < batch->Count (); index++)
+	{
+	  first->HandleRecord (batch->Record (index));
+	}
+      /* Releasing the batch drops its references, so the records'
+	 buffers can go back to the pool. */
+      bool endOfStream = batch->mEndOfStream;
+      segment->mInput->Release (batch);
+      if (endOfStream)
+	{
+	  break;
+	}
+    }
+  for (PipelineStage *stage : segment->mStages)
+    {
+      stage->Finish ();
+    }
+}
+
+void Pipeline::Finish ()
+{
+  if (!mStarted || mFinished)
+    {
+      return;
+    }
+  mFinished = true;
+
+  /* Finishing the first segment ends the stream into the second, and so
+     on down the chain. */
+  for (PipelineStage *stage : mSegments[0]->mStages)
+    {
+      stage->Finish ();
+    }
+  for (size_t index = 1; index < mSegments.size (); index++)
+    {
+      mSegments[index]->mThread.join ();
+    }
+}
+
+void Pipeline::Report (std::ostream &output) const
+{
+  for (size_t index = 0; index < mLinks.size (); index++)
+    {
+      output << "Pipeline thread " << index + 1 << ": "
+	     << mLinks[index]->Records () << " records in "
+	     << mLinks[index]->Batches () << " batches, "
+	     << mLinks[index]->Stalls () << " stalls on a full queue\n";
+    }
+}
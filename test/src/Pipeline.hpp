@@ -0,0 +1,220 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <ostream>
+#include "RecordProcessor.hpp"
+#include "RecordPool.hpp"
+#include "SpscQueue.hpp"
+
+/* One step in the chain that records travel through after they have been
+   received or read: a transform (a RecordProcessor, see ProcessorStage) or
+   a sink (console, file).  A stage passes records on by calling Forward();
+   the Pipeline decides whether the next stage runs on the same thread or
+   on another one.  Records travel as RecordRef handles, so every stage
+   sees the same buffer and none is copied on the way. */
+class PipelineStage
+{
+public:
+  virtual ~PipelineStage () = default;
+
+  virtual void HandleRecord (const RecordRef &record) = 0;
+
+  /* Called once, on the stage's own thread, before its first record;
+     per-thread settings such as CPU affinity belong here. */
+  virtual void Start () {}
+
+  /* Called once, on the stage's own thread, after its last record.  Any
+     records sent on from here still reach the following stages. */
+  virtual void Finish () {}
+
+  void SetNext (PipelineStage *next) { mNext = next; }
+
+protected:
+  void Forward (const RecordRef &record)
+  {
+    if (mNext != nullptr)
+      {
+	mNext->HandleRecord (record);
+      }
+  }
+
+private:
+  PipelineStage *mNext = nullptr;
+};
+
+/* Runs a RecordProcessor as a transform.  Every record is forwarded
+   unchanged, followed by any records that the processor derives from it,
+   which are copied into buffers from the pool. */
+class ProcessorStage : public PipelineStage
+{
+public:
+  ProcessorStage (std::unique_ptr<RecordProcessor> processor, RecordPool &pool);
+
+  void HandleRecord (const RecordRef &record) override;
+  void Finish () override;
+
+private:
+  std::unique_ptr<RecordProcessor> mProcessor;
+  RecordPool                      &mPool;
+};
+
+/* Up to batchSize records which cross a thread boundary together. */
+class RecordBatch
+{
+public:
+  explicit RecordBatch (uint32_t batchSize);
+
+  bool             Append (const RecordRef &record);
+  void             Clear ();
+  bool             Full () const { return mRecords.size () == mBatchSize; }
+  uint32_t         Count () const { return (uint32_t)mRecords.size (); }
+  const RecordRef &Record (uint32_t index) const { return mRecords[index]; }
+
+  bool             mEndOfStream = false;
+
+private:
+  uint32_t               mBatchSize;
+  std::vector<RecordRef> mRecords;
+};
+
+/* Thread boundary.  The producing thread sees a PipelineStage that fills
+   batches and queues them; the consuming thread takes them with Receive()
+   and gives them back with Release().  Batches circulate between a full
+   and an empty queue, so nothing is allocated once the pipeline runs.
+   When the consumer falls behind, the producer waits (back pressure). */
+class PipelineLink : public PipelineStage
+{
+public:
+  PipelineLink (uint32_t batchSize, uint32_t queueDepth);
+
+  /* Producer side */
+  void HandleRecord (const RecordRef &record) override;
+  void Finish () override;
+
+  /* Consumer side */
+  RecordBatch *Receive ();
+  void         Release (RecordBatch *batch);
+
+  /* Producer counters; read them once the consumer thread has ended. */
+  uint64_t     Records () const { return mRecords; }
+  uint64_t     Batches () const { return mBatches; }
+  uint64_t     Stalls () const { return mStalls; }
+
+private:
+  void         Send ();
+
+  std::vector<std::unique_ptr<RecordBatch>> mPool;
+  SpscQueue<RecordBatch *>                  mFull;
+  SpscQueue<RecordBatch *>                  mEmpty;
+  RecordBatch                              *mCurrent = nullptr;
+  uint64_t                                  mRecords = 0;
+  uint64_t                                  mBatches = 0;
+  uint64_t                                  mStalls = 0;
+};
+
+/* The stages after the source, in order, as read from a pipeline file or
+   made up from the command line options. */
+struct PipelineStageDescription
+{
+  std::string              mName;
+  std::vector<std::string> mArguments;
+  bool                     mNewThread = false;  /* Starts a new thread */
+  int                      mLine = 0;           /* In the pipeline file, for messages */
+};
+
+struct PipelineDescription
+{
+  uint32_t                              mBatchSize = 8;
+  uint32_t                              mQueueDepth = 64;   /* In batches */
+  std::vector<PipelineStageDescription> mStages;
+};
+
+/* \brief Read a pipeline file.  Each line is a keyword and its arguments;
+   # starts a comment.  "batch N" and "queue N" set the batch size and the
+   queue depth of each thread boundary, "thread" puts the next stage on a
+   new thread, and any other keyword names a stage.
+   \return false, with a message on cerr, if the file can't be used. */
+bool LoadPipelineDescription (const std::string &fileName, PipelineDescription &description);
+
+/* A chain of stages split into segments, one per thread.  The first
+   segment runs on the thread that calls Submit(), normally the receive
+   loop; each later segment has a thread of its own, fed by a PipelineLink.
+   With no thread boundaries every stage is called directly from the
+   receive loop, as a plain function call. */
+class Pipeline
+{
+public:
+  Pipeline (RecordPool &pool, uint32_t batchSize, uint32_t queueDepth);
+  ~Pipeline ();
+
+  void AddStage (std::unique_ptr<PipelineStage> stage, bool newThread);
+
+  /* Connect the stages and start the threads; call once, after AddStage,
+     from the thread that will call Submit(). */
+  void Start ();
+
+  void Submit (const RecordRef &record)
+  {
+    if (mFirst != nullptr)
+      {
+	mFirst->HandleRecord (record);
+      }
+  }
+
+  /* Buffers for the records submitted to the pipeline. */
+  RecordPool &Pool () { return mPool; }
+
+  /* Finish the stages in order, draining each thread; call once, from the
+     thread that called Submit(). */
+  void Finish ();
+
+  void Report (std::ostream &output) const;
+
+private:
+  struct Segment
+  {
+    std::vector<PipelineStage *> mStages;
+    PipelineLink                *mInput = nullptr;
+    std::thread                  mThread;
+  };
+
+  static void RunSegment (Segment *segment);
+
+  RecordPool                                 &mPool;
+  uint32_t                                    mBatchSize;
+  uint32_t                                    mQueueDepth;
+  std::vector<std::unique_ptr<PipelineStage>> mOwnedStages;
+  std::vector<PipelineLink *>                 mLinks;
+  std::vector<std::unique_ptr<Segment>>       mSegments;
+  PipelineStage                              *mFirst = nullptr;
+  bool                                        mStarted = false;
+  bool                                        mFinished = false;
+};
+
+#endif
@@ -0,0 +1,310 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+#include "TestClient.hpp"
+#include "StreamStatistics.hpp"
+#include "WelchPsd.hpp"
+#include "Gradiometer.hpp"
+#include "AnomalyDetector.hpp"
+#include "TollesLawson.hpp"
+#include "Resampler.hpp"
+#include "FixedPoint.hpp"
+#include "Fft.hpp"
+#include "StdoutSink.hpp"
+#include "PipelineStages.hpp"
+
+void DescribePipeline (const MagElementTestOptions &options, PipelineDescription &description)
+{
+  std::vector<std::string> names;
+  if (options.mStatisticsWindow > 0)
+    {
+      names.push_back ("stats");
+    }
+  if (options.mPsdEnabled)
+    {
+      names.push_back ("psd");
+    }
+  if (options.mGradiometerEnabled)
+    {
+      names.push_back ("gradiometer");
+    }
+  if (options.mAnomalyFactor > 0)
+    {
+      names.push_back ("anomaly");
+    }
+  if (!options.mCompensationFileName.empty ())
+    {
+      names.push_back ("compensate");
+    }
+  if (options.mResampleRate > 0)
+    {
+      names.push_back ("resample");
+    }
+  if (options.mFixedDecimation > 0)
+    {
+      names.push_back ("fixed");
+    }
+  names.push_back ("output");
+  if (options.mStdout)
+    {
+      names.push_back ("stdout");
+    }
+
+  for (const std::string &name : names)
+    {
+      PipelineStageDescription stage;
+      stage.mName = name;
+      description.mStages.push_back (stage);
+    }
+}
+
+/* Report a bad stage, naming the pipeline file line if there is one. */
+static std::unique_ptr<PipelineStage> StageError (const PipelineStageDescription &description,
+						  const std::string &message)
+{
+  std::cerr << "\n\nError: ";
+  if (description.mLine > 0)
+    {
+      std::cerr << "pipeline line " << description.mLine << ": ";
+    }
+  std::cerr << description.mName << " " << message << "\n\n";
+  return nullptr;
+}
+
+/* \return false if argument index is present but not a whole number in
+   [minimum, maximum]; value is left alone if the argument is absent. */
+static bool StageNumber (const PipelineStageDescription &description, size_t index,
+			 uint32_t minimum, uint32_t maximum, uint32_t &value)
+{
+  if (index >= description.mArguments.size ())
+    {
+      return true;
+    }
+  const std::string &text = description.mArguments[index];
+  char *end = nullptr;
+  unsigned long parsed = strtoul (text.c_str (), &end, 10);
+  if ((end == text.c_str ()) || (*end != '\0') || (parsed < minimum) || (parsed > maximum))
+    {
+      return false;
+    }
+  value = (uint32_t)parsed;
+  return true;
+}
+
+/* Known stages and the number of arguments that each accepts. */
+static const struct
+{
+  const char *mName;
+  size_t      mMaxArguments;
+} sStageNames[] = {
+  { "stats",       1 },
+  { "psd",         3 },
+  { "gradiometer", 1 },
+  { "anomaly",     3 },
+  { "compensate",  1 },
+  { "resample",    2 },
+  { "fixed",       2 },
+  { "output",      0 },
+  { "console",     0 },
+  { "file",        0 },
+  { "stdout",      1 },
+};
+
+std::unique_ptr<PipelineStage> CreatePipelineStage (const PipelineStageDescription &description,
+						    MagElementTestOptions &options,
+						    FILE *recordFile,
+						    RecordPool &pool)
+{
+  const std::string &name = description.mName;
+  bool known = false;
+  for (const auto &stageName : sStageNames)
+    {
+      if (name == stageName.mName)
+	{
+	  known = true;
+	  if (description.mArguments.size () > stageName.mMaxArguments)
+	    {
+	      return StageError (description, "has too many arguments");
+	    }
+	}
+    }
+  if (!known)
+    {
+      return StageError (description, "is not a known stage");
+    }
+
+  if (name == "stats")
+    {
+      uint32_t window = options.mStatisticsWindow;
+      if (!StageNumber (description, 0, 4, 10000000, window) || (window == 0))
+	{
+	  return StageError (description, "needs a window length of 4 to 10000000 samples");
+	}
+      return std::make_unique<ProcessorStage> (std::make_unique<StatisticsProcessor> (window), pool);
+    }
+  else if (name == "psd")
+    {
+      std::string logName = options.mPsdLogName;
+      uint32_t length = options.mPsdLength;
+      uint32_t averages = options.mPsdAverages;
+      if (!description.mArguments.empty ())
+	{
+	  logName = description.mArguments[0];
+	  if (std::filesystem::exists (logName))
+	    {
+	      return StageError (description, "log file already exists");
+	    }
+	}
+      if (logName.empty ())
+	{
+	  return StageError (description, "needs a log file name");
+	}
+      if (!StageNumber (description, 1, 64, 1048576, length) || !RealFft::IsValidLength (length))
+	{
+	  return StageError (description, "length must be a power of two, 64 to 1048576");
+	}
+      if (!StageNumber (description, 2, 1, 10000, averages))
+	{
+	  return StageError (description, "averages must be a number, 1 to 10000");
+	}
+      auto psd = std::make_unique<PsdProcessor> (length, averages);
+      if (!psd->OpenLog (logName))
+	{
+	  return nullptr;
+	}
+      return std::make_unique<ProcessorStage> (std::move (psd), pool);
+    }
+  else if (name == "gradiometer")
+    {
+      uint32_t decimation = options.mGradiometerDecimation;
+      if (!StageNumber (description, 0, 1, 1000000, decimation))
+	{
+	  return StageError (description, "decimation must be a number, 1 to 1000000");
+	}
+      return std::make_unique<ProcessorStage> (std::make_unique<GradiometerProcessor> (decimation), pool);
+    }
+  else if (name == "anomaly")
+    {
+      uint32_t factor = options.mAnomalyFactor > 0 ? options.mAnomalyFactor : 6;
+      uint32_t window = options.mAnomalyWindow;
+      uint32_t background = options.mAnomalyBackground;
+      if (!StageNumber (description, 0, 1, 1000, factor))
+	{
+	  return StageError (description, "threshold factor must be a number, 1 to 1000");
+	}
+      if (!StageNumber (description, 1, 2, 100000, window))
+	{
+	  return StageError (description, "window must be a number of samples, 2 to 100000");
+	}
+      if (!StageNumber (description, 2, 2, 10000000, background))
+	{
+	  return StageError (description, "background must be a number of samples, 2 to 10000000");
+	}
+      return std::make_unique<ProcessorStage> (std::make_unique<AnomalyProcessor> (window, background, factor), pool);
+    }
+  else if (name == "compensate")
+    {
+      std::string fileName = description.mArguments.empty () ? options.mCompensationFileName :
+	description.mArguments[0];
+      if (fileName.empty ())
+	{
+	  return StageError (description, "needs a coefficients file name");
+	}
+      uint32_t halfWidth = options.mCompensationFilter;
+      auto compensation = std::make_unique<CompensationProcessor> (fileName, halfWidth);
+      if (options.mCompensationCalibrate)
+	{
+	  compensation->SetCalibration (options.mCompensationFirst, options.mCompensationLast);
+	}
+      else if (!compensation->Load ())
+	{
+	  return nullptr;
+	}
+      return std::make_unique<ProcessorStage> (std::move (compensation), pool);
+    }
+  else if (name == "resample")
+    {
+      uint32_t rate = options.mResampleRate > 0 ? options.mResampleRate : 100;
+      std::string kernelName = (description.mArguments.size () > 1) ? description.mArguments[1] :
+	options.mResampleKernel;
+      uint16_t kernel = RESAMPLE_KERNEL_CUBIC;
+      if (!StageNumber (description, 0, 1, 10000, rate))
+	{
+	  return StageError (description, "rate must be a number in Hz, 1 to 10000");
+	}
+      if (!ParseResampleKernel (kernelName, kernel))
+	{
+	  return StageError (description, "kernel must be linear, cubic or sinc");
+	}
+      return std::make_unique<ProcessorStage> (std::make_unique<ResampleProcessor> (rate, kernel), pool);
+    }
+  else if (name == "fixed")
+    {
+      uint32_t decimation = options.mFixedDecimation > 0 ? options.mFixedDecimation : 10;
+      uint32_t order = options.mFixedOrder;
+      if (!StageNumber (description, 0, 1, 1000000, decimation))
+	{
+	  return StageError (description, "decimation must be a number, 1 to 1000000");
+	}
+      if (!StageNumber (description, 1, 1, FIXED_POINT_MAX_ORDER, order))
+	{
+	  return StageError (description, "order must be a number, 1 to " + std::to_string (FIXED_POINT_MAX_ORDER));
+	}
+      if (CicDecimator::RegisterBits (decimation, order) > FIXED_POINT_REGISTER_BITS)
+	{
+	  return StageError (description, "decimation and order need more than 63 bits");
+	}
+      return std::make_unique<ProcessorStage> (std::make_unique<FixedPointProcessor> (decimation, order), pool);
+    }
+  else if (name == "output")
+    {
+      return CreateOutputStage (options, recordFile, true);
+    }
+  else if (name == "console")
+    {
+      return CreateOutputStage (options, nullptr, true);
+    }
+  else if (name == "file")
+    {
+      if (recordFile == nullptr)
+	{
+	  return StageError (description, "needs -proto tcp or udp, and -file");
+	}
+      return CreateOutputStage (options, recordFile, false);
+    }
+  else if (name == "stdout")
+    {
+      std::vector<uint32_t> types = options.mStdoutTypes;
+      if (!options.mStdout)
+	{
+	  return StageError (description, "needs -stdout, which keeps text off standard output");
+	}
+      if (!description.mArguments.empty () && !ParseRecordTypes (description.mArguments[0], types))
+	{
+	  return StageError (description, "types must be all, or a comma separated list of record types");
+	}
+      return CreateStdoutStage (options, types);
+    }
+  return nullptr;
+}
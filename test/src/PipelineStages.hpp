@@ -0,0 +1,58 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PIPELINE_STAGES_HPP
+#define PIPELINE_STAGES_HPP
+
+#include <stdio.h>
+#include <memory>
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* \brief The stages implied by the command line: the processors selected
+   with -stats, -psd, -gradiometer, -anomaly, -compensate, -resample and
+   -fixed, in that order, then the output to console and file, then
+   standard output with -stdout.  With -threads stage each runs on its
+   own thread. */
+void DescribePipeline (const MagElementTestOptions &options, PipelineDescription &description);
+
+/* \brief Make one stage.  Stage names and their optional arguments, which
+   default to the matching command line options:
+     stats [window]
+     psd [log file [length [averages]]]
+     gradiometer [decimation]
+     anomaly [factor [rms [trend]]]
+     compensate [file]
+     resample [rate [kernel]]
+     fixed [decimation [order]]
+     output       console (in verbose mode) and the recording file
+     console      console only
+     file         recording file only
+     stdout [types]  records, unchanged, to standard output (needs -stdout)
+   recordFile is the file that records are saved to, or nullptr; pool
+   supplies buffers for derived records.
+   \return nullptr, with a message on cerr, if the stage can't be made. */
+std::unique_ptr<PipelineStage> CreatePipelineStage (const PipelineStageDescription &description,
+						    MagElementTestOptions &options,
+						    FILE *recordFile,
+						    RecordPool &pool);
+
+#endif
@@ -0,0 +1,129 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "MinMaxPyramid.hpp"
+#include "Pyramid.hpp"
+
+/* \brief Minimum, maximum and mean of a column in nT, or three blanks. */
+static void PrintColumn (std::ostream &output, const PyramidBucket &column)
+{
+  if (column.mCount == 0)
+    {
+      output << ",,,";
+      return;
+    }
+  output << "," << MAG_DATA_AS_FLOAT (column.mMinimum)
+	 << "," << MAG_DATA_AS_FLOAT (column.mMaximum)
+	 << "," << MAG_DATA_AS_FLOAT ((double)column.mSum / column.mCount);
+}
+
+int RunPyramid (MagElementTestOptions &options)
+{
+  auto startTime = std::chrono::steady_clock::now ();
+  std::string recordingName = options.mFileNameToSave;
+  std::string pyramidName = options.mOutputFileName.empty () ? recordingName + ".pyr" : options.mOutputFileName;
+
+  RecordingReader reader;
+  if (!reader.Open (recordingName))
+    {
+      return 1;
+    }
+  std::error_code error;
+  uint64_t recordingSize = std::filesystem::file_size (recordingName, error);
+
+  /* Only a pyramid is ever replaced, never some other file given by mistake. */
+  MinMaxPyramid pyramid;
+  if (std::filesystem::exists (pyramidName))
+    {
+      if (!pyramid.Open (pyramidName))
+	{
+	  std::cerr << "\n\nError: " << pyramidName << " was left as it is\n\n";
+	  return 1;
+	}
+      if ((pyramid.RecordingSize () != recordingSize) || (pyramid.FirstIndex () != reader.FirstIndex ()) ||
+	  (pyramid.EndIndex () != reader.EndIndex ()))
+	{
+	  pyramid.Close ();
+	}
+    }
+  bool built = false;
+  if (!pyramid.IsOpen ())
+    {
+      if (!BuildPyramid (reader, recordingSize, pyramidName) || !pyramid.Open (pyramidName))
+	{
+	  return 1;
+	}
+      built = true;
+    }
+  if (options.mVerboseMode)
+    {
+      double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+      std::cerr << "Pyramid: " << pyramidName << (built ? " built" : " up to date") << ", indices "
+		<< pyramid.FirstIndex () << " to " << pyramid.EndIndex () << " (exclusive), "
+		<< pyramid.LevelCount () << " levels, " << std::filesystem::file_size (pyramidName, error)
+		<< " bytes, " << seconds << " s\n";
+    }
+
+  uint32_t pixels = options.mPyramidPixels;
+  if (pixels == 0)
+    {
+      return 0;
+    }
+  uint64_t first = options.mExtractAll ? pyramid.FirstIndex () : options.mExtractFirst;
+  uint64_t end = options.mExtractAll ? pyramid.EndIndex () : options.mExtractLast + 1;
+  if (end < first)
+    {
+      end = first;
+    }
+
+  std::ofstream csvFile;
+  if (!options.mExtractFileName.empty ())
+    {
+      csvFile.open (options.mExtractFileName);
+      if (!csvFile)
+	{
+	  std::cerr << "\n\nError: CSV file " << options.mExtractFileName << " can't be opened\n\n";
+	  return 1;
+	}
+    }
+  std::ostream &output = csvFile.is_open () ? (std::ostream &)csvFile : std::cout;
+
+  std::vector<PyramidBucket> mag1, mag2;
+  pyramid.Query (0, first, end, pixels, mag1, &reader);
+  pyramid.Query (1, first, end, pixels, mag2, &reader);
+  output << "first,end,mag1_min,mag1_max,mag1_mean,mag2_min,mag2_max,mag2_mean\n"
+	 << std::fixed << std::setprecision (6);
+  for (uint32_t pixel = 0; pixel < pixels; pixel++)
+    {
+      output << MinMaxPyramid::ColumnStart (first, end, pixels, pixel) << ","
+	     << MinMaxPyramid::ColumnStart (first, end, pixels, pixel + 1);
+      PrintColumn (output, mag1[pixel]);
+      PrintColumn (output, mag2[pixel]);
+      output << "\n";
+    }
+  return 0;
+}
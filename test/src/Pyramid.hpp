@@ -0,0 +1,36 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef PYRAMID_HPP
+#define PYRAMID_HPP
+
+#include "TestOptions.hpp"
+
+/* \brief -proto pyramid: build the min/max/mean pyramid sidecar (see
+   MinMaxPyramid.hpp) for the recording named by -file, as -out or, by
+   default, the recording's name with .pyr added.  A sidecar that is
+   already up to date is kept.  With -pixels, then print mag1 and mag2
+   in nT for the -range indices (default: the whole recording), one CSV
+   row per pixel column, to the -csv file or the console.
+   \return 0 on success, 1 on failure. */
+int RunPyramid (MagElementTestOptions &options);
+
+#endif
@@ -0,0 +1,174 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "RealTime.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#define PSAPI_VERSION 2
+#include <psapi.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+/* Stack depth touched by PrefaultStack; the receive loops need a few KB,
+   the processors somewhat more. */
+#define PREFAULT_STACK_BYTES (256 * 1024)
+
+static void Warn (const char *threadName, const char *what, const char *reason)
+{
+  std::cerr << "\n\nWarning: " << threadName << " thread: " << what;
+  if (reason != nullptr)
+    {
+      std::cerr << " (" << reason << ")";
+    }
+  std::cerr << "\n\n";
+}
+
+bool PinThreadToCpu (int cpu, const char *threadName)
+{
+#ifdef _WIN32
+  if ((cpu >= 64) || (SetThreadAffinityMask (GetCurrentThread (), (DWORD_PTR)1 << cpu) == 0))
+    {
+      Warn (threadName, "can't be pinned to the CPU", nullptr);
+      return false;
+    }
+  return true;
+#elif defined(__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO (&cpus);
+  CPU_SET (cpu, &cpus);
+  int result = pthread_setaffinity_np (pthread_self (), sizeof (cpus), &cpus);
+  if (result != 0)
+    {
+      Warn (threadName, "can't be pinned to the CPU", strerror (result));
+      return false;
+    }
+  return true;
+#else
+  Warn (threadName, "can't be pinned to a CPU on this platform", nullptr);
+  return false;
+#endif
+}
+
+bool SetRealTimePriority (bool roundRobin, int priority, const char *threadName)
+{
+#ifdef _WIN32
+  if (!SetThreadPriority (GetCurrentThread (), THREAD_PRIORITY_TIME_CRITICAL))
+    {
+      Warn (threadName, "can't be given time-critical priority", nullptr);
+      return false;
+    }
+  return true;
+#else
+  struct sched_param parameters;
+  memset (&parameters, 0, sizeof (parameters));
+  parameters.sched_priority = priority;
+  int result = pthread_setschedparam (pthread_self (), roundRobin ? SCHED_RR : SCHED_FIFO, &parameters);
+  if (result != 0)
+    {
+      Warn (threadName, "can't be given real-time priority",
+	    (result == EPERM) ? "needs CAP_SYS_NICE or an rtprio limit" : strerror (result));
+      return false;
+    }
+  return true;
+#endif
+}
+
+bool LockAllMemory ()
+{
+#ifdef _WIN32
+  Warn ("main", "memory locking is not supported on Windows", nullptr);
+  return false;
+#else
+  if (mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+      int error = errno;
+      Warn ("main", "can't lock memory",
+	    ((error == EPERM) || (error == ENOMEM)) ? "needs CAP_IPC_LOCK or a higher memlock limit" : strerror (error));
+      return false;
+    }
+  return true;
+#endif
+}
+
+void PrefaultStack ()
+{
+  volatile uint8_t stack[PREFAULT_STACK_BYTES];
+  for (size_t offset = 0; offset < sizeof (stack); offset += 4096)
+    {
+      stack[offset] = 0;
+    }
+}
+
+ResourceUsage ResourceUsage::Process ()
+{
+  ResourceUsage usage;
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo (GetCurrentProcess (), &counters, sizeof (counters)))
+    {
+      usage.mMinorFaults = counters.PageFaultCount;
+    }
+#else
+  struct rusage counts;
+  if (getrusage (RUSAGE_SELF, &counts) == 0)
+    {
+      usage.mMinorFaults = counts.ru_minflt;
+      usage.mMajorFaults = counts.ru_majflt;
+      usage.mVoluntarySwitches = counts.ru_nvcsw;
+      usage.mInvoluntarySwitches = counts.ru_nivcsw;
+    }
+#endif
+  return usage;
+}
+
+ResourceUsage ResourceUsage::CurrentThread ()
+{
+  ResourceUsage usage;
+#ifdef __linux__
+  struct rusage counts;
+  if (getrusage (RUSAGE_THREAD, &counts) == 0)
+    {
+      usage.mMinorFaults = counts.ru_minflt;
+      usage.mMajorFaults = counts.ru_majflt;
+      usage.mVoluntarySwitches = counts.ru_nvcsw;
+      usage.mInvoluntarySwitches = counts.ru_nivcsw;
+    }
+#endif
+  return usage;
+}
+
+void ReportResourceUsage (std::ostream &output, const char *label,
+			  const ResourceUsage &start, const ResourceUsage &end)
+{
+  output << label << ": "
+	 << end.mMinorFaults - start.mMinorFaults << " minor faults, "
+	 << end.mMajorFaults - start.mMajorFaults << " major faults, "
+	 << end.mVoluntarySwitches - start.mVoluntarySwitches << " voluntary and "
+	 << end.mInvoluntarySwitches - start.mInvoluntarySwitches << " involuntary context switches\n";
+}
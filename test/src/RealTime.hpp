@@ -0,0 +1,65 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef REAL_TIME_HPP
+#define REAL_TIME_HPP
+
+#include <stdint.h>
+#include <ostream>
+
+/* Scheduling and memory settings that keep the receiving thread from being
+   held up by other work on a shared computer.  Each function applies to the
+   calling thread or process, and on failure prints a warning and returns
+   false; the program carries on without the setting. */
+
+/* \brief Run the calling thread only on the given CPU. */
+bool PinThreadToCpu (int cpu, const char *threadName);
+
+/* \brief Put the calling thread in the SCHED_FIFO (or SCHED_RR) class at
+   the given priority, 1 to 99.  On Windows, time-critical priority. */
+bool SetRealTimePriority (bool roundRobin, int priority, const char *threadName);
+
+/* \brief Lock the program's current and future memory into RAM, so that no
+   buffer or stack page faults once the data flows. */
+bool LockAllMemory ();
+
+/* \brief Touch the calling thread's stack down to the depth that the
+   receive loops use, so those pages are present (and, after
+   LockAllMemory, locked) before the first record arrives. */
+void PrefaultStack ();
+
+/* Page fault and context switch counts, for the process or one thread. */
+struct ResourceUsage
+{
+  uint64_t mMinorFaults = 0;
+  uint64_t mMajorFaults = 0;
+  uint64_t mVoluntarySwitches = 0;
+  uint64_t mInvoluntarySwitches = 0;
+
+  static ResourceUsage Process ();
+  static ResourceUsage CurrentThread ();
+};
+
+/* \brief Print the counts accumulated between start and end. */
+void ReportResourceUsage (std::ostream &output, const char *label,
+			  const ResourceUsage &start, const ResourceUsage &end);
+
+#endif
@@ -0,0 +1,223 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cstring>
+#include <new>
+#include "DerivedRecords.hpp"
+#include "RecordPool.hpp"
+
+/* Slots start on cache line boundaries, so that two threads working on
+   neighbouring records don't share a line. */
+#define POOL_SLOT_ALIGNMENT 64
+
+RecordRef::RecordRef (const RecordRef &other)
+  : mSlot (other.mSlot)
+{
+  if (mSlot != nullptr)
+    {
+      mSlot->mReferences.fetch_add (1, std::memory_order_relaxed);
+    }
+}
+
+RecordRef &RecordRef::operator= (const RecordRef &other)
+{
+  if (other.mSlot != nullptr)
+    {
+      other.mSlot->mReferences.fetch_add (1, std::memory_order_relaxed);
+    }
+  Reset ();
+  mSlot = other.mSlot;
+  return *this;
+}
+
+RecordRef &RecordRef::operator= (RecordRef &&other) noexcept
+{
+  if (this != &other)
+    {
+      Reset ();
+      mSlot = other.mSlot;
+      other.mSlot = nullptr;
+    }
+  return *this;
+}
+
+void RecordRef::Reset ()
+{
+  if (mSlot == nullptr)
+    {
+      return;
+    }
+  if (mSlot->mReferences.fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+      if (mSlot->mPool != nullptr)
+	{
+	  mSlot->mPool->Free (mSlot);
+	}
+      else
+	{
+	  mSlot->~PoolSlot ();
+	  ::operator delete (mSlot);
+	}
+    }
+  mSlot = nullptr;
+}
+
+
+SlabPool::SlabPool (uint32_t slotSize, uint32_t slotCount)
+  : mSlotSize (slotSize), mSlotCount (slotCount)
+{
+  mStride = (sizeof (PoolSlot) + slotSize + POOL_SLOT_ALIGNMENT - 1) & ~(size_t)(POOL_SLOT_ALIGNMENT - 1);
+  size_t bytes = mStride * slotCount;
+  mSlab = (uint8_t *)::operator new (bytes, std::align_val_t (POOL_SLOT_ALIGNMENT));
+  memset (mSlab, 0, bytes);
+
+  /* Chain every slot into the free list, lowest index first out. */
+  for (uint32_t index = 0; index < slotCount; index++)
+    {
+      PoolSlot *slot = new (SlotAt (index)) PoolSlot;
+      slot->mIndex = index;
+      slot->mCapacity = slotSize;
+      slot->mPool = this;
+      slot->mNextFree.store ((index + 1 < slotCount) ? index + 2 : 0, std::memory_order_relaxed);
+    }
+  mFreeHead.store ((slotCount > 0) ? 1 : 0, std::memory_order_release);
+}
+
+SlabPool::~SlabPool ()
+{
+  for (uint32_t index = 0; index < mSlotCount; index++)
+    {
+      SlotAt (index)->~PoolSlot ();
+    }
+  ::operator delete (mSlab, std::align_val_t (POOL_SLOT_ALIGNMENT));
+}
+
+RecordRef SlabPool::Allocate ()
+{
+  uint64_t head = mFreeHead.load (std::memory_order_acquire);
+  PoolSlot *slot = nullptr;
+  while (true)
+    {
+      uint32_t index = (uint32_t)head;
+      if (index == 0)
+	{
+	  mExhausted.fetch_add (1, std::memory_order_relaxed);
+	  return RecordRef ();
+	}
+      slot = SlotAt (index - 1);
+      uint64_t next = slot->mNextFree.load (std::memory_order_relaxed);
+      uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+      if (mFreeHead.compare_exchange_weak (head, newHead, std::memory_order_acquire,
+					   std::memory_order_acquire))
+	{
+	  break;
+	}
+    }
+
+  slot->mReferences.store (1, std::memory_order_relaxed);
+  slot->mLength = 0;
+  mAllocations.fetch_add (1, std::memory_order_relaxed);
+  uint32_t inUse = mInUse.fetch_add (1, std::memory_order_relaxed) + 1;
+  uint32_t highWater = mHighWater.load (std::memory_order_relaxed);
+  while ((inUse > highWater) &&
+	 !mHighWater.compare_exchange_weak (highWater, inUse, std::memory_order_relaxed))
+    {
+    }
+  return RecordRef (slot);
+}
+
+void SlabPool::Free (PoolSlot *slot)
+{
+  mInUse.fetch_sub (1, std::memory_order_relaxed);
+  uint64_t head = mFreeHead.load (std::memory_order_relaxed);
+  uint64_t newHead;
+  do
+    {
+      slot->mNextFree.store ((uint32_t)head, std::memory_order_relaxed);
+      newHead = (((head >> 32) + 1) << 32) | (slot->mIndex + 1);
+    }
+  while (!mFreeHead.compare_exchange_weak (head, newHead, std::memory_order_release,
+					   std::memory_order_relaxed));
+}
+
+void SlabPool::Report (std::ostream &output) const
+{
+  output << "Pool of " << mSlotSize << " byte records: "
+	 << mSlotCount << " slots, "
+	 << mInUse.load () << " in use, "
+	 << mHighWater.load () << " at most, "
+	 << mAllocations.load () << " allocations, "
+	 << mExhausted.load () << " times exhausted\n";
+}
+
+
+RecordPool::RecordPool (uint32_t slotsPerClass)
+{
+  static const uint32_t sClassSizes[] = {
+    sizeof (IndexedMagElementDecimatedMagPacketWithHeader),
+    sizeof (GmMagElementStatusPacket),
+    sizeof (GradiometerPacket),
+    sizeof (StreamerPacket),
+  };
+  for (uint32_t size : sClassSizes)
+    {
+      mPools.push_back (std::make_unique<SlabPool> (size, slotsPerClass));
+    }
+}
+
+RecordRef RecordPool::Allocate (uint32_t length)
+{
+  for (auto &pool : mPools)
+    {
+      if (pool->SlotSize () >= length)
+	{
+	  RecordRef record = pool->Allocate ();
+	  if (record)
+	    {
+	      record.SetLength (length);
+	      return record;
+	    }
+	}
+    }
+
+  mOverflows.fetch_add (1, std::memory_order_relaxed);
+  PoolSlot *slot = new (::operator new (sizeof (PoolSlot) + length)) PoolSlot;
+  slot->mReferences.store (1, std::memory_order_relaxed);
+  slot->mCapacity = length;
+  slot->mLength = length;
+  return RecordRef (slot);
+}
+
+RecordRef RecordPool::Copy (const void *record, uint32_t length)
+{
+  RecordRef copy = Allocate (length);
+  memcpy (copy.Buffer (), record, length);
+  return copy;
+}
+
+void RecordPool::Report (std::ostream &output) const
+{
+  for (const auto &pool : mPools)
+    {
+      pool->Report (output);
+    }
+  output << "Records allocated from the heap: " << mOverflows.load () << "\n";
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORD_POOL_HPP
+#define RECORD_POOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <ostream>
+
+class SlabPool;
+
+/* Header in front of every record buffer.  The reference count is
+   intrusive, so a RecordRef is a single pointer. */
+struct PoolSlot
+{
+  std::atomic<uint32_t> mReferences {0};
+  std::atomic<uint32_t> mNextFree {0};   /* Free list link: slot index + 1, 0 = end */
+  uint32_t              mIndex = 0;
+  uint32_t              mLength = 0;
+  uint32_t              mCapacity = 0;
+  SlabPool             *mPool = nullptr; /* nullptr for an overflow buffer from the heap */
+
+  uint8_t *Data () { return (uint8_t *)(this + 1); }
+};
+
+/* Shared handle to one record in a pool.  Copies share the buffer;
+   the buffer goes back to its pool when the last copy is destroyed.
+   Handles may be copied and destroyed on any thread. */
+class RecordRef
+{
+public:
+  RecordRef () = default;
+  RecordRef (const RecordRef &other);
+  RecordRef (RecordRef &&other) noexcept : mSlot (other.mSlot) { other.mSlot = nullptr; }
+  RecordRef &operator= (const RecordRef &other);
+  RecordRef &operator= (RecordRef &&other) noexcept;
+  ~RecordRef () { Reset (); }
+
+  void           Reset ();
+  explicit       operator bool () const { return mSlot != nullptr; }
+
+  const uint8_t *Data () const { return mSlot->Data (); }
+  uint32_t       Length () const { return mSlot->mLength; }
+
+  /* For the one who fills the record, before it is shared. */
+  uint8_t       *Buffer () { return mSlot->Data (); }
+  uint32_t       Capacity () const { return mSlot->mCapacity; }
+  void           SetLength (uint32_t length) { mSlot->mLength = length; }
+
+private:
+  friend class SlabPool;
+  friend class RecordPool;
+  explicit RecordRef (PoolSlot *slot) : mSlot (slot) {}
+
+  PoolSlot *mSlot = nullptr;
+};
+
+/* Fixed number of equal-sized slots in one allocation, touched when the
+   pool is made so that it is resident (and locked, with -lock-memory)
+   before any data arrives.  The free list is a lock-free stack; the
+   head carries a tag that changes on every update, which stops a slot
+   that is freed and reused meanwhile from corrupting the list. */
+class SlabPool
+{
+public:
+  SlabPool (uint32_t slotSize, uint32_t slotCount);
+  ~SlabPool ();
+
+  SlabPool (const SlabPool &) = delete;
+  SlabPool &operator= (const SlabPool &) = delete;
+
+  /* \return an empty handle if every slot is in use. */
+  RecordRef Allocate ();
+  void      Free (PoolSlot *slot);
+
+  uint32_t  SlotSize () const { return mSlotSize; }
+  void      Report (std::ostream &output) const;
+
+private:
+  PoolSlot *SlotAt (uint32_t index) const { return (PoolSlot *)(mSlab + (size_t)index * mStride); }
+
+  uint32_t              mSlotSize;
+  uint32_t              mSlotCount;
+  size_t                mStride;
+  uint8_t              *mSlab;
+  std::atomic<uint64_t> mFreeHead {0};    /* Tag in the high 32 bits, index + 1 in the low */
+
+  std::atomic<uint32_t> mInUse {0};
+  std::atomic<uint32_t> mHighWater {0};
+  std::atomic<uint64_t> mAllocations {0};
+  std::atomic<uint64_t> mExhausted {0};
+};
+
+/* One SlabPool for each record size: decimated (88 bytes), heartbeat
+   (108), gradiometer (672) and 1000Hz block (1296).  A request is served
+   from the smallest class that fits and has a free slot.  Only when
+   every such class is full, or the record is larger than any class,
+   does a buffer come from the heap; those are counted as overflows, and
+   a steady state without them needs no allocation at all. */
+class RecordPool
+{
+public:
+  explicit RecordPool (uint32_t slotsPerClass);
+
+  RecordRef Allocate (uint32_t length);
+
+  /* \brief Allocate and fill in one step. */
+  RecordRef Copy (const void *record, uint32_t length);
+
+  void      Report (std::ostream &output) const;
+
+private:
+  std::vector<std::unique_ptr<SlabPool>> mPools;
+  std::atomic<uint64_t>                  mOverflows {0};
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORD_PROCESSOR_HPP
+#define RECORD_PROCESSOR_HPP
+
+#include <stdint.h>
+#include <functional>
+#include "MagElementData.hpp"
+
+/* Base class for processing stages that watch the records as they are
+   received or read from a file.  Each runs in the pipeline inside a
+   ProcessorStage, which passes every record on to the next stage and then
+   calls the Handle* function for its type; a processor overrides only the
+   record types it cares about. */
+class RecordProcessor
+{
+public:
+  virtual ~RecordProcessor () = default;
+
+  /* 1000Hz block of 40 MFAM samples. */
+  virtual void HandleRawDataBlock (const StreamerPacket & /* streamerPacket */) {}
+
+  /* Decimated magnetometer record. */
+  virtual void HandleDecimatedPacket (const IndexedMagElementDecimatedMagPacketWithHeader & /* decimatedPacket */) {}
+
+  /* 1Hz status ("heartbeat") record.  Processors that report periodically
+     do so here, so that output follows the instrument's own cadence. */
+  virtual void HandleStatusPacket (const GmMagElementStatusPacket & /* statusPacket */) {}
+
+  /* Called once when the input ends or the program shuts down. */
+  virtual void Finish () {}
+
+  /* Processors that derive records of their own (see DerivedRecords.hpp)
+     pass them to Emit().  ProcessorStage sets the output to copy each one
+     into the record pool and forward it to the next stage, after the
+     record it was derived from. */
+  typedef std::function<void (const uint8_t *record, uint32_t length)> RecordOutput;
+  void SetOutput (RecordOutput output) { mOutput = output; }
+
+protected:
+  void Emit (const void *record, uint32_t length)
+  {
+    if (mOutput)
+      {
+	mOutput ((const uint8_t *)record, length);
+      }
+  }
+
+private:
+  RecordOutput mOutput;
+};
+
+#endif
@@ -0,0 +1,315 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "RecordUtilities.hpp"
+#include "RecordSchema.hpp"
+
+/* Limits on what a layout file may describe. */
+#define SCHEMA_MAX_RECORD_SIZE (1 << 20)
+#define SCHEMA_MAX_REPEAT      65536
+
+/* The records of this program's own firmware, in the layout file format;
+   the offsets follow MagElementData.hpp. */
+static const char *sDefaultLayouts =
+  "record block 0x1001F 1296\n"
+  "field index 8 u64\n"
+  "repeat 40 32\n"
+  "field frameid 16 u16\n"
+  "field sysstat 18 u16\n"
+  "field mag1 20 u32 5e-5\n"
+  "field mag1stat 24 u16\n"
+  "field mag2stat 26 u16\n"
+  "field mag2 28 u32 5e-5\n"
+  "field auxsenx 32 u16\n"
+  "field auxseny 34 u16\n"
+  "field auxsenz 36 u16\n"
+  "field auxsent 38 u16\n"
+  "field adc0 40 u16\n"
+  "field adc1 42 u16\n"
+  "field adc2 44 u16\n"
+  "field adc3 46 u16\n"
+  "record decimated 0x10022 88\n"
+  "field index 8 u64\n"
+  "field mag 16 f64\n"
+  "field field 24 f32\n"
+  "field valid 28 u32\n"
+  "field compassx 32 f32\n"
+  "field compassy 36 f32\n"
+  "field compassz 40 f32\n"
+  "field accelx 44 f32\n"
+  "field accely 48 f32\n"
+  "field accelz 52 f32\n"
+  "field gyrox 56 f32\n"
+  "field gyroy 60 f32\n"
+  "field gyroz 64 f32\n"
+  "field imutemp 68 f32\n"
+  "record heartbeat 0x10023 108\n"
+  "field index 8 u64\n"
+  "field ipaddress 16 u32\n"
+  "field sampleperiod 36 u32\n"
+  "field runningmode 40 u32\n"
+  "field ppsstatus 44 u32\n"
+  "field lastpps 48 u64\n"
+  "field firstpps 56 u64\n"
+  "field supply 64 u16\n"
+  "field leak 66 u16\n"
+  "field auxport 68 u16\n"
+  "field runtime 70 u16\n"
+  "field fpgatemp 72 u16\n"
+  "field boardtemp 74 u16\n"
+  "field faults 76 u32\n";
+
+template <typename T>
+static void DecodeField (const uint8_t *data, uint32_t stride, uint32_t count,
+			 double scale, double *output)
+{
+  for (uint32_t index = 0; index < count; index++)
+    {
+      T value;
+      memcpy (&value, data + (size_t)index * stride, sizeof (value));
+      output[index] = (double)value * scale;
+    }
+}
+
+struct SchemaTypeName
+{
+  const char        *mName;
+  SchemaFieldType    mType;
+  uint32_t           mWidth;
+  SchemaFieldDecoder mDecode;
+};
+
+static const SchemaTypeName sTypeNames[] =
+{
+  { "u8",  SCHEMA_U8,  1, DecodeField<uint8_t> },
+  { "i8",  SCHEMA_I8,  1, DecodeField<int8_t> },
+  { "u16", SCHEMA_U16, 2, DecodeField<uint16_t> },
+  { "i16", SCHEMA_I16, 2, DecodeField<int16_t> },
+  { "u32", SCHEMA_U32, 4, DecodeField<uint32_t> },
+  { "i32", SCHEMA_I32, 4, DecodeField<int32_t> },
+  { "u64", SCHEMA_U64, 8, DecodeField<uint64_t> },
+  { "i64", SCHEMA_I64, 8, DecodeField<int64_t> },
+  { "f32", SCHEMA_F32, 4, DecodeField<float> },
+  { "f64", SCHEMA_F64, 8, DecodeField<double> },
+};
+
+static bool ParseUnsigned (const std::string &text, uint64_t maximum, uint32_t &value)
+{
+  char *end = nullptr;
+  unsigned long long parsed = strtoull (text.c_str (), &end, 0);
+  if (text.empty () || (text[0] == '-') || (*end != '\0') || (parsed > maximum))
+    {
+      return false;
+    }
+  value = (uint32_t)parsed;
+  return true;
+}
+
+void RecordSchema::LoadDefault ()
+{
+  LoadText (sDefaultLayouts, "built-in layouts");
+}
+
+bool RecordSchema::Load (const std::string &fileName)
+{
+  std::ifstream input (fileName);
+  if (!input)
+    {
+      std::cerr << "\n\nError: Layout file " << fileName << " can't be opened\n\n";
+      return false;
+    }
+  std::ostringstream text;
+  text << input.rdbuf ();
+  return LoadText (text.str (), fileName);
+}
+
+bool RecordSchema::LoadText (const std::string &text, const std::string &sourceName)
+{
+  std::vector<SchemaLayout> layouts;
+  std::istringstream input (text);
+  std::string line;
+  int lineNumber = 0;
+  bool repeating = false;
+  uint32_t repeatStride = 0;
+  while (std::getline (input, line))
+    {
+      lineNumber++;
+      size_t comment = line.find ('#');
+      if (comment != std::string::npos)
+	{
+	  line.erase (comment);
+	}
+
+      std::istringstream words (line);
+      std::string keyword;
+      if (!(words >> keyword))
+	{
+	  continue;
+	}
+      std::vector<std::string> arguments;
+      std::string word;
+      while (words >> word)
+	{
+	  arguments.push_back (word);
+	}
+
+      std::string error;
+      if (keyword == "record")
+	{
+	  SchemaLayout layout;
+	  if ((arguments.size () != 3) ||
+	      !ParseUnsigned (arguments[1], UINT32_MAX, layout.mRecordType) ||
+	      !ParseUnsigned (arguments[2], SCHEMA_MAX_RECORD_SIZE, layout.mRecordSize) ||
+	      (layout.mRecordSize < sizeof (RecordHeader)))
+	    {
+	      error = "record must be followed by a name, a record type and a size, 8 to "
+		+ std::to_string (SCHEMA_MAX_RECORD_SIZE);
+	    }
+	  else
+	    {
+	      layout.mName = arguments[0];
+	      layouts.push_back (layout);
+	      repeating = false;
+	    }
+	}
+      else if (layouts.empty ())
+	{
+	  error = keyword + " must come after a record line";
+	}
+      else if (keyword == "repeat")
+	{
+	  SchemaLayout &layout = layouts.back ();
+	  uint32_t count = 0, stride = 0;
+	  if ((arguments.size () != 2) ||
+	      !ParseUnsigned (arguments[0], SCHEMA_MAX_REPEAT, count) || (count < 1) ||
+	      !ParseUnsigned (arguments[1], SCHEMA_MAX_RECORD_SIZE, stride) || (stride < 1))
+	    {
+	      error = "repeat must be followed by a count, 1 to " + std::to_string (SCHEMA_MAX_REPEAT)
+		+ ", and a stride in bytes";
+	    }
+	  else if (repeating)
+	    {
+	      error = "a record may have only one repeat";
+	    }
+	  else
+	    {
+	      layout.mRows = count;
+	      repeating = true;
+	      repeatStride = stride;
+	    }
+	}
+      else if (keyword == "field")
+	{
+	  SchemaLayout &layout = layouts.back ();
+	  SchemaField field;
+	  const SchemaTypeName *type = nullptr;
+	  if (arguments.size () >= 3)
+	    {
+	      for (const SchemaTypeName &candidate : sTypeNames)
+		{
+		  if (arguments[2] == candidate.mName)
+		    {
+		      type = &candidate;
+		    }
+		}
+	    }
+	  char *end = nullptr;
+	  if (arguments.size () == 4)
+	    {
+	      field.mScale = strtod (arguments[3].c_str (), &end);
+	    }
+	  if ((arguments.size () < 3) || (arguments.size () > 4) || (type == nullptr) ||
+	      !ParseUnsigned (arguments[1], SCHEMA_MAX_RECORD_SIZE, field.mOffset) ||
+	      ((end != nullptr) && ((end == arguments[3].c_str ()) || (*end != '\0') || !std::isfinite (field.mScale))))
+	    {
+	      error = "field must be followed by a name, an offset, a type (u8, i8, u16, i16, u32, i32, "
+		"u64, i64, f32 or f64) and optionally a scale";
+	    }
+	  else
+	    {
+	      field.mName = arguments[0];
+	      field.mType = type->mType;
+	      field.mDecode = type->mDecode;
+	      if (repeating)
+		{
+		  field.mCount = layout.mRows;
+		  field.mStride = repeatStride;
+		}
+	      uint64_t last = (uint64_t)field.mOffset + (uint64_t)field.mStride * (field.mCount - 1) + type->mWidth;
+	      if (last > layout.mRecordSize)
+		{
+		  error = "field " + field.mName + " runs past the end of the record";
+		}
+	      for (const SchemaField &other : layout.mFields)
+		{
+		  if (other.mName == field.mName)
+		    {
+		      error = "field " + field.mName + " is already in this record";
+		    }
+		}
+	      layout.mFields.push_back (field);
+	    }
+	}
+      else
+	{
+	  error = "unknown keyword " + keyword;
+	}
+
+      if (!error.empty ())
+	{
+	  std::cerr << "\n\nError: " << sourceName << " line " << lineNumber << ": " << error << "\n\n";
+	  return false;
+	}
+    }
+
+  for (const SchemaLayout &layout : layouts)
+    {
+      const SchemaLayout *existing = FindSlow (layout.mRecordType, layout.mRecordSize);
+      if (existing != nullptr)
+	{
+	  mLayouts[LayoutIndex (existing)] = layout;
+	}
+      else
+	{
+	  mLayouts.push_back (layout);
+	}
+    }
+  return true;
+}
+
+const SchemaLayout *RecordSchema::FindSlow (uint32_t recordType, uint32_t recordSize) const
+{
+  for (size_t index = 0; index < mLayouts.size (); index++)
+    {
+      if ((mLayouts[index].mRecordType == recordType) && (mLayouts[index].mRecordSize == recordSize))
+	{
+	  mLast = index;
+	  return &mLayouts[index];
+	}
+    }
+  return nullptr;
+}
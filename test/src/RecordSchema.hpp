@@ -0,0 +1,135 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORD_SCHEMA_HPP
+#define RECORD_SCHEMA_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* Record layouts described in a text file instead of compiled-in structs,
+   so that one build of this program can decode recordings from several
+   firmware versions.  A layout file has one keyword per line; # starts a
+   comment:
+
+     record <name> <type> <size>           a layout, for records whose header
+					   has this type and size
+     field  <name> <offset> <type> [scale] a field, offset in bytes from the
+					   start of the record; type is
+					   u8, i8, u16, i16, u32, i32, u64,
+					   i64, f32 or f64; value = raw * scale
+     repeat <count> <stride>               the fields that follow, up to the
+					   next record, occur count times,
+					   stride bytes apart
+
+   Several layouts may share a name (one per firmware version), as long
+   as each has its own type and size.  A layout with the same type and
+   size as an earlier one replaces it. */
+
+enum SchemaFieldType
+{
+  SCHEMA_U8, SCHEMA_I8, SCHEMA_U16, SCHEMA_I16, SCHEMA_U32,
+  SCHEMA_I32, SCHEMA_U64, SCHEMA_I64, SCHEMA_F32, SCHEMA_F64
+};
+
+/* Reads count values of one type, stride bytes apart, starting at data,
+   into output as doubles multiplied by scale. */
+typedef void (*SchemaFieldDecoder) (const uint8_t *data, uint32_t stride, uint32_t count,
+				    double scale, double *output);
+
+/* A field, compiled: its decoder is chosen once, when the layout is
+   loaded, so decoding a record is one call per field with no lookups. */
+struct SchemaField
+{
+  std::string        mName;
+  uint32_t           mOffset = 0;    /* Of the first value in the record */
+  uint32_t           mStride = 0;    /* Between repeated values */
+  uint32_t           mCount = 1;     /* 1, or the repeat count */
+  SchemaFieldType    mType = SCHEMA_U8;
+  double             mScale = 1.0;
+  SchemaFieldDecoder mDecode = nullptr;
+
+  /* An integer field with no scale, which prints without a fraction. */
+  bool IsInteger () const { return (mType < SCHEMA_F32) && (mScale == 1.0); }
+};
+
+struct SchemaLayout
+{
+  std::string              mName;
+  uint32_t                 mRecordType = 0;
+  uint32_t                 mRecordSize = 0;
+  uint32_t                 mRows = 1;  /* Repeat count, or 1 */
+  std::vector<SchemaField> mFields;
+};
+
+class RecordSchema
+{
+public:
+  /* \brief Add the layouts of the records this program knows about
+     (1000Hz block, decimated and heartbeat). */
+  void LoadDefault ();
+
+  /* \brief Add the layouts in a layout file.
+     \return  false, with a message on cerr, if the file can't be read or
+     a line is wrong; no layouts are added then. */
+  bool Load (const std::string &fileName);
+
+  /* \brief As Load, from text; sourceName is used in messages. */
+  bool LoadText (const std::string &text, const std::string &sourceName);
+
+  /* \return  The layout for a record with this type and size, or nullptr. */
+  const SchemaLayout *Find (uint32_t recordType, uint32_t recordSize) const
+  {
+    if ((mLast < mLayouts.size ()) && (mLayouts[mLast].mRecordType == recordType) &&
+	(mLayouts[mLast].mRecordSize == recordSize))
+      {
+	return &mLayouts[mLast];
+      }
+    return FindSlow (recordType, recordSize);
+  }
+
+  size_t              LayoutCount () const { return mLayouts.size (); }
+  const SchemaLayout &Layout (size_t index) const { return mLayouts[index]; }
+  size_t              LayoutIndex (const SchemaLayout *layout) const { return layout - mLayouts.data (); }
+
+  /* \brief Decode every field of a record with this layout into values,
+     field by field: the mRows values of field f start at values + f * mRows
+     (a field that is not repeated fills only the first). */
+  static void Decode (const SchemaLayout &layout, const uint8_t *record, double *values)
+  {
+    for (const SchemaField &field : layout.mFields)
+      {
+	field.mDecode (record + field.mOffset, field.mStride, field.mCount, field.mScale, values);
+	values += layout.mRows;
+      }
+  }
+
+private:
+  const SchemaLayout *FindSlow (uint32_t recordType, uint32_t recordSize) const;
+
+  std::vector<SchemaLayout> mLayouts;
+  mutable size_t            mLast = 0;  /* Layout found last time, so Find
+					   is for one thread at a time */
+};
+
+#endif
@@ -0,0 +1,164 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cstring>
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+
+uint32_t RecordSizeForType (const uint32_t recordType)
+{
+  switch (recordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      return sizeof (StreamerPacket);
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      return sizeof (IndexedMagElementDecimatedMagPacketWithHeader);
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      return sizeof (GmMagElementStatusPacket);
+    case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+      return sizeof (GradiometerPacket);
+    case GM_MAG_ELEMENT_CHECKSUM_FORMAT:
+      return sizeof (ChecksumPacket);
+    case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+      return sizeof (MergeSourcePacket);
+    case GM_MAG_ELEMENT_ANOMALY_FORMAT:
+      return sizeof (AnomalyPacket);
+    case GM_MAG_ELEMENT_COMPENSATED_FORMAT:
+      return sizeof (CompensatedPacket);
+    case GM_MAG_ELEMENT_RESAMPLED_FORMAT:
+      return sizeof (ResampledPacket);
+    case GM_MAG_ELEMENT_FIXED_POINT_FORMAT:
+      return sizeof (FixedPointPacket);
+    case GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT:
+      return sizeof (FirDecimatedPacket);
+    default:
+      return 0;
+    }
+}
+
+bool IsValidRecordHeader (const uint8_t *header)
+{
+  RecordHeader test;
+  memcpy (&test, header, sizeof (test));
+  uint32_t expectedSize = RecordSizeForType (test.mRecordType);
+  return (expectedSize != 0) && (expectedSize == test.mRecordSize);
+}
+
+uint64_t GetRecordIndex (const uint8_t *record)
+{
+  /* All three record types carry their 64-bit index at offset 8,
+     immediately after the header. */
+  uint64_t index = 0;
+  memcpy (&index, record + sizeof (RecordHeader), sizeof (index));
+  return index;
+}
+
+uint64_t FindNextRecord (const uint8_t *data,
+			 const uint64_t length,
+			 uint64_t offset)
+{
+  while (offset + sizeof (RecordHeader) <= length)
+    {
+      if (IsValidRecordHeader (data + offset))
+	{
+	  RecordHeader header;
+	  memcpy (&header, data + offset, sizeof (header));
+	  uint64_t next = offset + header.mRecordSize;
+	  if (next == length)
+	    {
+	      return offset;
+	    }
+	  if ((next + sizeof (RecordHeader) <= length) && IsValidRecordHeader (data + next))
+	    {
+	      return offset;
+	    }
+	}
+      offset++;
+    }
+  return length;
+}
+
+size_t SplitRecords (const uint8_t *data,
+		     size_t length,
+		     const RecordCallback &output,
+		     uint64_t &skippedBytes)
+{
+  size_t offset = 0;
+  while (offset + sizeof (RecordHeader) <= length)
+    {
+      if (!IsValidRecordHeader (data + offset))
+	{
+	  offset++;
+	  skippedBytes++;
+	  continue;
+	}
+      RecordHeader header;
+      memcpy (&header, data + offset, sizeof (header));
+      if (header.mRecordSize > length - offset)
+	{
+	  break;
+	}
+      output (data + offset, header.mRecordSize);
+      offset += header.mRecordSize;
+    }
+  return offset;
+}
+
+void RecordStreamSplitter::Add (const uint8_t *data, size_t length, const RecordCallback &output)
+{
+  if (!mPartial.empty ())
+    {
+      /* Complete the record started by an earlier piece, copying no more
+	 than it needs, then carry on in place.  What is held is always
+	 shorter than the header or record it starts. */
+      size_t taken = 0;
+      while (!mPartial.empty () && (taken < length))
+	{
+	  size_t wanted = sizeof (RecordHeader);
+	  if ((mPartial.size () >= sizeof (RecordHeader)) && IsValidRecordHeader (mPartial.data ()))
+	    {
+	      RecordHeader header;
+	      memcpy (&header, mPartial.data (), sizeof (header));
+	      wanted = header.mRecordSize;
+	    }
+	  size_t copy = std::min (wanted - mPartial.size (), length - taken);
+	  mPartial.insert (mPartial.end (), data + taken, data + taken + copy);
+	  taken += copy;
+	  size_t used = SplitRecords (mPartial.data (), mPartial.size (), output, mSkippedBytes);
+	  mPartial.erase (mPartial.begin (), mPartial.begin () + used);
+	}
+      if (!mPartial.empty ())
+	{
+	  return;
+	}
+      data += taken;
+      length -= taken;
+    }
+  size_t used = SplitRecords (data, length, output, mSkippedBytes);
+  mPartial.assign (data + used, data + length);
+}
+
+void RecordStreamSplitter::Reset ()
+{
+  mSkippedBytes += mPartial.size ();
+  mPartial.clear ();
+}
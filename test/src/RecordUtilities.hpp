@@ -0,0 +1,99 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORD_UTILITIES_HPP
+#define RECORD_UTILITIES_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "MagElementData.hpp"
+
+/* Every record from MagElement starts with the same 8-byte header:
+   the record type, then the record size in bytes. */
+PACKED_PRAGMA
+struct PACKED_SPEC RecordHeader
+{
+  uint32_t mRecordType;
+  uint32_t mRecordSize;
+} ALIGN_1_SPEC;
+
+static_assert ((sizeof(RecordHeader) == 8),"Not expected size");
+
+/* Size of the longest record this program knows about. */
+#define MAX_RECORD_LENGTH (sizeof (StreamerPacket))
+
+/* \brief Size in bytes of a record of the given type.
+   \return  0 : The type is not known to this program. */
+uint32_t RecordSizeForType (const uint32_t recordType);
+
+/* \brief True if the 8 bytes at header are a known record type followed by
+   the size of that record type. */
+bool IsValidRecordHeader (const uint8_t *header);
+
+/* \brief The packet index carried by a record: mFirstPacketIndex for 1000Hz
+   blocks and derived records, mIndex for decimated and heartbeat records.
+   The record must have a valid header. */
+uint64_t GetRecordIndex (const uint8_t *record);
+
+/* \brief Find the next record header at or after offset.  A candidate header
+   is accepted only if the record it describes ends exactly at the end of the
+   data, or is followed by another valid header.
+   \return  The offset of the header, or length if none is found. */
+uint64_t FindNextRecord (const uint8_t *data,
+			 const uint64_t length,
+			 uint64_t offset);
+
+typedef std::function<void (const uint8_t *record, uint32_t length)> RecordCallback;
+
+/* \brief Call output for each whole record in data, in order, skipping
+   bytes that don't start a valid record header (adding them to
+   skippedBytes) until one does.
+   \return  The offset of the first byte not used: the start of a record
+   that runs past the end of data, or within 8 bytes of the end. */
+size_t SplitRecords (const uint8_t *data,
+		     size_t length,
+		     const RecordCallback &output,
+		     uint64_t &skippedBytes);
+
+/* Splits a byte stream that arrives in pieces of any size, such as a TCP
+   stream, into whole records.  Only a record split between pieces is
+   copied; the rest are passed on in place. */
+class RecordStreamSplitter
+{
+public:
+  void Add (const uint8_t *data, size_t length, const RecordCallback &output);
+
+  /* \brief Drop a partial record, because the stream lost bytes. */
+  void Reset ();
+
+  uint64_t SkippedBytes () const { return mSkippedBytes; }
+
+  /* Bytes held for a record that the next piece should complete. */
+  size_t   PartialBytes () const { return mPartial.size (); }
+
+private:
+  std::vector<uint8_t> mPartial;
+  uint64_t             mSkippedBytes = 0;
+};
+
+#endif
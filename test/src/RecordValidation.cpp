@@ -0,0 +1,395 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cstring>
+#include "Checksum.hpp"
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "RecordValidation.hpp"
+
+void RecordValidation::AddBlockIndex (uint64_t index)
+{
+  if (!mHaveBlockIndex)
+    {
+      mHaveBlockIndex = true;
+      mFirstBlockIndex = index;
+    }
+  else if (index != mLastBlockIndex + MFAM_STREAMER_CACHE_SIZE)
+    {
+      mGapCount++;
+      if (index > mLastBlockIndex + MFAM_STREAMER_CACHE_SIZE)
+	{
+	  mMissingSamples += index - (mLastBlockIndex + MFAM_STREAMER_CACHE_SIZE);
+	}
+      if (mGaps.size () < VALIDATION_MAX_LISTED)
+	{
+	  mGaps.push_back ({ mLastBlockIndex, index });
+	}
+    }
+  mLastBlockIndex = index;
+}
+
+void RecordValidation::AddUnreadable (uint64_t offset, uint64_t length)
+{
+  mUnreadableBytes += length;
+  /* A range that continues the last one is the same range. */
+  if ((mUnreadableCount > 0) && (mUnreadableEnd == offset))
+    {
+      if (mUnreadable.back ().mOffset + mUnreadable.back ().mLength == offset)
+	{
+	  mUnreadable.back ().mLength += length;
+	}
+      mUnreadableEnd += length;
+      return;
+    }
+  mUnreadableCount++;
+  mUnreadableEnd = offset + length;
+  if (mUnreadable.size () < VALIDATION_MAX_LISTED)
+    {
+      mUnreadable.push_back ({ offset, length });
+    }
+}
+
+void RecordValidation::AddRecord (uint64_t offset, uint64_t length)
+{
+  if (!mRecordRuns.empty () &&
+      (mRecordRuns.back ().mOffset + mRecordRuns.back ().mLength == offset))
+    {
+      mRecordRuns.back ().mLength += length;
+    }
+  else
+    {
+      mRecordRuns.push_back ({ offset, length });
+    }
+}
+
+void RecordValidation::Append (const RecordValidation &next)
+{
+  mBlocks += next.mBlocks;
+  mDecimated += next.mDecimated;
+  mHeartbeats += next.mHeartbeats;
+  mGradiometer += next.mGradiometer;
+  mOtherDerived += next.mOtherDerived;
+
+  if (next.mHaveBlockIndex)
+    {
+      uint64_t nextLast = next.mLastBlockIndex;
+      AddBlockIndex (next.mFirstBlockIndex);
+      mLastBlockIndex = nextLast;
+    }
+  mGapCount += next.mGapCount;
+  mMissingSamples += next.mMissingSamples;
+  for (const IndexGap &gap : next.mGaps)
+    {
+      if (mGaps.size () < VALIDATION_MAX_LISTED)
+	{
+	  mGaps.push_back (gap);
+	}
+    }
+
+  /* A range that crosses from one part into the next is one range. */
+  if (next.mUnreadableCount > 0)
+    {
+      uint64_t count = next.mUnreadableCount;
+      size_t first = 0;
+      if ((mUnreadableCount > 0) && (mUnreadableEnd == next.mUnreadable[0].mOffset))
+	{
+	  if (mUnreadable.back ().mOffset + mUnreadable.back ().mLength == mUnreadableEnd)
+	    {
+	      mUnreadable.back ().mLength += next.mUnreadable[0].mLength;
+	    }
+	  count--;
+	  first = 1;
+	}
+      for (size_t index = first; index < next.mUnreadable.size (); index++)
+	{
+	  if (mUnreadable.size () < VALIDATION_MAX_LISTED)
+	    {
+	      mUnreadable.push_back (next.mUnreadable[index]);
+	    }
+	}
+      mUnreadableCount += count;
+      mUnreadableBytes += next.mUnreadableBytes;
+      mUnreadableEnd = next.mUnreadableEnd;
+    }
+
+  mChecksums += next.mChecksums;
+  mChecksumFailures += next.mChecksumFailures;
+  for (const ByteRange &range : next.mBadChecksums)
+    {
+      if (mBadChecksums.size () < VALIDATION_MAX_LISTED)
+	{
+	  mBadChecksums.push_back (range);
+	}
+    }
+
+  for (const ByteRange &run : next.mRecordRuns)
+    {
+      AddRecord (run.mOffset, run.mLength);
+    }
+  mGoodChecksums.insert (mGoodChecksums.end (), next.mGoodChecksums.begin (), next.mGoodChecksums.end ());
+
+  if (next.mTruncated)
+    {
+      mTruncated = true;
+      mTruncatedTail = next.mTruncatedTail;
+    }
+  mEnd = next.mEnd;
+}
+
+void RecordValidation::Report (std::ostream &output) const
+{
+  output << "  records: " << mBlocks << " 1000Hz blocks, "
+	 << mDecimated << " decimated, "
+	 << mHeartbeats << " heartbeats";
+  if (mGradiometer > 0)
+    {
+      output << ", " << mGradiometer << " gradiometer";
+    }
+  if (mOtherDerived > 0)
+    {
+      output << ", " << mOtherDerived << " other derived";
+    }
+  output << "\n";
+  if (mHaveBlockIndex)
+    {
+      output << "  block index: " << mFirstBlockIndex << " to " << mLastBlockIndex << "\n";
+    }
+  if (mGapCount > 0)
+    {
+      output << "  index gaps: " << mGapCount << ", " << mMissingSamples << " samples missing\n";
+      for (const IndexGap &gap : mGaps)
+	{
+	  output << "    " << gap.mLastIndex << " -> " << gap.mNextIndex << "\n";
+	}
+    }
+  if (mUnreadableCount > 0)
+    {
+      output << "  unreadable: " << mUnreadableCount << " ranges, " << mUnreadableBytes << " bytes\n";
+      for (const ByteRange &range : mUnreadable)
+	{
+	  output << "    offset " << range.mOffset << ", " << range.mLength << " bytes\n";
+	}
+    }
+  if (mChecksums > 0)
+    {
+      output << "  checksums: " << mChecksums << ", " << mChecksumFailures << " failed\n";
+      for (const ByteRange &range : mBadChecksums)
+	{
+	  output << "    offset " << range.mOffset << ", " << range.mLength << " bytes\n";
+	}
+    }
+  if (mTruncated)
+    {
+      output << "  truncated tail: " << mTruncatedTail.mLength << " bytes at offset "
+	     << mTruncatedTail.mOffset << "\n";
+    }
+}
+
+/* Within [offset, next), where next is where the record sequence resumes,
+   look for the start of a record that the end of the file cuts short. */
+static uint64_t FindTruncatedRecord (const uint8_t *data, uint64_t length,
+				     uint64_t offset, uint64_t next)
+{
+  for (; offset + sizeof (RecordHeader) <= next; offset++)
+    {
+      if (IsValidRecordHeader (data + offset))
+	{
+	  RecordHeader header;
+	  memcpy (&header, data + offset, sizeof (header));
+	  if (offset + header.mRecordSize > length)
+	    {
+	      return offset;
+	    }
+	}
+    }
+  return next;
+}
+
+void ValidateRecords (const uint8_t *data, uint64_t length,
+		      uint64_t start, uint64_t end,
+		      RecordValidation &result)
+{
+  result.mBegin = start;
+  uint64_t offset = start;
+  while ((offset < end) && (offset < length))
+    {
+      RecordHeader header;
+      bool valid = (offset + sizeof (header) <= length) && IsValidRecordHeader (data + offset);
+      if (valid)
+	{
+	  memcpy (&header, data + offset, sizeof (header));
+	}
+
+      if (!valid)
+	{
+	  uint64_t next = FindNextRecord (data, length, offset + 1);
+	  if (next == length)
+	    {
+	      uint64_t truncated = FindTruncatedRecord (data, length, offset, next);
+	      if (truncated > offset)
+		{
+		  result.AddUnreadable (offset, truncated - offset);
+		}
+	      if (truncated < length)
+		{
+		  result.mTruncated = true;
+		  result.mTruncatedTail = { truncated, length - truncated };
+		}
+	      offset = length;
+	      break;
+	    }
+	  result.AddUnreadable (offset, next - offset);
+	  offset = next;
+	  continue;
+	}
+
+      if (offset + header.mRecordSize > length)
+	{
+	  result.mTruncated = true;
+	  result.mTruncatedTail = { offset, length - offset };
+	  offset = length;
+	  break;
+	}
+
+      /* A record that isn't followed by another header may have been cut
+	 short by a partial write, with the next record starting inside it. */
+      uint64_t recordEnd = offset + header.mRecordSize;
+      if ((recordEnd + sizeof (RecordHeader) <= length) && !IsValidRecordHeader (data + recordEnd))
+	{
+	  uint64_t next = FindNextRecord (data, length, offset + 1);
+	  if (next < recordEnd)
+	    {
+	      result.AddUnreadable (offset, next - offset);
+	      offset = next;
+	      continue;
+	    }
+	}
+
+      bool isChecksum = false;
+      switch (header.mRecordType)
+	{
+	case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+	  result.mBlocks++;
+	  result.AddBlockIndex (GetRecordIndex (data + offset));
+	  break;
+	case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+	  result.mDecimated++;
+	  break;
+	case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+	  result.mHeartbeats++;
+	  break;
+	case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+	  result.mGradiometer++;
+	  break;
+	case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+	case GM_MAG_ELEMENT_ANOMALY_FORMAT:
+	case GM_MAG_ELEMENT_COMPENSATED_FORMAT:
+	case GM_MAG_ELEMENT_RESAMPLED_FORMAT:
+	case GM_MAG_ELEMENT_FIXED_POINT_FORMAT:
+	case GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT:
+	  result.mOtherDerived++;
+	  break;
+	case GM_MAG_ELEMENT_CHECKSUM_FORMAT:
+	  {
+	    ChecksumPacket packet;
+	    memcpy (&packet, data + offset, sizeof (packet));
+	    isChecksum = true;
+	    result.mChecksums++;
+	    if ((packet.mByteCount <= offset) &&
+		(Crc32c (0, data + offset - packet.mByteCount, packet.mByteCount) == packet.mCrc32c))
+	      {
+		if (result.mCollectRecords)
+		  {
+		    result.mGoodChecksums.push_back (offset);
+		  }
+	      }
+	    else
+	      {
+		result.mChecksumFailures++;
+		if (result.mBadChecksums.size () < VALIDATION_MAX_LISTED)
+		  {
+		    uint64_t covered = std::min<uint64_t> (packet.mByteCount, offset);
+		    result.mBadChecksums.push_back ({ offset - covered, covered });
+		  }
+	      }
+	  }
+	  break;
+	}
+      if (result.mCollectRecords && !isChecksum)
+	{
+	  result.AddRecord (offset, header.mRecordSize);
+	}
+      offset = recordEnd;
+    }
+  result.mEnd = offset;
+}
+
+void ValidateChunk (const uint8_t *data, uint64_t length,
+		    uint64_t chunkBytes, uint32_t chunk,
+		    RecordValidation &result)
+{
+  uint64_t begin = chunk * chunkBytes;
+  uint64_t end = std::min (length, begin + chunkBytes);
+
+  /* The first chunk must start with a record; the others start at the
+     first record that they contain. */
+  uint64_t start = (chunk == 0) ? 0 : FindNextRecord (data, length, begin);
+  if (start >= end)
+    {
+      result.mBegin = result.mEnd = start;
+    }
+  else
+    {
+      ValidateRecords (data, length, start, end, result);
+    }
+}
+
+/* A chunk is walked from the first record header found after its start;
+   if the walk of the chunks before it didn't stop at that same place, that
+   header was false, or the walk had to skip past it, so the chunk is
+   walked again from where the walk before it stopped. */
+void JoinChunks (const uint8_t *data, uint64_t length, uint64_t chunkBytes,
+		 const std::vector<RecordValidation> &chunks,
+		 RecordValidation &result)
+{
+  result = chunks[0];
+  for (size_t chunk = 1; chunk < chunks.size (); chunk++)
+    {
+      uint64_t chunkEnd = std::min (length, (chunk + 1) * chunkBytes);
+      if (result.mEnd >= chunkEnd)
+	{
+	  continue;
+	}
+      if (chunks[chunk].mBegin == result.mEnd)
+	{
+	  result.Append (chunks[chunk]);
+	}
+      else
+	{
+	  RecordValidation again;
+	  again.mCollectRecords = result.mCollectRecords;
+	  ValidateRecords (data, length, result.mEnd, chunkEnd, again);
+	  result.Append (again);
+	}
+    }
+}
@@ -0,0 +1,131 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORD_VALIDATION_HPP
+#define RECORD_VALIDATION_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+
+/* Only the first few gaps and unreadable ranges of a file are kept for
+   the report; all of them are counted. */
+#define VALIDATION_MAX_LISTED 10
+
+struct ByteRange
+{
+  uint64_t mOffset;
+  uint64_t mLength;
+};
+
+struct IndexGap
+{
+  uint64_t mLastIndex;   /* mFirstPacketIndex of the block before the gap */
+  uint64_t mNextIndex;   /* ... and of the block after it */
+};
+
+/* What a walk over part or all of a recording found.  Results for
+   consecutive parts of one file can be joined with Append(). */
+struct RecordValidation
+{
+  uint64_t               mBegin = 0;             /* Where the walk started */
+  uint64_t               mEnd = 0;               /* Where it stopped: a record start, or the file end */
+
+  uint64_t               mBlocks = 0;            /* 1000Hz blocks */
+  uint64_t               mDecimated = 0;
+  uint64_t               mHeartbeats = 0;
+  uint64_t               mGradiometer = 0;
+  uint64_t               mOtherDerived = 0;      /* Other records derived by this program */
+
+  /* The 1000Hz block index should rise by 40 from block to block. */
+  bool                   mHaveBlockIndex = false;
+  uint64_t               mFirstBlockIndex = 0;
+  uint64_t               mLastBlockIndex = 0;
+  uint64_t               mGapCount = 0;
+  uint64_t               mMissingSamples = 0;
+  std::vector<IndexGap>  mGaps;
+
+  /* Bytes that are not part of any record */
+  uint64_t               mUnreadableCount = 0;
+  uint64_t               mUnreadableBytes = 0;
+  uint64_t               mUnreadableEnd = 0;     /* End of the last range, listed or not */
+  std::vector<ByteRange> mUnreadable;
+
+  /* Checksum records (-checksum), each checked against the bytes it covers */
+  uint64_t               mChecksums = 0;
+  uint64_t               mChecksumFailures = 0;
+  std::vector<ByteRange> mBadChecksums;          /* Bytes covered by failed checksums */
+
+  /* Where the good records are, kept only if mCollectRecords is set
+     before the walk (-proto salvage).  Checksum records are left out of
+     the runs; those that matched are listed separately. */
+  bool                   mCollectRecords = false;
+  std::vector<ByteRange> mRecordRuns;            /* Runs of consecutive records */
+  std::vector<uint64_t>  mGoodChecksums;         /* Offsets of matching checksum records */
+
+  /* A record cut short by the end of the file */
+  bool                   mTruncated = false;
+  ByteRange              mTruncatedTail = { 0, 0 };
+
+  uint64_t Records () const { return mBlocks + mDecimated + mHeartbeats + mGradiometer + mOtherDerived; }
+  bool     Clean () const
+  {
+    return (mGapCount == 0) && (mUnreadableCount == 0) && !mTruncated && (mChecksumFailures == 0);
+  }
+
+  void     AddBlockIndex (uint64_t index);
+  void     AddUnreadable (uint64_t offset, uint64_t length);
+  void     AddRecord (uint64_t offset, uint64_t length);
+
+  /* \brief Add the results for the part of the file that follows this one. */
+  void     Append (const RecordValidation &next);
+
+  void     Report (std::ostream &output) const;
+};
+
+/* \brief Walk the records of data[0, length) that start in [start, end),
+   beginning with a record header expected at start.  The walk stops at
+   the first record that starts at or after end, or at the end of the
+   data.  Unrecognized bytes are skipped, and recorded as unreadable,
+   up to the next point where the record sequence resumes; so is a
+   record whose header is not followed by another, if a confirmed record
+   header lies inside it (a record cut short by a partial write).
+   Checksum records are checked against the data before them, which may
+   lie before start. */
+void ValidateRecords (const uint8_t *data, uint64_t length,
+		      uint64_t start, uint64_t end,
+		      RecordValidation &result);
+
+/* \brief Walk one of the chunkBytes-long pieces into which data is split
+   for parallel checking: from the first record header in the chunk (or
+   from 0 for chunk 0) to the first record that starts after it. */
+void ValidateChunk (const uint8_t *data, uint64_t length,
+		    uint64_t chunkBytes, uint32_t chunk,
+		    RecordValidation &result);
+
+/* \brief Join the results of ValidateChunk for every chunk of data, in
+   order, walking a chunk again where the walk of the ones before it did
+   not stop at the header it started from. */
+void JoinChunks (const uint8_t *data, uint64_t length, uint64_t chunkBytes,
+		 const std::vector<RecordValidation> &chunks,
+		 RecordValidation &result);
+
+#endif
@@ -0,0 +1,247 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "RecordUtilities.hpp"
+#include "RecordingReader.hpp"
+
+static bool ByIndex (const RecordLocation &left, const RecordLocation &right)
+{
+  return left.mIndex < right.mIndex;
+}
+
+bool RecordingReader::Open (const std::string &fileName)
+{
+  Close ();
+  if (!mFile.Open (fileName))
+    {
+      return false;
+    }
+  mFile.AdviseSequential ();
+
+  const uint8_t *data = mFile.Data ();
+  uint64_t size = mFile.Size ();
+  uint64_t offset = 0;
+  while (offset + sizeof (RecordHeader) <= size)
+    {
+      if (!IsValidRecordHeader (data + offset))
+	{
+	  uint64_t next = FindNextRecord (data, size, offset + 1);
+	  mUnreadableBytes += next - offset;
+	  offset = next;
+	  continue;
+	}
+      RecordHeader header;
+      memcpy (&header, data + offset, sizeof (header));
+      if (offset + header.mRecordSize > size)
+	{
+	  break;
+	}
+      RecordLocation location { GetRecordIndex (data + offset), offset };
+      switch (header.mRecordType)
+	{
+	case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+	  mBlocks.push_back (location);
+	  break;
+	case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+	  mDecimated.push_back (location);
+	  break;
+	case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+	  mHeartbeats.push_back (location);
+	  break;
+	case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+	  mGradiometer.push_back (location);
+	  break;
+	}
+      offset += header.mRecordSize;
+    }
+  mUnreadableBytes += size - offset;
+
+  /* Recordings are written in index order, so this normally finds
+     nothing to do. */
+  for (std::vector<RecordLocation> *locations : { &mBlocks, &mDecimated, &mHeartbeats, &mGradiometer })
+    {
+      if (!std::is_sorted (locations->begin (), locations->end (), ByIndex))
+	{
+	  std::stable_sort (locations->begin (), locations->end (), ByIndex);
+	}
+    }
+  return true;
+}
+
+void RecordingReader::Close ()
+{
+  mFile.Close ();
+  mBlocks.clear ();
+  mDecimated.clear ();
+  mHeartbeats.clear ();
+  mGradiometer.clear ();
+  mUnreadableBytes = 0;
+}
+
+uint64_t RecordingReader::FirstIndex () const
+{
+  return mBlocks.empty () ? 0 : mBlocks.front ().mIndex;
+}
+
+uint64_t RecordingReader::EndIndex () const
+{
+  return mBlocks.empty () ? 0 : mBlocks.back ().mIndex + MFAM_STREAMER_CACHE_SIZE;
+}
+
+template <typename Visit>
+uint64_t RecordingReader::ForEachSlice (uint64_t first, uint64_t end, Visit visit) const
+{
+  /* The first block that can hold sample first starts after
+     first - MFAM_STREAMER_CACHE_SIZE. */
+  auto block = std::lower_bound (mBlocks.begin (), mBlocks.end (), first,
+				 [] (const RecordLocation &location, uint64_t index)
+				 {
+				   return location.mIndex + MFAM_STREAMER_CACHE_SIZE <= index;
+				 });
+  uint64_t found = 0;
+  for (; (block != mBlocks.end ()) && (block->mIndex < end); block++)
+    {
+      uint64_t low = std::max (first, block->mIndex);
+      uint64_t high = std::min (end, block->mIndex + MFAM_STREAMER_CACHE_SIZE);
+      if (low >= high)
+	{
+	  continue;
+	}
+      BlockSlice slice;
+      slice.mBlock = (const StreamerPacket *)(mFile.Data () + block->mOffset);
+      slice.mFirstIndex = low;
+      slice.mFirstSample = (uint32_t)(low - block->mIndex);
+      slice.mCount = (uint32_t)(high - low);
+      visit (slice);
+      found += slice.mCount;
+    }
+  return found;
+}
+
+uint64_t RecordingReader::Slices (uint64_t first, uint64_t end, std::vector<BlockSlice> &slices) const
+{
+  slices.clear ();
+  return ForEachSlice (first, end, [&slices] (const BlockSlice &slice) { slices.push_back (slice); });
+}
+
+uint64_t RecordingReader::ReadMag (uint64_t first, uint64_t count,
+				   uint32_t *mag1, uint32_t *mag2, uint8_t *valid) const
+{
+  if (mag1 != nullptr)
+    {
+      std::fill (mag1, mag1 + count, 0);
+    }
+  if (mag2 != nullptr)
+    {
+      std::fill (mag2, mag2 + count, 0);
+    }
+  if (valid != nullptr)
+    {
+      std::fill (valid, valid + count, 0);
+    }
+  return ForEachSlice (first, first + count, [&] (const BlockSlice &slice)
+    {
+      StridedSpan<uint32_t> mag1Span = slice.Mag1 ();
+      StridedSpan<uint32_t> mag2Span = slice.Mag2 ();
+      uint64_t position = slice.mFirstIndex - first;
+      for (uint32_t sample = 0; sample < slice.mCount; sample++, position++)
+	{
+	  uint8_t flags = 0;
+	  if (slice.Mag1Valid (sample))
+	    {
+	      flags |= 1;
+	      if (mag1 != nullptr)
+		{
+		  mag1[position] = mag1Span[sample];
+		}
+	    }
+	  if (slice.Mag2Valid (sample))
+	    {
+	      flags |= 2;
+	      if (mag2 != nullptr)
+		{
+		  mag2[position] = mag2Span[sample];
+		}
+	    }
+	  if (valid != nullptr)
+	    {
+	      valid[position] = flags;
+	    }
+	}
+    });
+}
+
+uint64_t RecordingReader::ReadMag (uint64_t first, uint64_t count, double *mag1, double *mag2) const
+{
+  const double missing = std::numeric_limits<double>::quiet_NaN ();
+  if (mag1 != nullptr)
+    {
+      std::fill (mag1, mag1 + count, missing);
+    }
+  if (mag2 != nullptr)
+    {
+      std::fill (mag2, mag2 + count, missing);
+    }
+  return ForEachSlice (first, first + count, [&] (const BlockSlice &slice)
+    {
+      StridedSpan<uint32_t> mag1Span = slice.Mag1 ();
+      StridedSpan<uint32_t> mag2Span = slice.Mag2 ();
+      uint64_t position = slice.mFirstIndex - first;
+      for (uint32_t sample = 0; sample < slice.mCount; sample++, position++)
+	{
+	  if ((mag1 != nullptr) && slice.Mag1Valid (sample))
+	    {
+	      mag1[position] = mag1Span[sample] * MFAM_NANOTESLAS_PER_LSB;
+	    }
+	  if ((mag2 != nullptr) && slice.Mag2Valid (sample))
+	    {
+	      mag2[position] = mag2Span[sample] * MFAM_NANOTESLAS_PER_LSB;
+	    }
+	}
+    });
+}
+
+RecordRange RecordingReader::Range (const std::vector<RecordLocation> &locations,
+				    uint64_t first, uint64_t end) const
+{
+  auto begin = std::lower_bound (locations.begin (), locations.end (), RecordLocation { first, 0 }, ByIndex);
+  auto stop = std::lower_bound (begin, locations.end (), RecordLocation { end, 0 }, ByIndex);
+  const RecordLocation *base = locations.data ();
+  return RecordRange (mFile.Data (), base + (begin - locations.begin ()), base + (stop - locations.begin ()));
+}
+
+RecordRange RecordingReader::Decimated (uint64_t first, uint64_t end) const
+{
+  return Range (mDecimated, first, end);
+}
+
+RecordRange RecordingReader::Heartbeats (uint64_t first, uint64_t end) const
+{
+  return Range (mHeartbeats, first, end);
+}
+
+RecordRange RecordingReader::Gradiometer (uint64_t first, uint64_t end) const
+{
+  return Range (mGradiometer, first, end);
+}
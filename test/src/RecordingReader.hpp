@@ -0,0 +1,203 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RECORDING_READER_HPP
+#define RECORDING_READER_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "DerivedRecords.hpp"
+#include "MagElementData.hpp"
+#include "MappedFile.hpp"
+
+/* One field of consecutive packed records, read in place: element i is at
+   Data() + i * Stride().  Values are loaded with memcpy, because fields in
+   packed records need not be aligned. */
+template <typename T>
+class StridedSpan
+{
+public:
+  StridedSpan () = default;
+  StridedSpan (const uint8_t *base, size_t stride, size_t count)
+    : mBase (base), mStride (stride), mCount (count) {}
+
+  T operator[] (size_t index) const
+  {
+    T value;
+    memcpy (&value, mBase + index * mStride, sizeof (value));
+    return value;
+  }
+
+  const uint8_t *Data () const { return mBase; }
+  size_t         Stride () const { return mStride; }
+  size_t         Size () const { return mCount; }
+
+private:
+  const uint8_t *mBase = nullptr;
+  size_t         mStride = 0;
+  size_t         mCount = 0;
+};
+
+/* The samples of one 1000Hz block that fall in a requested index range.
+   The spans point into the mapped recording; nothing is copied. */
+struct BlockSlice
+{
+  const StreamerPacket *mBlock = nullptr;
+  uint64_t mFirstIndex = 0;     /* Packet index of the first sample in the slice */
+  uint32_t mFirstSample = 0;    /* Position of that sample in the block */
+  uint32_t mCount = 0;
+
+  StridedSpan<uint32_t> Mag1 () const { return Field<uint32_t> (offsetof (MfamSpiPacket, mag1data)); }
+  StridedSpan<uint32_t> Mag2 () const { return Field<uint32_t> (offsetof (MfamSpiPacket, mag2data)); }
+  StridedSpan<uint16_t> FrameId () const { return Field<uint16_t> (offsetof (MfamSpiPacket, frameid)); }
+  StridedSpan<uint16_t> SysStat () const { return Field<uint16_t> (offsetof (MfamSpiPacket, sysstat)); }
+  StridedSpan<uint16_t> Mag1Stat () const { return Field<uint16_t> (offsetof (MfamSpiPacket, mag1stat)); }
+  StridedSpan<uint16_t> Mag2Stat () const { return Field<uint16_t> (offsetof (MfamSpiPacket, mag2stat)); }
+
+  /* Valid and not in the dead zone, as in DecodeRawBlock. */
+  bool Mag1Valid (uint32_t sample) const
+  {
+    return IS_MAG1_VALID (FrameId ()[sample]) && !IS_DEAD_ZONE (Mag1Stat ()[sample]);
+  }
+  bool Mag2Valid (uint32_t sample) const
+  {
+    return IS_MAG2_VALID (FrameId ()[sample]) && !IS_DEAD_ZONE (Mag2Stat ()[sample]);
+  }
+
+private:
+  template <typename T>
+  StridedSpan<T> Field (size_t offset) const
+  {
+    return StridedSpan<T> ((const uint8_t *)&mBlock->mDataBlock[mFirstSample].mMagData + offset,
+			   sizeof (MfamPlusAnalogQuad), mCount);
+  }
+};
+
+/* Where a record of one type lies in the recording. */
+struct RecordLocation
+{
+  uint64_t mIndex;    /* Packet index carried by the record */
+  uint64_t mOffset;   /* Byte offset of the record header */
+};
+
+/* The records of one type whose index falls in a requested range, in index
+   order; use with range-based for.  The iterator yields the address of
+   each record header in the mapping.  Records are packed and may sit at
+   any offset, so copy one out with Read() before using its fields. */
+class RecordRange
+{
+public:
+  class Iterator
+  {
+  public:
+    Iterator (const uint8_t *data, const RecordLocation *location)
+      : mData (data), mLocation (location) {}
+    const uint8_t *operator* () const { return mData + mLocation->mOffset; }
+    Iterator &operator++ () { mLocation++; return *this; }
+    bool operator!= (const Iterator &other) const { return mLocation != other.mLocation; }
+  private:
+    const uint8_t        *mData;
+    const RecordLocation *mLocation;
+  };
+
+  RecordRange (const uint8_t *data, const RecordLocation *begin, const RecordLocation *end)
+    : mData (data), mBegin (begin), mEnd (end) {}
+
+  Iterator begin () const { return Iterator (mData, mBegin); }
+  Iterator end () const { return Iterator (mData, mEnd); }
+  size_t   Size () const { return mEnd - mBegin; }
+
+  /* \brief Copy the first size bytes of record i into record. */
+  void     Read (size_t i, void *record, size_t size) const
+  { memcpy (record, mData + mBegin[i].mOffset, size); }
+
+private:
+  const uint8_t        *mData;
+  const RecordLocation *mBegin;
+  const RecordLocation *mEnd;
+};
+
+/* Random access to a recording by packet index.  Open() maps the file and
+   builds an index of every record by walking the headers once (skipping
+   over damaged stretches the way file-check does); after that a range is
+   found by binary search and read straight from the mapping.
+
+   Index ranges are half-open, [first, end).  If the instrument restarted
+   during the recording and indices repeat, records are ordered by index
+   and, for equal indices, by position in the file. */
+class RecordingReader
+{
+public:
+  bool Open (const std::string &fileName);
+  void Close ();
+  bool IsOpen () const { return mFile.IsOpen (); }
+
+  /* The raw samples in the recording run from FirstIndex() up to, but
+     not including, EndIndex(); there may be gaps in between. */
+  uint64_t FirstIndex () const;
+  uint64_t EndIndex () const;
+
+  size_t   BlockCount () const { return mBlocks.size (); }
+  size_t   DecimatedCount () const { return mDecimated.size (); }
+  size_t   HeartbeatCount () const { return mHeartbeats.size (); }
+  size_t   GradiometerCount () const { return mGradiometer.size (); }
+  uint64_t UnreadableBytes () const { return mUnreadableBytes; }
+
+  /* \brief The parts of 1000Hz blocks that hold samples first ... end - 1,
+     in index order, replacing the contents of slices.
+     \return  The number of samples found. */
+  uint64_t Slices (uint64_t first, uint64_t end, std::vector<BlockSlice> &slices) const;
+
+  /* \brief Copy mag1 and mag2 for samples first ... first + count - 1
+     straight from the mapping into the caller's arrays, of count entries
+     each; any of them may be nullptr.  Values are in LSBs.  Bit 0 of
+     valid[i] is set if mag1 is valid and outside the dead zone, bit 1 the
+     same for mag2; mag values without their bit, and samples missing from
+     the recording, are 0.
+     \return  The number of samples found in the recording. */
+  uint64_t ReadMag (uint64_t first, uint64_t count,
+		    uint32_t *mag1, uint32_t *mag2, uint8_t *valid) const;
+
+  /* \brief As above, in nT, with NaN for invalid and missing samples. */
+  uint64_t ReadMag (uint64_t first, uint64_t count, double *mag1, double *mag2) const;
+
+  /* Records whose index is in [first, end). */
+  RecordRange Decimated (uint64_t first, uint64_t end) const;
+  RecordRange Heartbeats (uint64_t first, uint64_t end) const;
+  RecordRange Gradiometer (uint64_t first, uint64_t end) const;
+
+private:
+  RecordRange Range (const std::vector<RecordLocation> &locations, uint64_t first, uint64_t end) const;
+  template <typename Visit>
+  uint64_t ForEachSlice (uint64_t first, uint64_t end, Visit visit) const;
+
+  MappedFile                  mFile;
+  std::vector<RecordLocation> mBlocks;
+  std::vector<RecordLocation> mDecimated;
+  std::vector<RecordLocation> mHeartbeats;
+  std::vector<RecordLocation> mGradiometer;
+  uint64_t                    mUnreadableBytes = 0;
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include "RecordUtilities.hpp"
+#include "ReorderWindow.hpp"
+
+ReorderWindow::ReorderWindow (uint32_t slots, double holdMs, RecordOutput output)
+  : mOutput (output)
+{
+  uint64_t size = 1;
+  while (size < slots)
+    {
+      size <<= 1;
+    }
+  mSlots.resize (size);
+  mMask = size - 1;
+  mHold = std::chrono::duration_cast<Clock::duration> (std::chrono::duration<double, std::milli> (holdMs));
+}
+
+void ReorderWindow::Add (const RecordRef &record, Clock::time_point now)
+{
+  switch (((const RecordHeader *)record.Data ())->mRecordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      AddBlock (record, GetRecordIndex (record.Data ()) / MFAM_STREAMER_CACHE_SIZE, now);
+      break;
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      AddOther (record, mLastDecimated, mDecimatedSeen);
+      break;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      AddOther (record, mLastHeartbeat, mHeartbeatSeen);
+      break;
+    default:
+      mOutput (record);
+      break;
+    }
+}
+
+void ReorderWindow::AddOther (const RecordRef &record, uint64_t &lastIndex, bool &seen)
+{
+  uint64_t index = GetRecordIndex (record.Data ());
+  if (seen && (index == lastIndex))
+    {
+      mDuplicates++;
+      return;
+    }
+  if (!seen || (index > lastIndex) ||
+      (lastIndex - index > (uint64_t)REORDER_RESTART_BLOCKS * MFAM_STREAMER_CACHE_SIZE))
+    {
+      lastIndex = index;
+    }
+  else
+    {
+      mLate++;
+    }
+  seen = true;
+  mOutput (record);
+}
+
+void ReorderWindow::AddBlock (const RecordRef &record, uint64_t sequence, Clock::time_point now)
+{
+  if (!mStarted)
+    {
+      mStarted = true;
+      mNext = sequence;
+    }
+
+  if (sequence < mNext)
+    {
+      if (mNext - sequence <= REORDER_RESTART_BLOCKS)
+	{
+	  /* Its place has gone: either it was passed on already, or it was
+	     given up on. */
+	  const Slot &slot = SlotFor (sequence);
+	  if ((mNext - sequence <= mSlots.size ()) && slot.mUsed && (slot.mSequence == sequence))
+	    {
+	      mDuplicates++;
+	    }
+	  else
+	    {
+	      mLate++;
+	    }
+	  return;
+	}
+      Restart (sequence);
+    }
+  else if (sequence - mNext > REORDER_RESTART_BLOCKS)
+    {
+      Restart (sequence);
+    }
+
+  /* Beyond the end of the window: make room by giving up on the oldest
+     missing blocks, or on the whole window if the jump is a long one. */
+  if (sequence - mNext >= 2 * mSlots.size ())
+    {
+      Flush ();
+      mLost += sequence - mNext;
+      mNext = sequence;
+    }
+  while (sequence - mNext >= mSlots.size ())
+    {
+      Advance ();
+    }
+
+  Slot &slot = SlotFor (sequence);
+  if (slot.mRecord && (slot.mSequence == sequence))
+    {
+      mDuplicates++;
+      return;
+    }
+  if (sequence != mNext)
+    {
+      mReordered++;
+      if (mHeld == 0)
+	{
+	  mGapSince = now;
+	}
+    }
+  slot.mRecord = record;
+  slot.mSequence = sequence;
+  slot.mUsed = true;
+  mHeld++;
+  DeliverReady (now);
+}
+
+/* Pass on the blocks that follow on from the last one passed on, and give
+   up on a gap that has been waited on for too long. */
+void ReorderWindow::DeliverReady (Clock::time_point now)
+{
+  while (mHeld > 0)
+    {
+      const Slot &slot = SlotFor (mNext);
+      if (slot.mRecord && (slot.mSequence == mNext))
+	{
+	  Advance ();
+	  mGapSince = now;
+	}
+      else if (now - mGapSince >= mHold)
+	{
+	  Advance ();
+	}
+      else
+	{
+	  break;
+	}
+    }
+}
+
+/* Move on by one block: pass it on if it is here, else count it lost. */
+void ReorderWindow::Advance ()
+{
+  Slot &slot = SlotFor (mNext);
+  if (slot.mRecord && (slot.mSequence == mNext))
+    {
+      mOutput (slot.mRecord);
+      slot.mRecord.Reset ();
+      mHeld--;
+    }
+  else
+    {
+      mLost++;
+    }
+  mNext++;
+}
+
+void ReorderWindow::Restart (uint64_t sequence)
+{
+  Flush ();
+  mRestarts++;
+  mNext = sequence;
+}
+
+void ReorderWindow::Flush ()
+{
+  while (mHeld > 0)
+    {
+      Advance ();
+    }
+}
+
+void ReorderWindow::Report (std::ostream &output) const
+{
+  output << "Reorder (" << mSlots.size () << " blocks, "
+	 << std::chrono::duration<double, std::milli> (mHold).count () << " ms): "
+	 << mReordered << " blocks out of order, " << mLost << " lost, " << mLate << " late, "
+	 << mDuplicates << " duplicate records";
+  if (mRestarts > 0)
+    {
+      output << ", " << mRestarts << " restarts";
+    }
+  output << "\n";
+}
@@ -0,0 +1,116 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef REORDER_WINDOW_HPP
+#define REORDER_WINDOW_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include "RecordPool.hpp"
+
+/* Puts the records received over UDP back into packet index order.
+
+   1000Hz blocks, which follow one another every MFAM_STREAMER_CACHE_SIZE
+   indices, are held in a ring of slots keyed on mFirstPacketIndex: a
+   block that arrives ahead of a missing one waits in its slot until the
+   missing one comes, or until the oldest gap is older than the hold
+   latency, when the missing blocks are counted as lost and the stream
+   moves on.  The latency of a gap is timed from when the stream last
+   moved, and checked as datagrams arrive, so a block may wait longer if
+   the instrument stops sending.  A block that arrives after its
+   place was given up is late, and is dropped; one that arrives twice is
+   a duplicate, and is dropped.  A jump in index of more than
+   REORDER_RESTART_BLOCKS blocks, either way, is taken to be a restart of
+   the instrument rather than loss.
+
+   Decimated and heartbeat records have no fixed index step, so they are
+   passed on as they arrive; those that repeat the index of the one
+   before are dropped as duplicates, and those with a lower index are
+   counted as late.
+
+   The ring is allocated once, when the window is made; after that each
+   record costs O(1), and skipping a gap O(1) per missing block. */
+#define REORDER_RESTART_BLOCKS (1 << 24)
+
+class ReorderWindow
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<void (const RecordRef &record)> RecordOutput;
+
+  /* \param slots    Blocks that can be held; rounded up to a power of two.
+     \param holdMs   Longest that a gap in the blocks is waited for. */
+  ReorderWindow (uint32_t slots, double holdMs, RecordOutput output);
+
+  /* \brief Take a record with a valid header, received at now. */
+  void Add (const RecordRef &record, Clock::time_point now);
+
+  /* \brief Pass on everything held, in order; when the input ends. */
+  void Flush ();
+
+  void Report (std::ostream &output) const;
+
+  uint64_t Reordered () const { return mReordered; }
+  uint64_t Late () const { return mLate; }
+  uint64_t Duplicates () const { return mDuplicates; }
+  uint64_t Lost () const { return mLost; }
+
+private:
+  struct Slot
+  {
+    RecordRef mRecord;
+    uint64_t  mSequence = 0;      /* Block number held, or last held, in this slot */
+    bool      mUsed = false;      /* mSequence has been seen */
+  };
+
+  void  AddBlock (const RecordRef &record, uint64_t sequence, Clock::time_point now);
+  void  AddOther (const RecordRef &record, uint64_t &lastIndex, bool &seen);
+  void  Advance ();
+  void  Restart (uint64_t sequence);
+  void  DeliverReady (Clock::time_point now);
+  Slot &SlotFor (uint64_t sequence) { return mSlots[sequence & mMask]; }
+
+  std::vector<Slot>  mSlots;
+  uint64_t           mMask;
+  Clock::duration    mHold;
+  RecordOutput       mOutput;
+
+  bool               mStarted = false;
+  uint64_t           mNext = 0;           /* Next block number to pass on */
+  uint32_t           mHeld = 0;           /* Blocks waiting in the ring */
+  Clock::time_point  mGapSince;           /* When the gap at mNext began to be waited on */
+
+  uint64_t           mLastDecimated = 0;
+  bool               mDecimatedSeen = false;
+  uint64_t           mLastHeartbeat = 0;
+  bool               mHeartbeatSeen = false;
+
+  uint64_t           mReordered = 0;      /* Blocks that arrived ahead of a missing one */
+  uint64_t           mLate = 0;
+  uint64_t           mDuplicates = 0;
+  uint64_t           mLost = 0;           /* Blocks given up on */
+  uint64_t           mRestarts = 0;
+};
+
+#endif
@@ -0,0 +1,346 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "MagElementData.hpp"
+#include "DerivedRecords.hpp"
+#include "MappedFile.hpp"
+#include "RecordUtilities.hpp"
+#include "TestClient.hpp"
+#include "Replay.hpp"
+
+using namespace std;
+using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
+
+/* TCP output is gathered into writes of about this many bytes when
+   no pacing delay separates the records. */
+#define REPLAY_TCP_BATCH_BYTES (64 * 1024)
+
+/* A jump in packet index of more than this many seconds (a gap in the
+   recording, or a restart of the instrument) re-anchors the replay clock
+   instead of sleeping through the gap. */
+#define REPLAY_MAX_GAP_SECONDS 5.0
+
+/* Fixed seed, so that a replay with loss and jitter injection can itself
+   be reproduced. */
+#define REPLAY_RANDOM_SEED 1
+
+typedef std::chrono::steady_clock ReplayClock;
+
+/* Decides when each record is to be sent. */
+class ReplaySchedule
+{
+public:
+  ReplaySchedule (double rate, double jitterMs)
+    : mRate (rate), mJitterMs (jitterMs), mRandom (REPLAY_RANDOM_SEED),
+      mJitter (0.0, jitterMs) {}
+
+  /* Heartbeats report the sample period; use it to convert indices to time. */
+  void SetSamplePeriod (uint32_t periodMs)
+  {
+    if ((periodMs > 0) && (periodMs <= 1000))
+      {
+	mSecondsPerIndex = periodMs / 1000.0;
+      }
+  }
+
+  /* Time at which a 1000Hz block with this first packet index should be sent. */
+  ReplayClock::time_point DueTime (uint64_t packetIndex)
+  {
+    ReplayClock::time_point now = ReplayClock::now ();
+    if (!mAnchored)
+      {
+	Anchor (packetIndex, now);
+      }
+    double elapsed = ((double)packetIndex - (double)mAnchorIndex) * mSecondsPerIndex;
+    if ((elapsed < 0.0) || (elapsed - mLastElapsed > REPLAY_MAX_GAP_SECONDS))
+      {
+	Anchor (packetIndex, now);
+	elapsed = 0.0;
+      }
+    mLastElapsed = elapsed;
+    double delay = elapsed / mRate;
+    if (mJitterMs > 0.0)
+      {
+	delay += mJitter (mRandom) / 1000.0;
+      }
+    return mAnchorTime + std::chrono::duration_cast<ReplayClock::duration>
+      (std::chrono::duration<double> (delay));
+  }
+
+  bool IsPaced () const { return mRate > 0.0; }
+
+private:
+  void Anchor (uint64_t packetIndex, ReplayClock::time_point now)
+  {
+    mAnchored = true;
+    mAnchorIndex = packetIndex;
+    mAnchorTime = now;
+    mLastElapsed = 0.0;
+  }
+
+  double                  mRate;
+  double                  mJitterMs;
+  double                  mSecondsPerIndex = 0.001;
+  bool                    mAnchored = false;
+  uint64_t                mAnchorIndex = 0;
+  double                  mLastElapsed = 0.0;
+  ReplayClock::time_point mAnchorTime;
+  std::mt19937_64         mRandom;
+  std::uniform_real_distribution<double> mJitter;
+};
+
+/* Statistics printed at the end of a replay. */
+struct ReplayCounts
+{
+  uint64_t mRecordsSent = 0;
+  uint64_t mRecordsDropped = 0;
+  uint64_t mBytesSent = 0;
+  uint64_t mBytesSkipped = 0;
+};
+
+/* Walk the recording and hand each record, at its due time, to send().
+   send() returns false if the connection has failed. */
+template <typename SendFunction, typename FlushFunction>
+static void ReplayRecords (const MappedFile &recording,
+			   MagElementTestOptions &options,
+			   ReplayCounts &counts,
+			   SendFunction send,
+			   FlushFunction flush)
+{
+  ReplaySchedule schedule (options.mReplayRate, options.mReplayJitterMs);
+  std::mt19937_64 random (REPLAY_RANDOM_SEED + 1);
+  std::bernoulli_distribution lose (options.mReplayLossPercent / 100.0);
+  bool injectLoss = options.mReplayLossPercent > 0.0;
+
+  const uint8_t *data = recording.Data ();
+  uint64_t length = recording.Size ();
+  uint64_t offset = 0;
+
+  while (offset < length)
+    {
+      if (ShutdownRequested ())
+	{
+	  break;
+	}
+
+      /* Skip anything that isn't a record, as the receiving programs do. */
+      if ((offset + sizeof (RecordHeader) > length) || !IsValidRecordHeader (data + offset))
+	{
+	  uint64_t next = FindNextRecord (data, length, offset + 1);
+	  counts.mBytesSkipped += next - offset;
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Skipped " << (next - offset) << " unrecognized bytes at offset " << offset << "\n";
+	    }
+	  offset = next;
+	  continue;
+	}
+
+      const RecordHeader *header = (const RecordHeader *)(data + offset);
+      uint32_t recordSize = header->mRecordSize;
+      if (offset + recordSize > length)
+	{
+	  counts.mBytesSkipped += length - offset;
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Truncated record at offset " << offset << "\n";
+	    }
+	  break;
+	}
+
+      const uint8_t *record = data + offset;
+      offset += recordSize;
+
+      /* Records derived by this program (checksums, merge sources, and
+	 the outputs of the processing stages) are never sent by an
+	 instrument, and the receive loops don't accept them. */
+      if ((header->mRecordType & 0xFF0000) == GM_DATA_DOMAIN_TEST_CLIENT)
+	{
+	  continue;
+	}
+
+      switch (header->mRecordType)
+	{
+	case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+	  schedule.SetSamplePeriod (((const GmMagElementStatusPacket *)record)->mSamplePeriod);
+	  break;
+
+	  /* Only the 1000Hz blocks set the pace; the slower records go out
+	     immediately after the block that preceded them in the recording. */
+	case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+	  if (schedule.IsPaced ())
+	    {
+	      ReplayClock::time_point due = schedule.DueTime (GetRecordIndex (record));
+	      if (due > ReplayClock::now ())
+		{
+		  if (!flush ())
+		    {
+		      return;
+		    }
+		  std::this_thread::sleep_until (due);
+		}
+	    }
+	  break;
+	}
+
+      if (injectLoss && lose (random))
+	{
+	  counts.mRecordsDropped++;
+	  continue;
+	}
+      if (!send (record, recordSize))
+	{
+	  return;
+	}
+      counts.mRecordsSent++;
+      counts.mBytesSent += recordSize;
+    }
+  flush ();
+}
+
+static int ReplayTcp (const MappedFile &recording, MagElementTestOptions &options, ReplayCounts &counts)
+{
+  boost::asio::io_context io_context;
+  tcp::acceptor acceptor (io_context, tcp::endpoint (tcp::v4 (), atoi (options.mRemotePort.data ())));
+  if (options.mVerboseMode)
+    {
+      cerr << "Waiting for a client on port " << options.mRemotePort << "...\n";
+    }
+  tcp::socket socket (io_context);
+  acceptor.accept (socket);
+  socket.set_option (tcp::no_delay (true));
+  if (options.mVerboseMode)
+    {
+      cerr << "Client connected; replaying.\n";
+    }
+
+  /* Records are gathered straight from the mapping; nothing is copied. */
+  std::vector<boost::asio::const_buffer> pending;
+  size_t pendingBytes = 0;
+  bool failed = false;
+
+  auto flush = [&] () -> bool
+  {
+    if (failed)
+      {
+	return false;
+      }
+    if (pending.empty ())
+      {
+	return true;
+      }
+    boost::system::error_code error;
+    boost::asio::write (socket, pending, error);
+    pending.clear ();
+    pendingBytes = 0;
+    if (error)
+      {
+	cerr << "Replay connection closed: " << error.message () << "\n";
+	failed = true;
+      }
+    return !failed;
+  };
+
+  auto send = [&] (const uint8_t *record, uint32_t recordSize) -> bool
+  {
+    pending.push_back (boost::asio::buffer (record, recordSize));
+    pendingBytes += recordSize;
+    if (pendingBytes >= REPLAY_TCP_BATCH_BYTES)
+      {
+	return flush ();
+      }
+    return true;
+  };
+
+  ReplayRecords (recording, options, counts, send, flush);
+  return 0;
+}
+
+static int ReplayUdp (const MappedFile &recording, MagElementTestOptions &options, ReplayCounts &counts)
+{
+  boost::asio::io_context io_context;
+  std::string address = options.mRemoteIsValid ? options.mRemote : std::string ("127.0.0.1");
+  udp::endpoint destination (boost::asio::ip::make_address (address),
+			     atoi (options.mRemotePort.data ()));
+  udp::socket socket (io_context);
+  socket.open (udp::v4 ());
+  socket.set_option (boost::asio::socket_base::send_buffer_size (4 * 1024 * 1024));
+
+  auto flush = [] () -> bool { return true; };
+
+  auto send = [&] (const uint8_t *record, uint32_t recordSize) -> bool
+  {
+    boost::system::error_code error;
+    socket.send_to (boost::asio::buffer (record, recordSize), destination, 0, error);
+    if (error)
+      {
+	cerr << "Replay send failed: " << error.message () << "\n";
+	return false;
+      }
+    return true;
+  };
+
+  if (options.mVerboseMode)
+    {
+      cerr << "Replaying to " << address << ":" << options.mRemotePort << "\n";
+    }
+  ReplayRecords (recording, options, counts, send, flush);
+  return 0;
+}
+
+int RunReplay (MagElementTestOptions &options)
+{
+  MappedFile recording;
+  if (!recording.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+  recording.AdviseSequential ();
+
+  ReplayCounts counts;
+  ReplayClock::time_point start = ReplayClock::now ();
+  int result = 0;
+  try
+    {
+      result = options.mReplayUdp ? ReplayUdp (recording, options, counts)
+	: ReplayTcp (recording, options, counts);
+    }
+  catch (std::exception &e)
+    {
+      std::cerr << "Exception: " << e.what () << "\n";
+      result = 1;
+    }
+  double seconds = std::chrono::duration<double> (ReplayClock::now () - start).count ();
+
+  cout << "Replay: " << counts.mRecordsSent << " records sent, "
+       << counts.mRecordsDropped << " dropped, "
+       << counts.mBytesSent << " bytes in " << seconds << " s ("
+       << (seconds > 0.0 ? counts.mBytesSent / seconds / 1.0e6 : 0.0) << " MB/s), "
+       << counts.mBytesSkipped << " unrecognized bytes skipped.\n";
+  return result;
+}
@@ -0,0 +1,282 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include "DecodedColumns.hpp"
+#include "SimdKernels.hpp"
+#include "Resampler.hpp"
+
+static const double sPi = 3.14159265358979323846;
+
+/* Rate of the 1000Hz blocks, and the raw samples held beyond what the
+   widest kernel needs, so that they are moved down only once a second. */
+#define RESAMPLE_RAW_RATE 1000.0
+#define RESAMPLE_SLACK    1000
+
+bool ParseResampleKernel (const std::string &name, uint16_t &kernel)
+{
+  if (name == "linear")
+    {
+      kernel = RESAMPLE_KERNEL_LINEAR;
+    }
+  else if (name == "cubic")
+    {
+      kernel = RESAMPLE_KERNEL_CUBIC;
+    }
+  else if (name == "sinc")
+    {
+      kernel = RESAMPLE_KERNEL_SINC;
+    }
+  else
+    {
+      return false;
+    }
+  return true;
+}
+
+ResampleProcessor::ResampleProcessor (uint32_t rate, uint16_t kernel)
+  : mRate (rate > 0 ? rate : 1), mKernel (kernel)
+{
+  mStretch = std::max (1.0, RESAMPLE_RAW_RATE / mRate);
+  double units = (mKernel == RESAMPLE_KERNEL_LINEAR) ? 1.0 : (mKernel == RESAMPLE_KERNEL_CUBIC) ? 2.0 : 4.0;
+  mHalfWidth = units * mStretch;
+  uint32_t taps = 2 * (uint32_t)std::ceil (mHalfWidth) + 1;
+  mCapacity = taps + RESAMPLE_SLACK;
+  for (std::vector<double> &channel : mChannels)
+    {
+      channel.resize (mCapacity);
+    }
+  mWeights.resize (taps);
+
+  memset (&mPacket, 0, sizeof (mPacket));
+  mPacket.mRecordType = GM_MAG_ELEMENT_RESAMPLED_FORMAT;
+  mPacket.mRecordSize = sizeof (ResampledPacket);
+  mPacket.mRate = mRate;
+  mPacket.mKernel = mKernel;
+}
+
+/* Kernel value at offset raw samples from the output sample. */
+double ResampleProcessor::Weight (double offset) const
+{
+  double u = std::fabs (offset) / mStretch;
+  switch (mKernel)
+    {
+    case RESAMPLE_KERNEL_LINEAR:
+      return (u < 1.0) ? 1.0 - u : 0.0;
+    case RESAMPLE_KERNEL_CUBIC:
+      if (u < 1.0)
+	{
+	  return (1.5 * u - 2.5) * u * u + 1.0;
+	}
+      return (u < 2.0) ? ((-0.5 * u + 2.5) * u - 4.0) * u + 2.0 : 0.0;
+    default:
+      if (u < 1.0e-9)
+	{
+	  return 1.0;
+	}
+      return (u < 4.0) ? 4.0 * std::sin (sPi * u) * std::sin (sPi * u / 4.0) / (sPi * sPi * u * u) : 0.0;
+    }
+}
+
+/* Nanoseconds since the first PPS of output sample tick; exact when the
+   rate divides 1e9. */
+int64_t ResampleProcessor::TickTime (int64_t tick) const
+{
+  return (tick / mRate) * 1000000000LL + (tick % mRate) * 1000000000LL / mRate;
+}
+
+void ResampleProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodedRawBlock decoded;
+  DecodeRawBlock (streamerPacket, decoded);
+  for (int sample = 0; sample < MFAM_STREAMER_CACHE_SIZE; sample++)
+    {
+      uint64_t index = decoded.mFirstPacketIndex + sample;
+      if (!decoded.mMag1Valid[sample] || !decoded.mMag2Valid[sample])
+	{
+	  EndSegment ();
+	  continue;
+	}
+      if ((mCount > 0) && (index != mFirstIndex + mCount))
+	{
+	  EndSegment ();
+	}
+      if (mCount == mCapacity)
+	{
+	  Compact ();
+	}
+      if (mCount == 0)
+	{
+	  mFirstIndex = index;
+	}
+      mChannels[0][mCount] = (double)decoded.mMag1[sample];
+      mChannels[1][mCount] = (double)decoded.mMag2[sample];
+      for (int aux = 0; aux < 4; aux++)
+	{
+	  mChannels[2 + aux][mCount] = (double)decoded.mAux[aux][sample];
+	}
+      mCount++;
+    }
+  Produce ();
+}
+
+void ResampleProcessor::HandleStatusPacket (const GmMagElementStatusPacket &statusPacket)
+{
+  mTimeBase.Update (statusPacket);
+  Produce ();
+}
+
+void ResampleProcessor::Finish ()
+{
+  Produce ();
+  Flush ();
+}
+
+/* Compute every output sample whose kernel lies within the samples held. */
+void ResampleProcessor::Produce ()
+{
+  if (!mTimeBase.IsLocked () || (mCount == 0))
+    {
+      return;
+    }
+  int64_t first = (int64_t)mFirstIndex;
+  int64_t last = first + mCount - 1;
+  if (!mHaveTick)
+    {
+      mNextTick = (int64_t)std::ceil (mTimeBase.Time (mFirstIndex) * (double)mRate / 1.0e9);
+      mHaveTick = true;
+    }
+
+  for (;; mNextTick++)
+    {
+      double  position = mTimeBase.Counter (TickTime (mNextTick));
+      int64_t low = (int64_t)std::ceil (position - mHalfWidth);
+      int64_t high = (int64_t)std::floor (position + mHalfWidth);
+      if (low < first)
+	{
+	  continue;
+	}
+      if (high > last)
+	{
+	  break;
+	}
+
+      size_t taps = std::min ((size_t)(high - low + 1), mWeights.size ());
+      double total = 0.0;
+      for (size_t tap = 0; tap < taps; tap++)
+	{
+	  mWeights[tap] = Weight ((double)(low + (int64_t)tap) - position);
+	  total += mWeights[tap];
+	}
+      if (total == 0.0)
+	{
+	  continue;
+	}
+      double scale = 1.0 / total;
+      size_t offset = (size_t)(low - first);
+
+      uint32_t entry = mPacket.mSampleCount;
+      if ((entry > 0) && (mNextTick != mPacket.mFirstTick + entry))
+	{
+	  Flush ();
+	  entry = 0;
+	}
+      if (entry == 0)
+	{
+	  mPacket.mFirstTick = mNextTick;
+	  mPacket.mFirstPacketIndex = (uint64_t)std::floor (position);
+	  mPacket.mSegment = mSegment;
+	}
+      mPacket.mMag1[entry] = DotProduct (&mChannels[0][offset], mWeights.data (), taps) * scale
+	* MFAM_NANOTESLAS_PER_LSB;
+      mPacket.mMag2[entry] = DotProduct (&mChannels[1][offset], mWeights.data (), taps) * scale
+	* MFAM_NANOTESLAS_PER_LSB;
+      for (int aux = 0; aux < 4; aux++)
+	{
+	  mPacket.mAux[aux][entry] = (float)(DotProduct (&mChannels[2 + aux][offset], mWeights.data (), taps)
+					     * scale);
+	}
+      mPacket.mSampleCount = entry + 1;
+      if (mPacket.mSampleCount == RESAMPLED_SAMPLES)
+	{
+	  Flush ();
+	}
+    }
+}
+
+/* Make room by moving down the samples that the next output still needs,
+   or at least the kernel's width of them. */
+void ResampleProcessor::Compact ()
+{
+  Produce ();
+  uint32_t keep = (uint32_t)mWeights.size () + 1;
+  uint32_t drop = mCount - keep;
+  if (mHaveTick)
+    {
+      double  position = mTimeBase.Counter (TickTime (mNextTick));
+      int64_t needed = (int64_t)std::ceil (position - mHalfWidth) - (int64_t)mFirstIndex;
+      if ((needed > 0) && ((uint64_t)needed < drop))
+	{
+	  drop = (uint32_t)needed;
+	}
+    }
+  for (std::vector<double> &channel : mChannels)
+    {
+      memmove (channel.data (), channel.data () + drop, (mCount - drop) * sizeof (double));
+    }
+  mFirstIndex += drop;
+  mCount -= drop;
+}
+
+/* A gap or an invalid sample: finish the outputs that the samples held
+   allow, and start a new segment with the next sample. */
+void ResampleProcessor::EndSegment ()
+{
+  if (mCount == 0)
+    {
+      return;
+    }
+  Produce ();
+  Flush ();
+  mCount = 0;
+  mHaveTick = false;
+  mSegment++;
+}
+
+void ResampleProcessor::Flush ()
+{
+  uint32_t count = mPacket.mSampleCount;
+  if (count == 0)
+    {
+      return;
+    }
+  uint32_t unused = RESAMPLED_SAMPLES - count;
+  memset (&mPacket.mMag1[count], 0, unused * sizeof (double));
+  memset (&mPacket.mMag2[count], 0, unused * sizeof (double));
+  for (int aux = 0; aux < 4; aux++)
+    {
+      memset (&mPacket.mAux[aux][count], 0, unused * sizeof (float));
+    }
+  Emit (&mPacket, sizeof (mPacket));
+  mPacket.mSampleCount = 0;
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "DerivedRecords.hpp"
+#include "RecordProcessor.hpp"
+#include "StreamMerge.hpp"
+
+/* mag1, mag2 and aux x, y, z and t */
+#define RESAMPLE_CHANNELS 6
+
+/* \return  false if name is not linear, cubic or sinc. */
+bool ParseResampleKernel (const std::string &name, uint16_t &kernel);
+
+/* Interpolates the 1000Hz blocks onto a uniform grid of rate samples a
+   second, aligned with the PPS edges, and emits the result as
+   ResampledPacket records.  The time of each raw sample comes from the
+   heartbeats' PPS counters (see PpsTimeBase), so the grid follows UTC
+   whatever the drift of the instrument's clock.
+
+   Each output sample is the weighted sum of the raw samples within the
+   kernel's half width of it: 1 sample for linear, 2 for cubic (Keys, a =
+   -0.5) and 4 for sinc (Lanczos, 4 lobes).  When the output rate is below
+   the raw rate, the kernel is stretched by their ratio, so that it also
+   filters out what the output can't carry.  The weights are scaled to sum
+   to 1, and applied to each channel with DotProduct.
+
+   Raw samples are held in one array per channel, only as many as the
+   widest kernel needs plus a second of slack, so memory is bounded
+   whatever the rate.  A missing or invalid sample ends the segment; no
+   output is interpolated across it, and the outputs within a half width
+   of either end are left out. */
+class ResampleProcessor : public RecordProcessor
+{
+public:
+  ResampleProcessor (uint32_t rate, uint16_t kernel);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void HandleStatusPacket (const GmMagElementStatusPacket &statusPacket) override;
+  void Finish () override;
+
+private:
+  double  Weight (double offset) const;
+  int64_t TickTime (int64_t tick) const;
+  void    Produce ();
+  void    Compact ();
+  void    EndSegment ();
+  void    Flush ();
+
+  uint32_t            mRate;
+  uint16_t            mKernel;
+  double              mStretch;        /* Raw samples per kernel unit */
+  double              mHalfWidth;      /* In raw samples */
+  uint32_t            mCapacity;       /* Raw samples held */
+
+  PpsTimeBase         mTimeBase;
+  std::vector<double> mChannels[RESAMPLE_CHANNELS];
+  uint64_t            mFirstIndex = 0; /* Index of mChannels[*][0] */
+  uint32_t            mCount = 0;
+  std::vector<double> mWeights;
+
+  bool                mHaveTick = false;
+  int64_t             mNextTick = 0;
+  uint32_t            mSegment = 0;
+  ResampledPacket     mPacket;
+};
+
+#endif
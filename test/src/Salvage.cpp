@@ -0,0 +1,152 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "Checksum.hpp"
+#include "MappedFile.hpp"
+#include "RecordUtilities.hpp"
+#include "RecordValidation.hpp"
+#include "WorkStealingPool.hpp"
+#include "Salvage.hpp"
+
+/* \brief The pieces of the recording to copy, in order: the runs of good
+   records, and each good checksum record whose records all come
+   immediately before it in one run. */
+static std::vector<ByteRange> PiecesToCopy (const uint8_t *data, const RecordValidation &result)
+{
+  std::vector<ByteRange> pieces;
+  size_t run = 0;
+  for (uint64_t offset : result.mGoodChecksums)
+    {
+      for (; (run < result.mRecordRuns.size ()) && (result.mRecordRuns[run].mOffset < offset); run++)
+	{
+	  pieces.push_back (result.mRecordRuns[run]);
+	}
+      ChecksumPacket packet;
+      memcpy (&packet, data + offset, sizeof (packet));
+      if (!pieces.empty () &&
+	  (pieces.back ().mOffset + pieces.back ().mLength == offset) &&
+	  (pieces.back ().mLength >= packet.mByteCount))
+	{
+	  pieces.push_back ({ offset, sizeof (ChecksumPacket) });
+	}
+    }
+  for (; run < result.mRecordRuns.size (); run++)
+    {
+      pieces.push_back (result.mRecordRuns[run]);
+    }
+  return pieces;
+}
+
+int RunSalvage (MagElementTestOptions &options)
+{
+  MappedFile input;
+  if (!input.Open (options.mFileNameToSave))
+    {
+      return 1;
+    }
+  const uint8_t *data = input.Data ();
+  uint64_t size = input.Size ();
+  if (size == 0)
+    {
+      std::cerr << "\n\nError: " << options.mFileNameToSave << " is empty\n\n";
+      return 1;
+    }
+  input.AdviseSequential ();
+
+  auto startTime = std::chrono::steady_clock::now ();
+  uint64_t chunkBytes = (uint64_t)options.mChunkMegabytes * 1024 * 1024;
+  uint32_t chunkCount = (uint32_t)((size + chunkBytes - 1) / chunkBytes);
+  std::vector<RecordValidation> chunks (chunkCount);
+  {
+    WorkStealingPool pool (options.mWorkerCount);
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+      {
+	RecordValidation *result = &chunks[chunk];
+	result->mCollectRecords = true;
+	pool.Submit ([data, size, chunkBytes, chunk, result]
+		     {
+		       ValidateChunk (data, size, chunkBytes, chunk, *result);
+		     });
+      }
+    pool.Wait ();
+  }
+  RecordValidation result;
+  JoinChunks (data, size, chunkBytes, chunks, result);
+  chunks.clear ();
+
+  FILE *output = fopen (options.mOutputFileName.c_str (), "wb");
+  if (output == nullptr)
+    {
+      std::cerr << "\n\nError: Output file " << options.mOutputFileName << " can't be opened\n\n";
+      return 1;
+    }
+  std::vector<ByteRange> pieces = PiecesToCopy (data, result);
+  uint64_t written = 0;
+  bool writeFailed = false;
+  for (const ByteRange &piece : pieces)
+    {
+      if (fwrite (data + piece.mOffset, 1, piece.mLength, output) != piece.mLength)
+	{
+	  writeFailed = true;
+	  break;
+	}
+      written += piece.mLength;
+    }
+  if (fclose (output) != 0)
+    {
+      writeFailed = true;
+    }
+  if (writeFailed)
+    {
+      std::cerr << "\n\nError: Output file " << options.mOutputFileName << " not written\n\n";
+      return 1;
+    }
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+
+  /* Everything between the pieces was discarded: damaged bytes, and
+     checksum records that no longer match what was kept. */
+  std::cout << options.mFileNameToSave << ": " << size << " bytes\n";
+  result.Report (std::cout);
+  std::cout << "Discarded:\n";
+  uint64_t position = 0;
+  uint64_t discarded = 0;
+  pieces.push_back ({ size, 0 });
+  for (const ByteRange &piece : pieces)
+    {
+      if (piece.mOffset > position)
+	{
+	  std::cout << "  offset " << position << ", " << piece.mOffset - position << " bytes\n";
+	  discarded += piece.mOffset - position;
+	}
+      position = piece.mOffset + piece.mLength;
+    }
+  std::cout << "Salvage: " << written << " bytes written to " << options.mOutputFileName
+	    << ", " << discarded << " bytes discarded, in " << std::fixed << std::setprecision (2)
+	    << seconds << " s (" << ((seconds > 0.0) ? size / seconds / 1e6 : 0.0) << " MB/s)\n";
+  return 0;
+}
@@ -0,0 +1,270 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <string.h>
+#include "SimdKernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GM_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define GM_SIMD_NEON
+#endif
+
+void MultiplyArrays (const double *a, const double *b, double *out, size_t count)
+{
+  size_t index = 0;
+#if defined(GM_SIMD_SSE2)
+  for (; index + 2 <= count; index += 2)
+    {
+      _mm_storeu_pd (out + index, _mm_mul_pd (_mm_loadu_pd (a + index), _mm_loadu_pd (b + index)));
+    }
+#elif defined(GM_SIMD_NEON)
+  for (; index + 2 <= count; index += 2)
+    {
+      vst1q_f64 (out + index, vmulq_f64 (vld1q_f64 (a + index), vld1q_f64 (b + index)));
+    }
+#endif
+  for (; index < count; index++)
+    {
+      out[index] = a[index] * b[index];
+    }
+}
+
+double DotProduct (const double *a, const double *b, size_t count)
+{
+  size_t index = 0;
+  double total = 0.0;
+#if defined(GM_SIMD_SSE2)
+  __m128d sum = _mm_setzero_pd ();
+  for (; index + 2 <= count; index += 2)
+    {
+      sum = _mm_add_pd (sum, _mm_mul_pd (_mm_loadu_pd (a + index), _mm_loadu_pd (b + index)));
+    }
+  double lanes[2];
+  _mm_storeu_pd (lanes, sum);
+  total = lanes[0] + lanes[1];
+#elif defined(GM_SIMD_NEON)
+  float64x2_t sum = vdupq_n_f64 (0.0);
+  for (; index + 2 <= count; index += 2)
+    {
+      sum = vfmaq_f64 (sum, vld1q_f64 (a + index), vld1q_f64 (b + index));
+    }
+  total = vaddvq_f64 (sum);
+#endif
+  for (; index < count; index++)
+    {
+      total += a[index] * b[index];
+    }
+  return total;
+}
+
+void AddScaled (const double *a, double scale, double *out, size_t count)
+{
+  size_t index = 0;
+#if defined(GM_SIMD_SSE2)
+  __m128d factor = _mm_set1_pd (scale);
+  for (; index + 2 <= count; index += 2)
+    {
+      _mm_storeu_pd (out + index, _mm_add_pd (_mm_loadu_pd (out + index),
+					      _mm_mul_pd (factor, _mm_loadu_pd (a + index))));
+    }
+#elif defined(GM_SIMD_NEON)
+  float64x2_t factor = vdupq_n_f64 (scale);
+  for (; index + 2 <= count; index += 2)
+    {
+      vst1q_f64 (out + index, vfmaq_f64 (vld1q_f64 (out + index), factor, vld1q_f64 (a + index)));
+    }
+#endif
+  for (; index < count; index++)
+    {
+      out[index] += scale * a[index];
+    }
+}
+
+void AccumulatePower (const double *re, const double *im, double *accumulator, size_t count)
+{
+  size_t index = 0;
+#if defined(GM_SIMD_SSE2)
+  for (; index + 2 <= count; index += 2)
+    {
+      __m128d r = _mm_loadu_pd (re + index);
+      __m128d i = _mm_loadu_pd (im + index);
+      __m128d power = _mm_add_pd (_mm_mul_pd (r, r), _mm_mul_pd (i, i));
+      _mm_storeu_pd (accumulator + index, _mm_add_pd (_mm_loadu_pd (accumulator + index), power));
+    }
+#elif defined(GM_SIMD_NEON)
+  for (; index + 2 <= count; index += 2)
+    {
+      float64x2_t r = vld1q_f64 (re + index);
+      float64x2_t i = vld1q_f64 (im + index);
+      float64x2_t power = vaddq_f64 (vmulq_f64 (r, r), vmulq_f64 (i, i));
+      vst1q_f64 (accumulator + index, vaddq_f64 (vld1q_f64 (accumulator + index), power));
+    }
+#endif
+  for (; index < count; index++)
+    {
+      accumulator[index] += re[index] * re[index] + im[index] * im[index];
+    }
+}
+
+void MaskedDifferenceAndSum (const uint32_t *a, const uint32_t *b, const uint32_t *mask,
+			     int64_t *difference, int64_t *sum, size_t count)
+{
+  size_t index = 0;
+#if defined(GM_SIMD_SSE2)
+  const __m128i zero = _mm_setzero_si128 ();
+  for (; index + 4 <= count; index += 4)
+    {
+      __m128i va = _mm_loadu_si128 ((const __m128i *)(a + index));
+      __m128i vb = _mm_loadu_si128 ((const __m128i *)(b + index));
+      __m128i vm = _mm_loadu_si128 ((const __m128i *)(mask + index));
+
+      /* Zero-extend the unsigned 32-bit inputs, and spread each mask word
+	 over 64 bits. */
+      __m128i aLow  = _mm_unpacklo_epi32 (va, zero);
+      __m128i aHigh = _mm_unpackhi_epi32 (va, zero);
+      __m128i bLow  = _mm_unpacklo_epi32 (vb, zero);
+      __m128i bHigh = _mm_unpackhi_epi32 (vb, zero);
+      __m128i mLow  = _mm_unpacklo_epi32 (vm, vm);
+      __m128i mHigh = _mm_unpackhi_epi32 (vm, vm);
+
+      _mm_storeu_si128 ((__m128i *)(difference + index),     _mm_and_si128 (_mm_sub_epi64 (aLow, bLow), mLow));
+      _mm_storeu_si128 ((__m128i *)(difference + index + 2), _mm_and_si128 (_mm_sub_epi64 (aHigh, bHigh), mHigh));
+      _mm_storeu_si128 ((__m128i *)(sum + index),            _mm_and_si128 (_mm_add_epi64 (aLow, bLow), mLow));
+      _mm_storeu_si128 ((__m128i *)(sum + index + 2),        _mm_and_si128 (_mm_add_epi64 (aHigh, bHigh), mHigh));
+    }
+#elif defined(GM_SIMD_NEON)
+  for (; index + 2 <= count; index += 2)
+    {
+      int64x2_t va = vreinterpretq_s64_u64 (vmovl_u32 (vld1_u32 (a + index)));
+      int64x2_t vb = vreinterpretq_s64_u64 (vmovl_u32 (vld1_u32 (b + index)));
+      int64x2_t vm = vmovl_s32 (vreinterpret_s32_u32 (vld1_u32 (mask + index)));
+      vst1q_s64 (difference + index, vandq_s64 (vsubq_s64 (va, vb), vm));
+      vst1q_s64 (sum + index, vandq_s64 (vaddq_s64 (va, vb), vm));
+    }
+#endif
+  for (; index < count; index++)
+    {
+      int64_t m = mask[index] ? -1 : 0;
+      difference[index] = ((int64_t)a[index] - (int64_t)b[index]) & m;
+      sum[index] = ((int64_t)a[index] + (int64_t)b[index]) & m;
+    }
+}
+
+uint32_t MaskedMinMaxSum (const uint32_t *values, const uint8_t *flags, uint8_t flag, size_t count,
+			  uint32_t &minimum, uint32_t &maximum, uint64_t &sum)
+{
+  uint32_t low = 0xFFFFFFFF, high = 0, selected = 0;
+  uint64_t total = 0;
+  size_t index = 0;
+#if defined(GM_SIMD_SSE2)
+  /* SSE2 has only signed 32-bit comparisons, so the values are compared
+     with their top bit flipped; unselected lanes are replaced with the
+     neutral element of each reduction. */
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i ones = _mm_cmpeq_epi32 (zero, zero);
+  const __m128i bias = _mm_set1_epi32 ((int)0x80000000);
+  const __m128i biasedMaximum = _mm_set1_epi32 (0x7FFFFFFF);
+  const __m128i flagVector = _mm_set1_epi32 (flag);
+  __m128i vMin = biasedMaximum;
+  __m128i vMax = bias;
+  __m128i vSum = zero;
+  __m128i vCount = zero;
+  for (; index + 4 <= count; index += 4)
+    {
+      uint32_t packedFlags;
+      memcpy (&packedFlags, flags + index, sizeof (packedFlags));
+      __m128i f = _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 ((int)packedFlags), zero), zero);
+      __m128i skip = _mm_cmpeq_epi32 (_mm_and_si128 (f, flagVector), zero);
+      __m128i v = _mm_loadu_si128 ((const __m128i *)(values + index));
+      __m128i biased = _mm_xor_si128 (v, bias);
+
+      __m128i forMin = _mm_or_si128 (_mm_and_si128 (skip, biasedMaximum), _mm_andnot_si128 (skip, biased));
+      __m128i less = _mm_cmplt_epi32 (forMin, vMin);
+      vMin = _mm_or_si128 (_mm_and_si128 (less, forMin), _mm_andnot_si128 (less, vMin));
+
+      __m128i forMax = _mm_or_si128 (_mm_and_si128 (skip, bias), _mm_andnot_si128 (skip, biased));
+      __m128i greater = _mm_cmpgt_epi32 (forMax, vMax);
+      vMax = _mm_or_si128 (_mm_and_si128 (greater, forMax), _mm_andnot_si128 (greater, vMax));
+
+      __m128i masked = _mm_andnot_si128 (skip, v);
+      vSum = _mm_add_epi64 (vSum, _mm_unpacklo_epi32 (masked, zero));
+      vSum = _mm_add_epi64 (vSum, _mm_unpackhi_epi32 (masked, zero));
+      vCount = _mm_sub_epi32 (vCount, _mm_andnot_si128 (skip, ones));
+    }
+  uint32_t lanes[4];
+  uint64_t sums[2];
+  _mm_storeu_si128 ((__m128i *)lanes, _mm_xor_si128 (vMin, bias));
+  for (int lane = 0; lane < 4; lane++)
+    {
+      low = (lanes[lane] < low) ? lanes[lane] : low;
+    }
+  _mm_storeu_si128 ((__m128i *)lanes, _mm_xor_si128 (vMax, bias));
+  for (int lane = 0; lane < 4; lane++)
+    {
+      high = (lanes[lane] > high) ? lanes[lane] : high;
+    }
+  _mm_storeu_si128 ((__m128i *)lanes, vCount);
+  selected = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  _mm_storeu_si128 ((__m128i *)sums, vSum);
+  total = sums[0] + sums[1];
+#elif defined(GM_SIMD_NEON)
+  const uint32x4_t flagVector = vdupq_n_u32 (flag);
+  uint32x4_t vMin = vdupq_n_u32 (0xFFFFFFFF);
+  uint32x4_t vMax = vdupq_n_u32 (0);
+  uint64x2_t vSum = vdupq_n_u64 (0);
+  uint32x4_t vCount = vdupq_n_u32 (0);
+  for (; index + 4 <= count; index += 4)
+    {
+      uint32_t packedFlags;
+      memcpy (&packedFlags, flags + index, sizeof (packedFlags));
+      uint32x4_t f = vmovl_u16 (vget_low_u16 (vmovl_u8 (vcreate_u8 (packedFlags))));
+      uint32x4_t keep = vtstq_u32 (f, flagVector);
+      uint32x4_t v = vld1q_u32 (values + index);
+      vMin = vminq_u32 (vMin, vbslq_u32 (keep, v, vdupq_n_u32 (0xFFFFFFFF)));
+      uint32x4_t masked = vandq_u32 (keep, v);
+      vMax = vmaxq_u32 (vMax, masked);
+      vSum = vpadalq_u32 (vSum, masked);
+      vCount = vsubq_u32 (vCount, keep);
+    }
+  low = vminvq_u32 (vMin);
+  high = vmaxvq_u32 (vMax);
+  total = vaddvq_u64 (vSum);
+  selected = vaddvq_u32 (vCount);
+#endif
+  for (; index < count; index++)
+    {
+      if (flags[index] & flag)
+	{
+	  uint32_t value = values[index];
+	  low = (value < low) ? value : low;
+	  high = (value > high) ? value : high;
+	  total += value;
+	  selected++;
+	}
+    }
+  minimum = low;
+  maximum = high;
+  sum = total;
+  return selected;
+}
@@ -0,0 +1,56 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Small numerical kernels used by the processing stages, written with
+   SSE2 intrinsics on x86-64 and NEON on 64-bit ARM, and plain loops
+   elsewhere.  Pointers need no particular alignment. */
+
+/* out[i] = a[i] * b[i] */
+void MultiplyArrays (const double *a, const double *b, double *out, size_t count);
+
+/* \return  The sum of a[i] * b[i] */
+double DotProduct (const double *a, const double *b, size_t count);
+
+/* out[i] += scale * a[i] */
+void AddScaled (const double *a, double scale, double *out, size_t count);
+
+/* accumulator[i] += re[i] * re[i] + im[i] * im[i] */
+void AccumulatePower (const double *re, const double *im, double *accumulator, size_t count);
+
+/* difference[i] = a[i] - b[i] and sum[i] = a[i] + b[i], widened to 64 bits,
+   or both 0 where mask[i] is 0.  mask[i] must be 0 or 0xFFFFFFFF. */
+void MaskedDifferenceAndSum (const uint32_t *a, const uint32_t *b, const uint32_t *mask,
+			     int64_t *difference, int64_t *sum, size_t count);
+
+/* Minimum, maximum and sum (widened to 64 bits) of the values[i] for which
+   flags[i] & flag is non-zero.  With none selected, minimum is 0xFFFFFFFF
+   and maximum and sum are 0.
+   \return  The number of values selected. */
+uint32_t MaskedMinMaxSum (const uint32_t *values, const uint8_t *flags, uint8_t flag, size_t count,
+			  uint32_t &minimum, uint32_t &maximum, uint64_t &sum);
+
+#endif
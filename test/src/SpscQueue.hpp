@@ -0,0 +1,98 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+/* Bounded single-producer, single-consumer queue.  One thread may call
+   TryPush and one other thread TryPop; neither ever blocks or takes a lock.
+   The head and tail indexes live on separate cache lines, and each side
+   keeps a private copy of the other's index so that it touches the shared
+   line only when the queue looks full (producer) or empty (consumer). */
+template <typename T>
+class SpscQueue
+{
+public:
+  /* The capacity is rounded up to a power of two. */
+  explicit SpscQueue (size_t capacity)
+  {
+    size_t length = 2;
+    while (length < capacity)
+      {
+	length <<= 1;
+      }
+    mSlots.resize (length);
+    mMask = length - 1;
+  }
+
+  SpscQueue (const SpscQueue &) = delete;
+  SpscQueue &operator= (const SpscQueue &) = delete;
+
+  size_t Capacity () const { return mSlots.size (); }
+
+  bool TryPush (const T &value)
+  {
+    size_t tail = mTail.load (std::memory_order_relaxed);
+    if (tail - mHeadCache == mSlots.size ())
+      {
+	mHeadCache = mHead.load (std::memory_order_acquire);
+	if (tail - mHeadCache == mSlots.size ())
+	  {
+	    return false;
+	  }
+      }
+    mSlots[tail & mMask] = value;
+    mTail.store (tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop (T &value)
+  {
+    size_t head = mHead.load (std::memory_order_relaxed);
+    if (head == mTailCache)
+      {
+	mTailCache = mTail.load (std::memory_order_acquire);
+	if (head == mTailCache)
+	  {
+	    return false;
+	  }
+      }
+    value = mSlots[head & mMask];
+    mHead.store (head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T>                  mSlots;
+  size_t                          mMask;
+
+  alignas (64) std::atomic<size_t> mHead {0};   /* Written by the consumer */
+  size_t                          mTailCache = 0;
+  alignas (64) std::atomic<size_t> mTail {0};   /* Written by the producer */
+  size_t                          mHeadCache = 0;
+};
+
+#endif
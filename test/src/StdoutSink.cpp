@@ -0,0 +1,340 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "StdoutSink.hpp"
+
+/* Batch size when standard output is not a pipe. */
+#define STDOUT_BATCH_BYTES (1 << 20)
+
+/* Pipe buffer asked for when standard output is a pipe; the kernel may
+   give less (see /proc/sys/fs/pipe-max-size). */
+#define STDOUT_PIPE_BYTES  (1 << 20)
+
+/* A part-filled batch older than this is written when the next record
+   arrives, so that a slow stream is not held up waiting to fill one. */
+#define STDOUT_FLUSH_MS    100
+
+static const struct
+{
+  const char *mName;
+  uint32_t    mType;
+} sRecordTypeNames[] = {
+  { "block",       GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS },
+  { "decimated",   GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT },
+  { "heartbeat",   GM_MAG_ELEMENT_HEARTBEAT_FORMAT },
+  { "gradiometer", GM_MAG_ELEMENT_GRADIOMETER_FORMAT },
+  { "checksum",    GM_MAG_ELEMENT_CHECKSUM_FORMAT },
+  { "source",      GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT },
+  { "anomaly",     GM_MAG_ELEMENT_ANOMALY_FORMAT },
+  { "compensated", GM_MAG_ELEMENT_COMPENSATED_FORMAT },
+  { "resampled",   GM_MAG_ELEMENT_RESAMPLED_FORMAT },
+  { "fixed",       GM_MAG_ELEMENT_FIXED_POINT_FORMAT },
+  { "fir",         GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT },
+};
+
+bool ParseRecordTypes (const std::string &text, std::vector<uint32_t> &types)
+{
+  types.clear ();
+  if (text == "all")
+    {
+      return true;
+    }
+  size_t start = 0;
+  while (start <= text.size ())
+    {
+      size_t comma = text.find (',', start);
+      std::string entry = text.substr (start, (comma == std::string::npos) ? std::string::npos : comma - start);
+      bool found = false;
+      for (const auto &name : sRecordTypeNames)
+	{
+	  if (entry == name.mName)
+	    {
+	      types.push_back (name.mType);
+	      found = true;
+	    }
+	}
+      if (!found)
+	{
+	  char *end = nullptr;
+	  unsigned long type = strtoul (entry.c_str (), &end, 0);
+	  if (entry.empty () || (entry[0] == '-') || (*end != '\0') || (type > UINT32_MAX))
+	    {
+	      return false;
+	    }
+	  types.push_back ((uint32_t)type);
+	}
+      start = (comma == std::string::npos) ? text.size () + 1 : comma + 1;
+    }
+  return !types.empty ();
+}
+
+class StdoutStage : public PipelineStage
+{
+public:
+  StdoutStage (const MagElementTestOptions &options, const std::vector<uint32_t> &types);
+  ~StdoutStage ();
+
+  void HandleRecord (const RecordRef &record) override;
+  void Finish () override;
+
+private:
+  void Append (const uint8_t *data, size_t length);
+  void Flush ();
+  void Splice ();
+  bool Write (const uint8_t *data, size_t length);
+  uint8_t *MapBatch ();
+
+  std::vector<uint32_t> mTypes;
+  bool                  mVerbose;
+  bool                  mSplice = false;   /* Full batches go by vmsplice */
+  bool                  mFailed = false;   /* The reader has gone away */
+  size_t                mBatchBytes = STDOUT_BATCH_BYTES;
+  std::vector<uint8_t>  mStorage;
+  uint8_t              *mBatch = nullptr;  /* Mapped when spliced, else mStorage */
+  size_t                mFill = 0;
+  uint64_t              mRecords = 0;
+  uint64_t              mBytes = 0;
+  uint64_t              mSplices = 0;
+  uint64_t              mWrites = 0;
+  std::chrono::steady_clock::time_point mBatchStart;
+};
+
+StdoutStage::StdoutStage (const MagElementTestOptions &options, const std::vector<uint32_t> &types)
+  : mTypes (types), mVerbose (options.mVerboseMode)
+{
+#ifdef _WIN32
+  _setmode (_fileno (stdout), _O_BINARY);
+#else
+  /* A reader that exits ends the output, not the program, which may
+     still be saving the recording. */
+  signal (SIGPIPE, SIG_IGN);
+  struct stat status;
+  if ((fstat (STDOUT_FILENO, &status) == 0) && S_ISFIFO (status.st_mode))
+    {
+      mBatchBytes = 65536;
+#ifdef __linux__
+      fcntl (STDOUT_FILENO, F_SETPIPE_SZ, STDOUT_PIPE_BYTES);
+      int pipeBytes = fcntl (STDOUT_FILENO, F_GETPIPE_SZ);
+      if ((pipeBytes > 0) && ((pipeBytes % sysconf (_SC_PAGESIZE)) == 0))
+	{
+	  mBatchBytes = (size_t)pipeBytes;
+	  mBatch = MapBatch ();
+	  mSplice = (mBatch != nullptr);
+	}
+#endif
+    }
+#endif
+  if (mBatch == nullptr)
+    {
+      mStorage.resize (mBatchBytes);
+      mBatch = mStorage.data ();
+    }
+}
+
+StdoutStage::~StdoutStage ()
+{
+#ifdef __linux__
+  if (mSplice)
+    {
+      munmap (mBatch, mBatchBytes);
+    }
+#endif
+}
+
+/* A new, page aligned batch buffer to be spliced, or nullptr. */
+uint8_t *StdoutStage::MapBatch ()
+{
+#ifdef __linux__
+  void *batch = mmap (nullptr, mBatchBytes, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (batch != MAP_FAILED)
+    {
+      return (uint8_t *)batch;
+    }
+#endif
+  return nullptr;
+}
+
+void StdoutStage::HandleRecord (const RecordRef &record)
+{
+  uint32_t type = ((const RecordHeader *)record.Data ())->mRecordType;
+  if (!mFailed && (mTypes.empty () || (std::find (mTypes.begin (), mTypes.end (), type) != mTypes.end ())))
+    {
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+      if (mFill == 0)
+	{
+	  mBatchStart = now;
+	}
+      Append (record.Data (), record.Length ());
+      mRecords++;
+      if ((mFill > 0) && (now - mBatchStart >= std::chrono::milliseconds (STDOUT_FLUSH_MS)))
+	{
+	  Flush ();
+	}
+    }
+  Forward (record);
+}
+
+void StdoutStage::Finish ()
+{
+  Flush ();
+  if (mVerbose)
+    {
+      std::cerr << "Stdout: " << mRecords << " records, " << mBytes << " bytes in "
+		<< mSplices << " pipe splices and " << mWrites << " writes of up to "
+		<< mBatchBytes << " bytes" << (mFailed ? "; the reader closed the output" : "") << "\n";
+    }
+}
+
+void StdoutStage::Append (const uint8_t *data, size_t length)
+{
+  while ((length > 0) && !mFailed)
+    {
+      size_t piece = std::min (length, mBatchBytes - mFill);
+      memcpy (mBatch + mFill, data, piece);
+      mFill += piece;
+      data += piece;
+      length -= piece;
+      if (mFill == mBatchBytes)
+	{
+	  if (mSplice)
+	    {
+	      Splice ();
+	    }
+	  else
+	    {
+	      Flush ();
+	    }
+	}
+    }
+}
+
+/* A part-filled batch is copied into the pipe, so its buffer can be
+   filled again at once. */
+void StdoutStage::Flush ()
+{
+  if ((mFill > 0) && !mFailed && Write (mBatch, mFill))
+    {
+      mWrites++;
+    }
+  mFill = 0;
+}
+
+/* A full batch is as large as the pipe buffer and page aligned, so
+   vmsplice gives the pipe its pages rather than copies of them.  The
+   reader may pass those pages on (splice) rather than copy them out, so
+   there is no telling when they are free again: a spliced buffer is
+   gifted, unmapped, never written again, and a new one mapped for the
+   next batch.  If no new one can be mapped, writes are used from then
+   on. */
+void StdoutStage::Splice ()
+{
+#ifdef __linux__
+  struct iovec piece = { mBatch, mBatchBytes };
+  while ((piece.iov_len > 0) && !mFailed)
+    {
+      ssize_t spliced = vmsplice (STDOUT_FILENO, &piece, 1, SPLICE_F_GIFT);
+      if (spliced < 0)
+	{
+	  if (errno != EINTR)
+	    {
+	      mFailed = true;
+	      std::cerr << "Error: Standard output closed: " << strerror (errno) << "\n";
+	    }
+	  continue;
+	}
+      piece.iov_base = (uint8_t *)piece.iov_base + spliced;
+      piece.iov_len -= spliced;
+      mBytes += spliced;
+    }
+  mSplices++;
+  mFill = 0;
+  munmap (mBatch, mBatchBytes);
+  mBatch = MapBatch ();
+  if (mBatch == nullptr)
+    {
+      mSplice = false;
+      mStorage.resize (mBatchBytes);
+      mBatch = mStorage.data ();
+    }
+#endif
+}
+
+bool StdoutStage::Write (const uint8_t *data, size_t length)
+{
+#ifdef _WIN32
+  if ((fwrite (data, 1, length, stdout) != length) || (fflush (stdout) != 0))
+    {
+      mFailed = true;
+    }
+  else
+    {
+      mBytes += length;
+    }
+#else
+  while ((length > 0) && !mFailed)
+    {
+      ssize_t written = write (STDOUT_FILENO, data, length);
+      if (written < 0)
+	{
+	  if (errno != EINTR)
+	    {
+	      mFailed = true;
+	    }
+	  continue;
+	}
+      data += written;
+      length -= written;
+      mBytes += written;
+    }
+#endif
+  if (mFailed)
+    {
+      std::cerr << "Error: Standard output closed: " << strerror (errno) << "\n";
+    }
+  return !mFailed;
+}
+
+std::unique_ptr<PipelineStage> CreateStdoutStage (const MagElementTestOptions &options,
+						  const std::vector<uint32_t> &types)
+{
+  return std::make_unique<StdoutStage> (options, types);
+}
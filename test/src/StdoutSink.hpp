@@ -0,0 +1,50 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef STDOUT_SINK_HPP
+#define STDOUT_SINK_HPP
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* \brief Parse a list of record types for -stdout: all, or a comma
+   separated list of names (block, decimated, heartbeat, gradiometer,
+   checksum, source, anomaly, compensated, resampled, fixed, fir) and
+   record type numbers, such as 0x1001F.
+   \return false if an entry is not known; types is empty for all. */
+bool ParseRecordTypes (const std::string &text, std::vector<uint32_t> &types);
+
+/* \brief Sink stage that writes the records, unchanged, to standard
+   output, so that the program can feed other programs through a pipe.
+   Only the listed types are written, or every record if types is empty.
+   Records are gathered into batches the size of the pipe buffer; when
+   standard output is a pipe, on Linux, full batches are handed to the
+   pipe with vmsplice instead of being copied by write.  A batch that has
+   waited 0.1 s is written part-filled, so that slow streams are
+   not held up. */
+std::unique_ptr<PipelineStage> CreateStdoutStage (const MagElementTestOptions &options,
+						  const std::vector<uint32_t> &types);
+
+#endif
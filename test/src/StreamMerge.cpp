@@ -0,0 +1,260 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "StreamMerge.hpp"
+
+void PpsTimeBase::Update (const GmMagElementStatusPacket &statusPacket)
+{
+  uint32_t periodMs = statusPacket.mSamplePeriod;
+  double nominal = ((periodMs > 0) && (periodMs <= 1000)) ? 1000.0 / periodMs : 1000.0;
+  uint64_t first = statusPacket.mCounterAtFirstPps;
+  uint64_t last = statusPacket.mCounterAtLastPps;
+  if (((first == 0) && (last == 0)) || (last < first))
+    {
+      /* No PPS yet */
+      if (!mLocked)
+	{
+	  mCountsPerSecond = nominal;
+	}
+      return;
+    }
+
+  /* Whole seconds between the edges, then the rate that fits them. */
+  int64_t seconds = std::llround ((last - first) / nominal);
+  mCountsPerSecond = (seconds > 0) ? (last - first) / (double)seconds : nominal;
+  mPpsCounter = last;
+  mPpsSecond = seconds;
+  mLocked = true;
+}
+
+int64_t PpsTimeBase::Time (uint64_t counter) const
+{
+  double counts = (double)(int64_t)(counter - mPpsCounter);
+  return mPpsSecond * 1000000000LL + std::llround (counts * 1.0e9 / mCountsPerSecond);
+}
+
+double PpsTimeBase::Counter (int64_t time) const
+{
+  double nanoseconds = (double)(time - mPpsSecond * 1000000000LL);
+  return (double)mPpsCounter + nanoseconds * mCountsPerSecond / 1.0e9;
+}
+
+
+/* Earliest time on top; ties go to the lower input, so that the merge
+   does not depend on the order in which inputs were read. */
+bool StreamMerger::LaterEntry (const HeapEntry &left, const HeapEntry &right)
+{
+  return (left.mTime > right.mTime) || ((left.mTime == right.mTime) && (left.mInput > right.mInput));
+}
+
+StreamMerger::StreamMerger (uint32_t inputs, uint32_t bufferRecords, MergeOutput output)
+  : mInputs (inputs), mBufferRecords (std::max<uint32_t> (bufferRecords, 1)),
+    mOutput (output), mStarved (inputs)
+{
+  mHeap.reserve (inputs);
+  mStarvedList.reserve (inputs);
+  for (uint32_t input = 0; input < inputs; input++)
+    {
+      mInputs[input].mRing.resize (mBufferRecords);
+      mStarvedList.push_back (inputs - 1 - input);
+    }
+}
+
+bool StreamMerger::Add (uint32_t input, const RecordRef &record)
+{
+  Input &source = mInputs[input];
+  const RecordHeader *header = (const RecordHeader *)record.Data ();
+  switch (header->mRecordType)
+    {
+    case GM_MAG_ELEMENT_CHECKSUM_FORMAT:
+    case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+      mDropped++;
+      return true;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      {
+	/* The time base moves on as soon as a heartbeat arrives, so that
+	   the records waiting ahead of it are timed with it too. */
+	GmMagElementStatusPacket statusPacket;
+	memcpy (&statusPacket, record.Data (), sizeof (statusPacket));
+	source.mTimeBase.Update (statusPacket);
+	memcpy (source.mSerialNumber, statusPacket.mSerialNumber, sizeof (source.mSerialNumber));
+      }
+      break;
+    }
+
+  if (source.mCount == mBufferRecords)
+    {
+      mOverflows++;
+      return false;
+    }
+  source.mRing[(source.mHead + source.mCount) % mBufferRecords] = record;
+  source.mCount++;
+  source.mRecords++;
+  if ((source.mState == InputState::Starved) && Schedule (input))
+    {
+      Drain ();
+    }
+  return true;
+}
+
+void StreamMerger::Finish (uint32_t input)
+{
+  Input &source = mInputs[input];
+  source.mFinished = true;
+  if (source.mState != InputState::Starved)
+    {
+      return;
+    }
+  if (source.mCount == 0)
+    {
+      source.mState = InputState::Done;
+      mStarved--;
+    }
+  else
+    {
+      Schedule (input);
+    }
+  Drain ();
+}
+
+/* Put the record at the front of a starved input on the heap, if it can
+   be timed yet. */
+bool StreamMerger::Schedule (uint32_t input)
+{
+  Input &source = mInputs[input];
+  if (source.mCount == 0)
+    {
+      return false;
+    }
+  if (!source.mTimeBase.IsLocked () && !source.mFinished && (source.mCount < mBufferRecords))
+    {
+      return false;
+    }
+
+  const uint8_t *record = source.mRing[source.mHead].Data ();
+  int64_t time = source.mLastTime;
+  if (((const RecordHeader *)record)->mRecordType != GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT)
+    {
+      time = std::max (time, source.mTimeBase.Time (GetRecordIndex (record)));
+      if (!source.mTimeBase.IsLocked ())
+	{
+	  source.mUntimed++;
+	}
+    }
+  else if (time == INT64_MIN)
+    {
+      time = 0;
+    }
+  source.mLastTime = time;
+
+  mHeap.push_back ({ time, input });
+  std::push_heap (mHeap.begin (), mHeap.end (), LaterEntry);
+  source.mState = InputState::OnHeap;
+  mStarved--;
+  return true;
+}
+
+/* Pass on records, earliest first, for as long as every input that may
+   still send one has a record on the heap. */
+void StreamMerger::Drain ()
+{
+  while ((mStarved == 0) && !mHeap.empty ())
+    {
+      std::pop_heap (mHeap.begin (), mHeap.end (), LaterEntry);
+      HeapEntry entry = mHeap.back ();
+      mHeap.pop_back ();
+
+      Input &source = mInputs[entry.mInput];
+      RecordRef record = std::move (source.mRing[source.mHead]);
+      source.mHead = (source.mHead + 1) % mBufferRecords;
+      source.mCount--;
+      mMerged++;
+      mOutput (entry.mInput, entry.mTime, record);
+
+      source.mState = InputState::Starved;
+      mStarved++;
+      if (!Schedule (entry.mInput))
+	{
+	  if (source.mFinished && (source.mCount == 0))
+	    {
+	      source.mState = InputState::Done;
+	      mStarved--;
+	    }
+	  else
+	    {
+	      mStarvedList.push_back (entry.mInput);
+	    }
+	}
+    }
+}
+
+bool StreamMerger::NextStarved (uint32_t &input)
+{
+  while (!mStarvedList.empty ())
+    {
+      uint32_t candidate = mStarvedList.back ();
+      if (mInputs[candidate].mState == InputState::Starved)
+	{
+	  input = candidate;
+	  return true;
+	}
+      mStarvedList.pop_back ();
+    }
+  return false;
+}
+
+void StreamMerger::Report (std::ostream &output, const std::vector<std::string> &inputNames) const
+{
+  output << "Merge: " << mMerged << " records from " << mInputs.size () << " inputs";
+  if (mDropped > 0)
+    {
+      output << ", " << mDropped << " checksum and source records dropped";
+    }
+  if (mOverflows > 0)
+    {
+      output << ", " << mOverflows << " records refused with the buffer full";
+    }
+  output << "\n";
+  for (uint32_t input = 0; input < mInputs.size (); input++)
+    {
+      const Input &source = mInputs[input];
+      output << "  input " << input;
+      if (input < inputNames.size ())
+	{
+	  output << " (" << inputNames[input] << ")";
+	}
+      output << ": " << source.mRecords << " records";
+      if (!source.mTimeBase.IsLocked ())
+	{
+	  output << ", no PPS";
+	}
+      else if (source.mUntimed > 0)
+	{
+	  output << ", " << source.mUntimed << " timed before the first PPS";
+	}
+      output << "\n";
+    }
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef STREAM_MERGE_HPP
+#define STREAM_MERGE_HPP
+
+#include <stdint.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "MagElementData.hpp"
+#include "RecordPool.hpp"
+
+/* Each instrument numbers its records with its own sample counter.  The
+   heartbeat gives the counter at the instrument's first and latest PPS
+   edges, from which the counter is turned into time: whole seconds since
+   the first PPS (PPS edges counted between the two), plus the counts
+   since the latest edge scaled by the counter rate measured between them.
+   The instruments of an array share a GPS, so their first PPS edges are
+   taken to be the same second. */
+class PpsTimeBase
+{
+public:
+  /* \brief Take the PPS counters of a heartbeat. */
+  void Update (const GmMagElementStatusPacket &statusPacket);
+
+  bool    IsLocked () const { return mLocked; }
+
+  /* \return  Nanoseconds since the first PPS; before the first heartbeat
+     with PPS, since counter 0 at the nominal rate. */
+  int64_t Time (uint64_t counter) const;
+
+  /* \return  The (fractional) counter at a time from Time(). */
+  double  Counter (int64_t time) const;
+
+private:
+  bool     mLocked = false;
+  uint64_t mPpsCounter = 0;            /* Counter at the latest PPS edge */
+  int64_t  mPpsSecond = 0;             /* Its seconds since the first edge */
+  double   mCountsPerSecond = 1000.0;
+};
+
+/* Merges the records of any number of inputs, each in its own order, into
+   one stream in time order.  Each input has a ring of at most
+   bufferRecords records; the record at the front of each is on a heap,
+   keyed on its time, so each record costs O(log N) for N inputs.  A record
+   is passed on only when every input that has not finished has a record
+   on the heap, since until then an earlier one may still come.
+
+   Blocks, heartbeats and derived records are timed by their index on
+   their instrument's PpsTimeBase.  Decimated records have an index space
+   of their own, so they take the time of the record before them; no
+   record is given an earlier time than the one before it from the same
+   input, so each input keeps its order.  An input's records wait to be
+   timed until its first heartbeat with PPS, unless its ring fills or it
+   finishes first.  Checksum and merge source records belong to the files
+   they were read from, and are dropped. */
+class StreamMerger
+{
+public:
+  typedef std::function<void (uint32_t input, int64_t time, const RecordRef &record)> MergeOutput;
+
+  StreamMerger (uint32_t inputs, uint32_t bufferRecords, MergeOutput output);
+
+  /* \brief Take the next record of an input.
+     \return  false, and the record is dropped, if the input's ring is
+     full; NextStarved() names the inputs that have room. */
+  bool Add (uint32_t input, const RecordRef &record);
+
+  /* \brief The input has no more records. */
+  void Finish (uint32_t input);
+
+  /* \brief Name an input that is holding up the merge for want of
+     records.
+     \return  false if there is none, which once every input has finished
+     means that the merge is complete. */
+  bool NextStarved (uint32_t &input);
+
+  const PpsTimeBase &TimeBase (uint32_t input) const { return mInputs[input].mTimeBase; }
+  const uint8_t     *SerialNumber (uint32_t input) const { return mInputs[input].mSerialNumber; }
+
+  /* \brief Print the counts, naming each input from inputNames if given. */
+  void Report (std::ostream &output, const std::vector<std::string> &inputNames) const;
+
+private:
+  enum class InputState { Starved, OnHeap, Done };
+
+  struct Input
+  {
+    std::vector<RecordRef> mRing;
+    uint32_t     mHead = 0;
+    uint32_t     mCount = 0;
+    bool         mFinished = false;
+    InputState   mState = InputState::Starved;
+    PpsTimeBase  mTimeBase;
+    int64_t      mLastTime = INT64_MIN;
+    uint8_t      mSerialNumber[8] = {};
+    uint64_t     mRecords = 0;
+    uint64_t     mUntimed = 0;        /* Timed without a PPS */
+  };
+
+  struct HeapEntry
+  {
+    int64_t  mTime;
+    uint32_t mInput;
+  };
+
+  static bool LaterEntry (const HeapEntry &left, const HeapEntry &right);
+  bool Schedule (uint32_t input);
+  void Drain ();
+
+  std::vector<Input>     mInputs;
+  uint32_t               mBufferRecords;
+  MergeOutput            mOutput;
+  std::vector<HeapEntry> mHeap;
+  uint32_t               mStarved;     /* Inputs neither on the heap nor done */
+  std::vector<uint32_t>  mStarvedList; /* May name inputs that are no longer starved */
+  uint64_t               mDropped = 0; /* File records: checksums, merge sources */
+  uint64_t               mOverflows = 0;
+  uint64_t               mMerged = 0;
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include "DecodedColumns.hpp"
+#include "StreamStatistics.hpp"
+
+/* Running sums used by the Allan deviation are rebased this often, so that
+   they stay small; integer-valued input (raw LSBs) is then summed exactly. */
+#define ALLAN_REBASE_INTERVAL 65536
+
+SlidingWindowStatistics::SlidingWindowStatistics (uint32_t windowLength)
+  : mWindowLength (windowLength > 0 ? windowLength : 1),
+    mSamples (mWindowLength, 0.0),
+    mMinQueue (mWindowLength, 0),
+    mMaxQueue (mWindowLength, 0)
+{
+}
+
+void SlidingWindowStatistics::Add (double value)
+{
+  uint64_t sequence = mSequence++;
+
+  /* Retire the sample leaving the window, before its slot is reused. */
+  if (mCount == mWindowLength)
+    {
+      uint64_t leaving = sequence - mWindowLength;
+      double   oldValue = Sample (leaving);
+      double   oldMean = mMean;
+      mMean += (value - oldValue) / mWindowLength;
+      mM2 += (value - oldValue) * (value - mMean + oldValue - oldMean);
+
+      if ((mMinHead != mMinTail) && (mMinQueue[mMinHead % mWindowLength] == leaving))
+	{
+	  mMinHead++;
+	}
+      if ((mMaxHead != mMaxTail) && (mMaxQueue[mMaxHead % mWindowLength] == leaving))
+	{
+	  mMaxHead++;
+	}
+    }
+  else
+    {
+      mCount++;
+      double delta = value - mMean;
+      mMean += delta / mCount;
+      mM2 += delta * (value - mMean);
+    }
+  mSamples[sequence % mWindowLength] = value;
+
+  while ((mMinHead != mMinTail) && (Sample (mMinQueue[(mMinTail - 1) % mWindowLength]) >= value))
+    {
+      mMinTail--;
+    }
+  mMinQueue[mMinTail++ % mWindowLength] = sequence;
+
+  while ((mMaxHead != mMaxTail) && (Sample (mMaxQueue[(mMaxTail - 1) % mWindowLength]) <= value))
+    {
+      mMaxTail--;
+    }
+  mMaxQueue[mMaxTail++ % mWindowLength] = sequence;
+
+  if ((mCount == mWindowLength) && ((mSequence % mWindowLength) == 0))
+    {
+      Recompute ();
+    }
+}
+
+void SlidingWindowStatistics::Recompute ()
+{
+  double sum = 0.0;
+  for (uint32_t index = 0; index < mCount; index++)
+    {
+      sum += mSamples[index];
+    }
+  mMean = sum / mCount;
+  mM2 = 0.0;
+  for (uint32_t index = 0; index < mCount; index++)
+    {
+      double delta = mSamples[index] - mMean;
+      mM2 += delta * delta;
+    }
+}
+
+double SlidingWindowStatistics::Minimum () const
+{
+  return (mMinHead != mMinTail) ? Sample (mMinQueue[mMinHead % mWindowLength]) : 0.0;
+}
+
+double SlidingWindowStatistics::Maximum () const
+{
+  return (mMaxHead != mMaxTail) ? Sample (mMaxQueue[mMaxHead % mWindowLength]) : 0.0;
+}
+
+
+SlidingAllanDeviation::SlidingAllanDeviation (uint32_t windowLength, uint32_t maxTau)
+  : mWindowLength (windowLength > 0 ? windowLength : 1)
+{
+  if (maxTau < 1)
+    {
+      maxTau = 1;
+    }
+  uint64_t ringLength = 1;
+  while (ringLength < 2 * (uint64_t)maxTau + 1)
+    {
+      ringLength <<= 1;
+    }
+  mPrefixSums.assign (ringLength, 0.0);
+  mPrefixMask = ringLength - 1;
+
+  for (uint32_t tau = 1; tau <= maxTau; tau <<= 1)
+    {
+      TauState state;
+      state.mTau = tau;
+      state.mTerms.assign (mWindowLength, 0.0);
+      mTaus.push_back (std::move (state));
+    }
+}
+
+void SlidingAllanDeviation::Add (double value)
+{
+  if (mSamplesSeen == 0)
+    {
+      mReference = value;
+    }
+  mRunningSum += value - mReference;
+  uint64_t n = ++mSamplesSeen;
+  mPrefixSums[n & mPrefixMask] = mRunningSum;
+
+  for (TauState &state : mTaus)
+    {
+      uint64_t tau = state.mTau;
+      if (n < 2 * tau)
+	{
+	  break;
+	}
+      /* Difference of the two adjacent tau-sample averages ending at n. */
+      double difference = (mRunningSum
+			    - 2.0 * mPrefixSums[(n - tau) & mPrefixMask]
+			    + mPrefixSums[(n - 2 * tau) & mPrefixMask]) / (double)tau;
+      double term = difference * difference;
+
+      uint32_t slot = state.mAdded % mWindowLength;
+      if (state.mCount == mWindowLength)
+	{
+	  state.mSumOfSquares -= state.mTerms[slot];
+	}
+      else
+	{
+	  state.mCount++;
+	}
+      state.mTerms[slot] = term;
+      state.mSumOfSquares += term;
+      state.mAdded++;
+
+      if ((state.mAdded % mWindowLength) == 0)
+	{
+	  double sum = 0.0;
+	  for (uint32_t index = 0; index < state.mCount; index++)
+	    {
+	      sum += state.mTerms[index];
+	    }
+	  state.mSumOfSquares = sum;
+	}
+    }
+
+  if ((n % ALLAN_REBASE_INTERVAL) == 0)
+    {
+      for (double &prefix : mPrefixSums)
+	{
+	  prefix -= mRunningSum;
+	}
+      mRunningSum = 0.0;
+    }
+}
+
+double SlidingAllanDeviation::Deviation (size_t index) const
+{
+  const TauState &state = mTaus[index];
+  if (state.mCount == 0)
+    {
+      return -1.0;
+    }
+  double variance = state.mSumOfSquares / (2.0 * state.mCount);
+  return std::sqrt (variance > 0.0 ? variance : 0.0);
+}
+
+
+/* Octave taus go up to a quarter of the window, so that even the longest
+   has at least half a window of terms. */
+static uint32_t MaxTauForWindow (uint32_t windowLength)
+{
+  uint32_t maxTau = 1;
+  while (maxTau * 2 <= windowLength / 4)
+    {
+      maxTau *= 2;
+    }
+  return maxTau;
+}
+
+ChannelStatistics::ChannelStatistics (const std::string &name, double scale, uint32_t windowLength)
+  : mName (name), mScale (scale),
+    mWindow (windowLength),
+    mAllan (windowLength, MaxTauForWindow (windowLength))
+{
+}
+
+void ChannelStatistics::Report (std::ostream &output) const
+{
+  std::ostringstream line;
+  line << std::setprecision (10);
+  line << "Stats " << mName << ": n=" << mWindow.Count ();
+  if (mWindow.Count () > 0)
+    {
+      line << " mean=" << mWindow.Mean () * mScale
+	   << " sd=" << std::sqrt (mWindow.Variance ()) * mScale
+	   << " min=" << mWindow.Minimum () * mScale
+	   << " max=" << mWindow.Maximum () * mScale;
+    }
+  line << " invalid=" << mInvalid;
+  line << std::setprecision (4) << " adev";
+  for (size_t index = 0; index < mAllan.TauCount (); index++)
+    {
+      double deviation = mAllan.Deviation (index);
+      if (deviation < 0.0)
+	{
+	  break;
+	}
+      line << " " << mAllan.Tau (index) << ":" << deviation * mScale;
+    }
+  output << line.str () << "\n";
+}
+
+
+StatisticsProcessor::StatisticsProcessor (uint32_t windowLength)
+  : mMag1 ("mag1", MFAM_NANOTESLAS_PER_LSB, windowLength),
+    mMag2 ("mag2", MFAM_NANOTESLAS_PER_LSB, windowLength),
+    mFieldStrength ("field", 1.0, windowLength)
+{
+}
+
+void StatisticsProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodedRawBlock decoded;
+  DecodeRawBlock (streamerPacket, decoded);
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      if (decoded.mMag1Valid[index])
+	{
+	  mMag1.Add ((double)decoded.mMag1[index]);
+	}
+      else
+	{
+	  mMag1.CountInvalid ();
+	}
+      if (decoded.mMag2Valid[index])
+	{
+	  mMag2.Add ((double)decoded.mMag2[index]);
+	}
+      else
+	{
+	  mMag2.CountInvalid ();
+	}
+    }
+}
+
+void StatisticsProcessor::HandleDecimatedPacket (const IndexedMagElementDecimatedMagPacketWithHeader &decimatedPacket)
+{
+  mFieldStrength.Add (decimatedPacket.mIndexedPacket.mPacket.mFieldStrength);
+}
+
+void StatisticsProcessor::HandleStatusPacket (const GmMagElementStatusPacket &statusPacket)
+{
+  std::cout << "Stats at index " << statusPacket.mIndex << "\n";
+  mMag1.Report (std::cout);
+  mMag2.Report (std::cout);
+  mFieldStrength.Report (std::cout);
+}
@@ -0,0 +1,149 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef STREAM_STATISTICS_HPP
+#define STREAM_STATISTICS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "RecordProcessor.hpp"
+
+/* Mean, variance, minimum and maximum over the most recent windowLength
+   samples.  Each Add() is O(1): the mean and variance are updated with
+   Welford's method (adding the new sample and removing the one that left
+   the window), and the minimum and maximum come from monotonic queues.
+   The running sums are recomputed exactly once per window, which costs
+   O(1) per sample on average and stops rounding errors from accumulating. */
+class SlidingWindowStatistics
+{
+public:
+  explicit SlidingWindowStatistics (uint32_t windowLength);
+
+  void Add (double value);
+
+  uint32_t Count () const { return mCount; }
+  double   Mean () const { return mMean; }
+  double   Variance () const { return (mCount > 1) ? mM2 / (mCount - 1) : 0.0; }
+  double   Minimum () const;
+  double   Maximum () const;
+
+private:
+  double Sample (uint64_t sequence) const { return mSamples[sequence % mWindowLength]; }
+  void   Recompute ();
+
+  uint32_t              mWindowLength;
+  std::vector<double>   mSamples;      /* Ring of the samples in the window */
+  uint64_t              mSequence = 0; /* Number of samples ever added */
+  uint32_t              mCount = 0;
+  double                mMean = 0.0;
+  double                mM2 = 0.0;
+
+  /* Monotonic queues of sample sequence numbers, held in rings of
+     windowLength entries; [mHead, mTail) is the live part. */
+  std::vector<uint64_t> mMinQueue;
+  uint64_t              mMinHead = 0, mMinTail = 0;
+  std::vector<uint64_t> mMaxQueue;
+  uint64_t              mMaxHead = 0, mMaxTail = 0;
+};
+
+/* Overlapping Allan deviation at octave averaging times 1, 2, 4 ... maxTau
+   samples, over the most recent windowLength terms at each tau.  A ring of
+   prefix sums gives each new averaged difference in O(1), so Add() costs
+   one multiply-add per tau regardless of the window length. */
+class SlidingAllanDeviation
+{
+public:
+  SlidingAllanDeviation (uint32_t windowLength, uint32_t maxTau);
+
+  void Add (double value);
+
+  size_t   TauCount () const { return mTaus.size (); }
+  uint32_t Tau (size_t index) const { return mTaus[index].mTau; }
+
+  /* \return  Allan deviation at Tau(index), or a negative value if there are
+     not yet enough samples for that tau. */
+  double   Deviation (size_t index) const;
+
+private:
+  struct TauState
+  {
+    uint32_t            mTau;
+    std::vector<double> mTerms;        /* Ring of squared differences */
+    uint32_t            mCount = 0;
+    uint64_t            mAdded = 0;
+    double              mSumOfSquares = 0.0;
+  };
+
+  uint32_t              mWindowLength;
+  std::vector<double>   mPrefixSums;   /* Ring of running sums, power-of-two length */
+  uint64_t              mPrefixMask;
+  uint64_t              mSamplesSeen = 0;
+  double                mRunningSum = 0.0;
+  double                mReference = 0.0;
+  std::vector<TauState> mTaus;
+};
+
+/* Window statistics and Allan deviation for one named channel.  Values are
+   added in the channel's native units (LSBs for raw MFAM data) and scaled
+   to nanoteslas only when reported. */
+class ChannelStatistics
+{
+public:
+  ChannelStatistics (const std::string &name, double scale, uint32_t windowLength);
+
+  void Add (double value)
+  {
+    mWindow.Add (value);
+    mAllan.Add (value);
+  }
+  void CountInvalid () { mInvalid++; }
+
+  void Report (std::ostream &output) const;
+
+private:
+  std::string             mName;
+  double                  mScale;
+  uint64_t                mInvalid = 0;
+  SlidingWindowStatistics mWindow;
+  SlidingAllanDeviation   mAllan;
+};
+
+/* Streaming statistics of mag1 and mag2 from the 1000Hz blocks and of
+   mFieldStrength from the decimated records, published to the console each
+   time a heartbeat arrives. */
+class StatisticsProcessor : public RecordProcessor
+{
+public:
+  explicit StatisticsProcessor (uint32_t windowLength);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void HandleDecimatedPacket (const IndexedMagElementDecimatedMagPacketWithHeader &decimatedPacket) override;
+  void HandleStatusPacket (const GmMagElementStatusPacket &statusPacket) override;
+
+private:
+  ChannelStatistics mMag1;
+  ChannelStatistics mMag2;
+  ChannelStatistics mFieldStrength;
+};
+
+#endif
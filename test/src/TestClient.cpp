@@ -32,7 +32,29 @@ IN THE SOFTWARE.
 #include "licensetext.h"
 #include "helptext.h"
 #include "TestOptions.hpp"
+#include "TestClient.hpp"
+#include "Replay.hpp"
+#include "BatchCheck.hpp"
+#include "Extract.hpp"
+#include "Salvage.hpp"
+#include "Pyramid.hpp"
+#include "Decimate.hpp"
+#include "FileFollow.hpp"
+#include "DualCapture.hpp"
+#include "Decode.hpp"
+#include "Pcap.hpp"
+#include "Merge.hpp"
+#include "DerivedRecords.hpp"
+#include "RecordUtilities.hpp"
+#include "Pipeline.hpp"
+#include "PipelineStages.hpp"
+#include "RealTime.hpp"
+#include "Checksum.hpp"
+#include "ReorderWindow.hpp"
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 using namespace std; // For strlen.
 using namespace boost::asio;
@@ -44,21 +66,40 @@ using boost::asio::ip::tcp;
 #define max_length 1296
 
 /* Functions watch this variable in order to produce an
-   orderly shutdown. */
-static bool sShutDown = false;
+   orderly shutdown.  It is read from the pipeline threads, too. */
+static std::atomic<bool> sShutDown {false};
+
+bool ShutdownRequested ()
+{
+  return sShutDown;
+}
+
+/* The thread that runs the receive loops, which is the main thread. */
+static std::thread::id sReceiveThread;
 
 /* Scan for keyboard command to quit. This function, running in a 
    separate thread, can also be used as a template for other means to
    control the instrument and its output. */
 
-void WaitForCommand ()
+void WaitForCommand (int32_t cpu)
 {
+  if (cpu >= 0)
+    {
+      PinThreadToCpu (cpu, "command");
+    }
   while (true)
     {
       cout << ":";
-      char nextChar = getchar ();
+      int nextChar = getchar ();
 
-      cout << "Found char: " << nextChar << "\n";
+      /* With no more input there is nothing to watch; stop, rather than
+	 spin on EOF and take CPU time from the receiving thread. */
+      if (nextChar == EOF)
+	{
+	  return;
+	}
+
+      cout << "Found char: " << (char)nextChar << "\n";
 
       /* Pressing 'q' causes an orderly shutdown */
       if (nextChar == 'q')
@@ -242,10 +283,327 @@ void HandleStatusPacket (GmMagElementStatusPacket *statusPacket,
     }
 }
 
+/* Output a gradiometer record, derived by this program, to console or file. */
+void HandleGradiometerPacket (const GradiometerPacket *gradiometerPacket,
+			      MagElementTestOptions &options,
+			      FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "Gradient: " << gradiometerPacket->mFirstPacketIndex
+	   << ":" << gradiometerPacket->mSampleCount
+	   << ":" << gradiometerPacket->mDifference[0]
+	   << ":" << gradiometerPacket->mSum[0]
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (gradiometerPacket,1,sizeof (GradiometerPacket),outputFile);
+      if (written != sizeof (GradiometerPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Gradiometer packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output a merge source record, written by -proto merge, to console or file. */
+void HandleMergeSourcePacket (const MergeSourcePacket *sourcePacket,
+			      MagElementTestOptions &options,
+			      FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "Source: " << sourcePacket->mInput
+	   << ":" << sourcePacket->mFirstPacketIndex
+	   << ":" << sourcePacket->mTimeNanoseconds
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (sourcePacket,1,sizeof (MergeSourcePacket),outputFile);
+      if (written != sizeof (MergeSourcePacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Merge source packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output an anomaly record, derived by this program, to console or file. */
+void HandleAnomalyPacket (const AnomalyPacket *anomalyPacket,
+			  MagElementTestOptions &options,
+			  FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "Anomaly: mag" << anomalyPacket->mChannel
+	   << ":" << anomalyPacket->mFirstPacketIndex
+	   << ":" << anomalyPacket->mPeakPacketIndex
+	   << ":" << anomalyPacket->mWidth
+	   << ":" << anomalyPacket->mPeakAmplitude
+	   << ":" << anomalyPacket->mPeakRms
+	   << ":" << anomalyPacket->mThreshold
+	   << (((anomalyPacket->mFlags & ANOMALY_FLAG_TRUNCATED) != 0) ? ":truncated" : "")
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (anomalyPacket,1,sizeof (AnomalyPacket),outputFile);
+      if (written != sizeof (AnomalyPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Anomaly packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output a compensated record, derived by this program, to console or file. */
+void HandleCompensatedPacket (const CompensatedPacket *compensatedPacket,
+			      MagElementTestOptions &options,
+			      FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "Compensated: " << compensatedPacket->mIndex
+	   << ":" << compensatedPacket->mMagData
+	   << ":" << compensatedPacket->mCompensated
+	   << ":" << compensatedPacket->mCorrection
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (compensatedPacket,1,sizeof (CompensatedPacket),outputFile);
+      if (written != sizeof (CompensatedPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Compensated packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output a resampled record, derived by this program, to console or file. */
+void HandleResampledPacket (const ResampledPacket *resampledPacket,
+			    MagElementTestOptions &options,
+			    FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "Resampled: " << resampledPacket->mFirstPacketIndex
+	   << ":" << resampledPacket->mFirstTick
+	   << ":" << resampledPacket->mRate
+	   << ":" << resampledPacket->mSegment
+	   << ":" << resampledPacket->mSampleCount;
+      if (resampledPacket->mSampleCount > 0)
+	{
+	  cout << ":" << resampledPacket->mMag1[0]
+	       << ":" << resampledPacket->mMag2[0];
+	}
+      cout << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (resampledPacket,1,sizeof (ResampledPacket),outputFile);
+      if (written != sizeof (ResampledPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Resampled packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output a fixed-point record, derived by this program, to console or
+   file.  This is where its integers first become nT. */
+void HandleFixedPointPacket (const FixedPointPacket *fixedPointPacket,
+			     MagElementTestOptions &options,
+			     FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      double scale = MFAM_NANOTESLAS_PER_LSB / (double)fixedPointPacket->mGain;
+      cout << "Fixed: " << fixedPointPacket->mFirstPacketIndex
+	   << ":" << fixedPointPacket->mSampleCount
+	   << ":" << fixedPointPacket->mMag1[0] * scale
+	   << ":" << fixedPointPacket->mMag2[0] * scale
+	   << ":" << fixedPointPacket->mDifference[0] * scale
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (fixedPointPacket,1,sizeof (FixedPointPacket),outputFile);
+      if (written != sizeof (FixedPointPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: Fixed-point packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Output a FIR decimated record, written by -proto decimate, to console or file. */
+void HandleFirDecimatedPacket (const FirDecimatedPacket *decimatedPacket,
+			       MagElementTestOptions &options,
+			       FILE *outputFile)
+{
+  if (options.mVerboseMode)
+    {
+      cout << "FIR: " << decimatedPacket->mFirstPacketIndex
+	   << ":" << decimatedPacket->mDecimation
+	   << ":" << decimatedPacket->mMag1[0]
+	   << ":" << decimatedPacket->mMag2[0]
+	   << "\n";
+    }
+  if (outputFile != nullptr)
+    {
+      size_t written = fwrite (decimatedPacket,1,sizeof (FirDecimatedPacket),outputFile);
+      if (written != sizeof (FirDecimatedPacket))
+	{
+	  if (options.mVerboseMode)
+	    {
+	      cerr << "Error: FIR decimated packet not written.\n\n";
+	    }
+	}
+    }
+}
+
+/* Pass a record of any known type to its Handle* function above. */
+void HandleRecord (const uint8_t *record,
+		   const int32_t counter,
+		   MagElementTestOptions &options,
+		   FILE *outputFile)
+{
+  const RecordHeader *header = (const RecordHeader *)record;
+  switch (header->mRecordType)
+    {
+    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
+      HandleRawDataBlock ((StreamerPacket *)record, counter, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
+      HandleDecimatedPacket ((IndexedMagElementDecimatedMagPacketWithHeader *)record, counter, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
+      HandleStatusPacket ((GmMagElementStatusPacket *)record, counter, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+      HandleGradiometerPacket ((const GradiometerPacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+      HandleMergeSourcePacket ((const MergeSourcePacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_ANOMALY_FORMAT:
+      HandleAnomalyPacket ((const AnomalyPacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_COMPENSATED_FORMAT:
+      HandleCompensatedPacket ((const CompensatedPacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_RESAMPLED_FORMAT:
+      HandleResampledPacket ((const ResampledPacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_FIXED_POINT_FORMAT:
+      HandleFixedPointPacket ((const FixedPointPacket *)record, options, outputFile);
+      break;
+    case GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT:
+      HandleFirDecimatedPacket ((const FirDecimatedPacket *)record, options, outputFile);
+      break;
+    }
+}
+
+/* The last stage of the pipeline: console and/or file output through the
+   Handle* functions.  The console and file sinks each keep their own copy
+   of the options, so that a file-only sink can be quiet. */
+class OutputStage : public PipelineStage
+{
+public:
+  OutputStage (const MagElementTestOptions &options, FILE *outputFile, bool console)
+    : mOptions (options), mOutputFile (outputFile)
+  {
+    if (!console)
+      {
+	mOptions.mVerboseMode = false;
+      }
+  }
+
+  /* A stage that writes the file on a thread of its own is the writer
+     thread; when fused onto the receiving thread, -rx-cpu applies. */
+  void Start () override
+  {
+    if ((mOutputFile != nullptr) && (mOptions.mWriterCpu >= 0) &&
+	(std::this_thread::get_id () != sReceiveThread))
+      {
+	PinThreadToCpu (mOptions.mWriterCpu, "writer");
+      }
+  }
+
+  void HandleRecord (const RecordRef &record) override
+  {
+    mCounter++;
+    /* Records are passed on, so that a console and a file sink can
+       follow one another. */
+    ::HandleRecord (record.Data (), mCounter, mOptions, mOutputFile);
+    if ((mOutputFile != nullptr) && (mOptions.mChecksumInterval > 0) &&
+	(((const RecordHeader *)record.Data ())->mRecordType != GM_MAG_ELEMENT_CHECKSUM_FORMAT))
+      {
+	mChecksum.Add (record.Data (), record.Length ());
+	if (mChecksum.Records () >= mOptions.mChecksumInterval)
+	  {
+	    WriteChecksum ();
+	  }
+      }
+    Forward (record);
+  }
+
+  void Finish () override
+  {
+    if (mOutputFile != nullptr)
+      {
+	if (mChecksum.Records () > 0)
+	  {
+	    WriteChecksum ();
+	  }
+	fflush (mOutputFile);
+      }
+  }
+
+private:
+  /* -checksum: cover the records written since the last checksum record. */
+  void WriteChecksum ()
+  {
+    ChecksumPacket packet;
+    mChecksum.MakePacket (packet);
+    if (fwrite (&packet, 1, sizeof (packet), mOutputFile) != sizeof (packet))
+      {
+	cerr << "Error: Checksum record not written.\n\n";
+      }
+  }
+
+  MagElementTestOptions mOptions;
+  FILE                 *mOutputFile;
+  int32_t               mCounter = 0;
+  RecordChecksum        mChecksum;
+};
+
+std::unique_ptr<PipelineStage> CreateOutputStage (MagElementTestOptions &options,
+						  FILE *outputFile,
+						  bool console)
+{
+  return std::make_unique<OutputStage> (options, outputFile, console);
+}
+
 /* \brief Connect to the instrument, then stream data. 
    This function does not retry, or reconnect after a connection 
    failure, or exit gracefully. This is not a production program. */
-int RunTcpClient (MagElementTestOptions &options, FILE *outputFile)
+int RunTcpClient (MagElementTestOptions &options, Pipeline &pipeline)
 {
   try {
     /* Basic asio setup */
@@ -261,18 +619,12 @@ int RunTcpClient (MagElementTestOptions &options, FILE *outputFile)
     tcp::socket s(io_context);
     boost::asio::connect(s, endpoints);
     
-    uint32_t counter = 0;
-    
     while (true)
       {
 	while (true)
 	  {
 	    if (sShutDown)
 	      {
-		if (outputFile != nullptr)
-		  {
-		    fclose (outputFile);
-		  }
 		return 0;
 	      }
 	    /* Buffer into which data will be read.  It is as long or longer than
@@ -327,14 +679,9 @@ int RunTcpClient (MagElementTestOptions &options, FILE *outputFile)
 	while (true) {
 	  if (sShutDown)
 	    {
-	      if (outputFile != nullptr)
-		{
-		  fclose (outputFile);
-		}
-	      return (0);
+		      return (0);
 	    }
-	  counter++;
-	  uint8_t reply[2000];
+	  uint8_t reply[8];
 
 	  /* Read an 8-bite header. All records from MagElement include an 8-byte header.*/
 	  typedef uint32_t IntAndSizeHeader[2];
@@ -354,34 +701,15 @@ int RunTcpClient (MagElementTestOptions &options, FILE *outputFile)
 		case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
 		  recognizedRecord = true;
 
-		  /* Read the remaining part  of the packet */
-		  replyLength = boost::asio::read(s, boost::asio::buffer(reply + 8, (*testHeader)[1]-8));
-		  switch ((*testHeader)[0])
-		    {
-		      /* 1000Hz block packet */
-		    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
-		      {
-			StreamerPacket *streamerPacket = (StreamerPacket *) &reply;
-			HandleRawDataBlock (streamerPacket, counter, options, outputFile);
-		      }
-		      break;
-
-		      /* Decimated magnetometer packet */
-		    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
-		      {
-			IndexedMagElementDecimatedMagPacketWithHeader *decimatedPacket = (IndexedMagElementDecimatedMagPacketWithHeader *) &reply;
-			HandleDecimatedPacket (decimatedPacket, counter, options, outputFile);
-		      }
-		      break;
-
-		      /* Heartbeat/status packet */
-		    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
-		      {
-			GmMagElementStatusPacket *statusPacket = (GmMagElementStatusPacket*)&reply;
-			HandleStatusPacket (statusPacket, counter, options, outputFile);
-		      }
-		      break;
-		    }
+		  {
+		    /* Read the remaining part of the packet straight into a
+		       pool buffer, which the pipeline then shares */
+		    uint32_t recordLength = RecordSizeForType ((*testHeader)[0]);
+		    RecordRef record = pipeline.Pool ().Allocate (recordLength);
+		    memcpy (record.Buffer (), reply, 8);
+		    replyLength = boost::asio::read(s, boost::asio::buffer(record.Buffer () + 8, recordLength - 8));
+		    pipeline.Submit (record);
+		  }
 		default:
 		  break;
 		}
@@ -403,7 +731,47 @@ int RunTcpClient (MagElementTestOptions &options, FILE *outputFile)
   return 0;
 }
 
-int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
+/* The longest that the UDP client waits for a datagram before it looks
+   for a shutdown request again. */
+#define UDP_RECEIVE_WAIT_MS 100
+
+/* \brief Receive one datagram into buffer, waiting at most
+   UDP_RECEIVE_WAIT_MS for it.  A blocking receive_from can't be
+   interrupted, so the receive is asynchronous and cancelled on time out.
+   \return  The datagram's length, or 0 if none arrived in time. */
+static size_t ReceiveDatagram (boost::asio::io_context &io_context, ip::udp::socket &sock,
+			       uint8_t *buffer, size_t length, ip::udp::endpoint &remote)
+{
+  boost::system::error_code error = boost::asio::error::would_block;
+  size_t received = 0;
+  sock.async_receive_from (boost::asio::buffer (buffer, length), remote,
+			   [&error, &received] (const boost::system::error_code &result, size_t bytes)
+			   {
+			     error = result;
+			     received = bytes;
+			   });
+  io_context.restart ();
+  io_context.run_for (std::chrono::milliseconds (UDP_RECEIVE_WAIT_MS));
+  if (error == boost::asio::error::would_block)
+    {
+      /* Let the cancelled receive finish; a datagram may have arrived
+	 just in time. */
+      sock.cancel ();
+      io_context.restart ();
+      io_context.run ();
+    }
+  if (error == boost::asio::error::operation_aborted)
+    {
+      return 0;
+    }
+  if (error)
+    {
+      throw boost::system::system_error (error);
+    }
+  return received;
+}
+
+int RunUdpClient (MagElementTestOptions &options, Pipeline &pipeline)
 {
   if (options.mVerboseMode)
     {
@@ -412,24 +780,41 @@ int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
 
   ip::udp::endpoint remote_endpoint;
 
+  /* -reorder: records go through the reorder window on their way to the
+     pipeline. */
+  std::unique_ptr<ReorderWindow> reorder;
+  if (options.mReorderSlots > 0)
+    {
+      uint32_t slots = options.mReorderSlots;
+      double   holdMs = options.mReorderHoldMs;
+      reorder = std::make_unique<ReorderWindow> (slots, holdMs,
+						 [&pipeline] (const RecordRef &record) { pipeline.Submit (record); });
+    }
+  auto finishReorder = [&reorder, &options] ()
+    {
+      if (reorder)
+	{
+	  reorder->Flush ();
+	  if (options.mVerboseMode)
+	    {
+	      reorder->Report (std::cerr);
+	    }
+	}
+    };
+
   try {
     /* Basic asio setup */
     boost::asio::io_context io_context;
     ip::udp::endpoint ep(ip::udp::v4(),atoi(options.mRemotePort.data()));
     ip::udp::socket sock(io_context,ep);
     
-    uint32_t counter = 0;
-    
     while (true)
       {
 	while (true)
 	  {
 	    if (sShutDown)
 	      {
-		if (outputFile != nullptr)
-		  {
-		    fclose (outputFile);
-		  }
+		finishReorder ();
 		return(0);
 	      }
 	    if (options.mVerboseMode)
@@ -454,8 +839,11 @@ int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
 
 	    /* Read a heartbeat's worth of data into the the buffer. Eventually one will be 
 	       found. */
-	    size_t replyLength = sock.receive_from(boost::asio::buffer(reply, max_length),
-						   remote_endpoint);
+	    size_t replyLength = 0;
+	    while (!sShutDown && (replyLength == 0))
+	      {
+		replyLength = ReceiveDatagram (io_context, sock, reply, max_length, remote_endpoint);
+	      }
 	    
 	    //cout << "Got data: " << replyLength << "bytes.\n";
 	    //size_t replyLength = boost::asio::read(s, boost::asio::buffer(reply, HEARTBEAT_LENGTH));
@@ -485,26 +873,25 @@ int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
 	  
 	  if (sShutDown)
 	    {
-	      if (outputFile != nullptr)
-		{
-		  fclose (outputFile);
-		}
+	      finishReorder ();
 	      return(0);
 	    }
 	  
-	  counter++;
-	  uint8_t reply[2000];
+	  /* A datagram's size is known only once it has arrived, so receive
+	     into a pool buffer large enough for any record. */
+	  RecordRef record = pipeline.Pool ().Allocate (max_length);
+	  uint8_t *reply = record.Buffer ();
 
 	  /* Read an 8-byte header. All records from MagElement include an 8-byte header.*/
 	  typedef uint32_t IntAndSizeHeader[2];
 	  IntAndSizeHeader* testHeader;
 	  bool recognizedRecord = false;
-	  size_t replyLength = sock.receive_from( boost::asio::buffer((uint8_t*)reply, max_length),remote_endpoint);
+	  size_t replyLength = ReceiveDatagram (io_context, sock, reply, max_length, remote_endpoint);
 
 	  /* Found? */
 	  if (replyLength >  8)
 	    {
-	      testHeader = (IntAndSizeHeader*)&reply;
+	      testHeader = (IntAndSizeHeader*)reply;
 	      switch ((*testHeader)[0])
 		{
 		  /* Is the type known? */
@@ -513,33 +900,15 @@ int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
 		case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
 		  recognizedRecord = true;
 
-		  /* Read the remaining part  of the packet */
-		  switch ((*testHeader)[0])
+		  /* Hand the record to the processing pipeline */
+		  record.SetLength (RecordSizeForType ((*testHeader)[0]));
+		  if (reorder)
 		    {
-
-		      /* 1000Hz block packet */
-		    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
-		      {
-			StreamerPacket *streamerPacket = (StreamerPacket *) &reply;
-			HandleRawDataBlock (streamerPacket, counter, options, outputFile);
-		      }
-		      break;
-
-		      /* Decimated magnetometer packet */
-		    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
-		      {
-			IndexedMagElementDecimatedMagPacketWithHeader *decimatedPacket = (IndexedMagElementDecimatedMagPacketWithHeader *) &reply;
-			HandleDecimatedPacket (decimatedPacket, counter, options, outputFile);
-		      }
-		      break;
-
-		      /* Heartbeat/status packet */
-		    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
-		      {
-			GmMagElementStatusPacket *statusPacket = (GmMagElementStatusPacket*)&reply;
-			HandleStatusPacket (statusPacket, counter, options, outputFile);
-		      }
-		      break;
+		      reorder->Add (record, ReorderWindow::Clock::now ());
+		    }
+		  else
+		    {
+		      pipeline.Submit (record);
 		    }
 		  break;
 
@@ -566,17 +935,43 @@ int RunUdpClient (MagElementTestOptions &options, FILE *outputFile)
        a production program, will exit with some raw error information */
     std::cerr << "Exception: " << e.what() << "\n";
   }
+  finishReorder ();
   return 0;
 }
 
 /* Validate the content of a MagElement data file. */
-int RunFileCheck (MagElementTestOptions &options, FILE *inputFile)
+/* \brief Check a checksum record against the bytes before it, read again
+   from the file.  This is for files in which records were lost since the
+   last checksum record (a salvaged recording), so that the running
+   checksum covers more than the record does. */
+static bool CheckCoveredBytes (FILE *inputFile, const ChecksumPacket &packet)
+{
+  fpos_t position;
+  if (fgetpos (inputFile, &position) != 0)
+    {
+      return false;
+    }
+  long back = (long)(packet.mByteCount + sizeof (ChecksumPacket));
+  std::vector<uint8_t> covered (packet.mByteCount);
+  bool match = (fseek (inputFile, -back, SEEK_CUR) == 0) &&
+    (fread (covered.data (), 1, covered.size (), inputFile) == covered.size ()) &&
+    (Crc32c (0, covered.data (), covered.size ()) == packet.mCrc32c);
+  fsetpos (inputFile, &position);
+  return match;
+}
+
+int RunFileCheck (MagElementTestOptions &options, FILE *inputFile, Pipeline &pipeline)
 {
   if (options.mVerboseMode)
     {
       cerr << "Running File check... \n";
     }
 
+  /* Checksum records, in files recorded with -checksum */
+  RecordChecksum checksum;
+  uint64_t checksumsVerified = 0;
+  uint64_t checksumsFailed = 0;
+
   try
     {
       uint64_t counter = 0;
@@ -585,13 +980,12 @@ int RunFileCheck (MagElementTestOptions &options, FILE *inputFile)
 	{
 	  /* Read the record header. */
 
-	  uint8_t recordData[max_length];
+	  uint8_t recordData[8];
 
 	  size_t bytesRead = fread (recordData, 1, 8, inputFile);
 
 	  if (bytesRead != 8)
 	    {
-	      fclose (inputFile);
 	      break;
 	    }
 
@@ -630,50 +1024,116 @@ int RunFileCheck (MagElementTestOptions &options, FILE *inputFile)
 		break;
 	      }
 	      break;
+
+	      /* Gradiometer packet, derived by this program */
+	    case GM_MAG_ELEMENT_GRADIOMETER_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (GradiometerPacket) - 8;
+		break;
+	      }
+
+	      /* Checksum record, written with -checksum */
+	    case GM_MAG_ELEMENT_CHECKSUM_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (ChecksumPacket) - 8;
+		break;
+	      }
+
+	      /* Merge source record, written by -proto merge */
+	    case GM_MAG_ELEMENT_MERGE_SOURCE_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (MergeSourcePacket) - 8;
+		break;
+	      }
+
+	      /* Anomaly record, derived by this program */
+	    case GM_MAG_ELEMENT_ANOMALY_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (AnomalyPacket) - 8;
+		break;
+	      }
+
+	      /* Compensated record, derived by this program */
+	    case GM_MAG_ELEMENT_COMPENSATED_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (CompensatedPacket) - 8;
+		break;
+	      }
+
+	      /* Resampled record, derived by this program */
+	    case GM_MAG_ELEMENT_RESAMPLED_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (ResampledPacket) - 8;
+		break;
+	      }
+
+	      /* Fixed-point record, derived by this program */
+	    case GM_MAG_ELEMENT_FIXED_POINT_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (FixedPointPacket) - 8;
+		break;
+	      }
+
+	      /* FIR decimated record, written by -proto decimate */
+	    case GM_MAG_ELEMENT_FIR_DECIMATED_FORMAT:
+	      {
+		recognizedRecord = true;
+		remaining = sizeof (FirDecimatedPacket) - 8;
+		break;
+	      }
 	    }
 
 	  if (!recognizedRecord)
 	    {
-	      fclose (inputFile);
 	      break;
 	    }
 
-	  /* Read the remaining data in the record. */
-	  bytesRead = fread (recordData + 8, 1, remaining, inputFile);
+	  /* Read the remaining data in the record, into a pool buffer. */
+	  RecordRef record = pipeline.Pool ().Allocate (remaining + 8);
+	  memcpy (record.Buffer (), recordData, 8);
+	  bytesRead = fread (record.Buffer () + 8, 1, remaining, inputFile);
 
 	  if (bytesRead != remaining)
 	    {
 	      std::cerr << "Can't read remaining part of record " << counter << "\n";
 	      break;
 	    }
-	
-	  switch ((*testHeader)[0])
-	    {
-	      /* 1000Hz block packet */
-	    case GM_MFAM_DEVKIT_BLOCK_WITH_EMPTY_ADCS_NO_GPS:
-	      {
-		/* Read the rest of the data */
-		StreamerPacket *streamerPacket = (StreamerPacket *) &recordData;
-		HandleRawDataBlock (streamerPacket, counter, options, nullptr);
-	      }
-	      break;
-
-	      /* Decimated magnetometer packet */
-	    case GM_MAG_ELEMENT_DECIMATED_OUTPUT_FORMAT:
-	      {
-		IndexedMagElementDecimatedMagPacketWithHeader *decimatedPacket = (IndexedMagElementDecimatedMagPacketWithHeader *) &recordData;
-		HandleDecimatedPacket (decimatedPacket, counter, options, nullptr);
-	      }
-	      break;
 
-	      /* Heartbeat/status packet */
-	    case GM_MAG_ELEMENT_HEARTBEAT_FORMAT:
-	      {
-		GmMagElementStatusPacket *statusPacket = (GmMagElementStatusPacket*)&recordData;
-		HandleStatusPacket (statusPacket, counter, options, nullptr);
-	      }
-	      break;
+	  /* A checksum record covers the records since the one before it;
+	     it is checked here and not passed on. */
+	  if ((*testHeader)[0] == GM_MAG_ELEMENT_CHECKSUM_FORMAT)
+	    {
+	      const ChecksumPacket *packet = (const ChecksumPacket *)record.Data ();
+	      uint32_t runningBytes = checksum.Bytes ();
+	      bool match = checksum.Check (*packet);
+	      if (!match && (runningBytes != packet->mByteCount))
+		{
+		  match = CheckCoveredBytes (inputFile, *packet);
+		}
+	      if (match)
+		{
+		  checksumsVerified++;
+		}
+	      else
+		{
+		  checksumsFailed++;
+		  std::cerr << "Checksum mismatch: " << packet->mRecordCount
+			    << " records from index " << packet->mFirstPacketIndex
+			    << ", before record " << counter << "\n";
+		}
+	      continue;
 	    }
+	  checksum.Add (record.Data (), remaining + 8);
+	
+	  pipeline.Submit (record);
+	  counter++;
 	}
     }
   catch (std::exception &e) {
@@ -681,6 +1141,21 @@ int RunFileCheck (MagElementTestOptions &options, FILE *inputFile)
        a production program, will exit with some raw error information */
     std::cerr << "Exception: " << e.what() << "\n";
   }
+
+  /* Closed here, whichever way the loop ended. */
+  fclose (inputFile);
+
+  if ((checksumsVerified > 0) || (checksumsFailed > 0))
+    {
+      std::cerr << "Checksums (CRC32C, " << Crc32cImplementation () << "): "
+		<< checksumsVerified << " verified, " << checksumsFailed << " failed";
+      if (checksum.Records () > 0)
+	{
+	  std::cerr << ", " << checksum.Records () << " records after the last checksum";
+	}
+      std::cerr << "\n";
+      return (checksumsFailed > 0) ? 1 : 0;
+    }
   return 0;
 }
 
@@ -692,14 +1167,27 @@ int RunFileCheck (MagElementTestOptions &options, FILE *inputFile)
 
 int main(int argc, char* argv[])
 {
-  std::cout << "===========================================================\n";
-  std::cout << APPLICATION_NAME << " version " << EXAMPLE_VERSION << std::endl;
   MagElementTestOptions options {argc,argv};
 
+  /* With -stdout, standard output carries the records, so the text that
+     would go there goes to standard error instead. */
+  if (options.mValid && options.mStdout)
+    {
+      std::cout.rdbuf (std::cerr.rdbuf ());
+    }
+
+  /* Extract, pyramid and decode run once and may write their CSV to
+     standard output, so the banner goes to standard error and there is
+     no command prompt. */
+  bool oneShot = options.mValid && (options.mRunExtract || options.mRunPyramid || options.mRunDecode);
+  std::ostream &console = oneShot ? std::cerr : std::cout;
+  console << "===========================================================\n";
+  console << APPLICATION_NAME << " version " << EXAMPLE_VERSION << std::endl;
+
   FILE *pFile = nullptr;
   if (options.mValid && options.mFileIsValid)
     {
-      if (options.mAcceptUdp || options.mAcceptTcp)
+      if (options.mAcceptUdp || options.mAcceptTcp || options.mRunDual)
 	{
 	  pFile = fopen (options.mFileNameToSave.data(),"wb");
 
@@ -711,7 +1199,7 @@ int main(int argc, char* argv[])
 	      options.mValid = false;
 	    } ;
 	}
-      else if (options.mRunFileCheck)
+      else if (options.mRunFileCheck && !options.mFollowFile)
 	{
 	  pFile = fopen (options.mFileNameToSave.data(),"rb");
 
@@ -723,6 +1211,20 @@ int main(int argc, char* argv[])
 	      options.mValid = false;
 	    } ;
 	}
+      else if ((options.mRunPcap || options.mRunMerge) && !options.mOutputFileName.empty ())
+	{
+	  /* The records found in the capture, or the merged stream, are
+	     saved as a recording. */
+	  pFile = fopen (options.mOutputFileName.data(),"wb");
+
+	  if (pFile == nullptr)
+	    {
+	      std::cerr << "\n\nError: Output file "
+			<< options.mOutputFileName
+			<< "can't be opened to save data\n\n";
+	      options.mValid = false;
+	    } ;
+	}
     }
 
   if (!options.mValid)
@@ -733,8 +1235,11 @@ int main(int argc, char* argv[])
   else
     {
       std::cerr << "Command line arguments are valid.\n";
-      std::cout << "Press q,[ENTER] to exit.\n";
-      std::cout << "Ctrl-C forces exit without saving output file.\n";
+      if (!oneShot)
+	{
+	  std::cout << "Press q,[ENTER] to exit.\n";
+	  std::cout << "Ctrl-C forces exit without saving output file.\n";
+	}
     }
 
   if (options.mLicenseRequest)
@@ -744,21 +1249,160 @@ int main(int argc, char* argv[])
     }
   else
     {
-      std::thread commandWatcher(WaitForCommand);
-      commandWatcher.detach();
-      
+      sReceiveThread = std::this_thread::get_id ();
+      if (!oneShot)
+	{
+	  std::thread commandWatcher(WaitForCommand, (int32_t)options.mCommandCpu);
+	  commandWatcher.detach();
+	}
+
+      /* Build the processing pipeline, from the pipeline file if one was
+	 given or else from the command line.  Only the protocols that
+	 handle records as they are received, or as if they had been, use
+	 it; the other commands work on recordings directly. */
+      bool usePipeline = options.mAcceptUdp || options.mAcceptTcp || options.mRunDual ||
+	options.mRunFileCheck || options.mRunPcap || options.mRunMerge;
+      FILE *recordFile = (options.mAcceptUdp || options.mAcceptTcp || options.mRunDual ||
+			  options.mRunPcap || options.mRunMerge) ? pFile : nullptr;
+      std::unique_ptr<RecordPool> pool;
+      std::unique_ptr<Pipeline> pipeline;
+      if (usePipeline)
+	{
+	  PipelineDescription description;
+	  description.mBatchSize = options.mPipelineBatchSize;
+	  if (!options.mPipelineFileName.empty ())
+	    {
+	      if (!LoadPipelineDescription (options.mPipelineFileName, description))
+		{
+		  return 1;
+		}
+	    }
+	  else
+	    {
+	      DescribePipeline (options, description);
+	    }
+	  if (options.mThreadPerStage)
+	    {
+	      for (auto &stage : description.mStages)
+		{
+		  stage.mNewThread = true;
+		}
+	    }
+
+	  uint32_t poolSlots = options.mPoolSlots;
+	  pool = std::make_unique<RecordPool> (poolSlots);
+	  pipeline = std::make_unique<Pipeline> (*pool, description.mBatchSize, description.mQueueDepth);
+	  for (const auto &stageDescription : description.mStages)
+	    {
+	      std::unique_ptr<PipelineStage> stage = CreatePipelineStage (stageDescription, options,
+									  recordFile, *pool);
+	      if (!stage)
+		{
+		  return 1;
+		}
+	      pipeline->AddStage (std::move (stage), stageDescription.mNewThread);
+	    }
+	  pipeline->Start ();
+	}
+
+      /* Real-time settings for the receiving thread.  They come after the
+	 other threads have started, so that those don't inherit them. */
+      bool realTime = (options.mReceiveCpu >= 0) || (options.mRealTimePriority > 0) ||
+	options.mLockMemory;
+      if (options.mReceiveCpu >= 0)
+	{
+	  PinThreadToCpu (options.mReceiveCpu, "receive");
+	}
+      if (options.mRealTimePriority > 0)
+	{
+	  SetRealTimePriority (options.mRealTimeRoundRobin, options.mRealTimePriority, "receive");
+	}
+      if (options.mLockMemory)
+	{
+	  LockAllMemory ();
+	}
+      PrefaultStack ();
+      ResourceUsage processStart = ResourceUsage::Process ();
+      ResourceUsage receiveStart = ResourceUsage::CurrentThread ();
+
+      int result = 0;
       if (options.mAcceptUdp)
 	{
-	  return RunUdpClient (options, pFile);
+	  result = RunUdpClient (options, *pipeline);
 	}
       else if (options.mAcceptTcp)
 	{
-	  return RunTcpClient (options, pFile);
+	  result = RunTcpClient (options, *pipeline);
+	}
+      else if (options.mRunDual)
+	{
+	  result = RunDualCapture (options, *pipeline);
+	}
+      else if (options.mRunFileCheck && options.mFollowFile)
+	{
+	  result = RunFileFollow (options, *pipeline);
 	}
       else if (options.mRunFileCheck)
 	{
-	  return RunFileCheck (options, pFile);
+	  result = RunFileCheck (options, pFile, *pipeline);
+	}
+      else if (options.mRunReplay)
+	{
+	  result = RunReplay (options);
+	}
+      else if (options.mRunBatchCheck)
+	{
+	  result = RunBatchCheck (options);
+	}
+      else if (options.mRunExtract)
+	{
+	  result = RunExtract (options);
+	}
+      else if (options.mRunSalvage)
+	{
+	  result = RunSalvage (options);
+	}
+      else if (options.mRunPyramid)
+	{
+	  result = RunPyramid (options);
+	}
+      else if (options.mRunDecimate)
+	{
+	  result = RunDecimate (options);
+	}
+      else if (options.mRunDecode)
+	{
+	  result = RunDecode (options);
+	}
+      else if (options.mRunPcap)
+	{
+	  result = RunPcap (options, *pipeline);
+	}
+      else if (options.mRunMerge)
+	{
+	  result = RunMerge (options, *pipeline);
+	}
+
+      ResourceUsage receiveEnd = ResourceUsage::CurrentThread ();
+      if (pipeline)
+	{
+	  pipeline->Finish ();
+	  if (options.mVerboseMode)
+	    {
+	      pipeline->Report (std::cerr);
+	      pool->Report (std::cerr);
+	    }
+	}
+      if (options.mVerboseMode || realTime)
+	{
+	  ReportResourceUsage (std::cerr, "Receive thread", receiveStart, receiveEnd);
+	  ReportResourceUsage (std::cerr, "Whole program", processStart, ResourceUsage::Process ());
+	}
+      if (recordFile != nullptr)
+	{
+	  fclose (recordFile);
 	}
+      return result;
     }
   return 0;
 }
@@ -0,0 +1,44 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef TEST_CLIENT_HPP
+#define TEST_CLIENT_HPP
+
+#include <stdio.h>
+#include <memory>
+#include "Pipeline.hpp"
+#include "TestOptions.hpp"
+
+/* Functions in TestClient.cpp that are shared with the other modules
+   of the test program. */
+
+/* \brief True after the user has asked for an orderly shutdown.  Long-running
+   loops should check this and return. */
+bool ShutdownRequested ();
+
+/* \brief Sink stage that passes each record to the Handle* functions: to
+   the console (in verbose mode) if console is true, and to outputFile
+   unless that is nullptr. */
+std::unique_ptr<PipelineStage> CreateOutputStage (MagElementTestOptions &options,
+						  FILE *outputFile,
+						  bool console);
+
+#endif
@@ -20,6 +20,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 IN THE SOFTWARE.
 ******************************************************************************/
 #include <string>
+#include <cerrno>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -27,7 +29,11 @@ IN THE SOFTWARE.
 #include <vector>
 #include <filesystem>
 #include <algorithm>
+#include <thread>
 #include "TestOptions.hpp"
+#include "Fft.hpp"
+#include "FixedPoint.hpp"
+#include "StdoutSink.hpp"
 
 void ltrim(std::string &s) {
   s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
@@ -121,6 +127,66 @@ bool isValidIpAddress (const char *candidate)
   return true;
 }
 
+/* Fetch the value that follows an option, e.g. the 10 in "-rate 10". */
+static bool nextArgument (int countArgs, char *argv[], int &index, std::string &value)
+{
+  index++;
+  if (countArgs <= index)
+    {
+      return false;
+    }
+  value = std::string { argv[index] };
+  return removeQuotes (value);
+}
+
+/* Convert text to a non-negative number; the whole text must be used. */
+static bool parseNumber (const std::string &text, double &value)
+{
+  try
+    {
+      std::size_t processed = 0;
+      value = std::stod (text, &processed);
+      return (processed == text.size ()) && (value >= 0.0);
+    }
+  catch (std::exception &e)
+    {
+      return false;
+    }
+}
+
+/* Fetch a non-negative number that follows an option. */
+static bool nextNumber (int countArgs, char *argv[], int &index, double &value)
+{
+  std::string text;
+  return nextArgument (countArgs, argv, index, text) && parseNumber (text, value);
+}
+
+/* Convert text to a whole number, exactly, for values too large for a
+   double to hold; the whole text must be used. */
+static bool parseWholeNumber (const std::string &text, uint64_t &value)
+{
+  if (text.empty () || (text[0] < '0') || (text[0] > '9'))
+    {
+      return false;
+    }
+  errno = 0;
+  char *end = nullptr;
+  unsigned long long parsed = strtoull (text.c_str (), &end, 10);
+  if ((errno == ERANGE) || (*end != '\0'))
+    {
+      return false;
+    }
+  value = (uint64_t)parsed;
+  return true;
+}
+
+/* Fetch a whole number that follows an option. */
+static bool nextWholeNumber (int countArgs, char *argv[], int &index, uint64_t &value)
+{
+  std::string text;
+  return nextArgument (countArgs, argv, index, text) && parseWholeNumber (text, value);
+}
+
 MagElementTestOptions::MagElementTestOptions (int countArgs, char *argv[])
 {
   for (int index = 1; index < countArgs; index++)
@@ -157,10 +223,574 @@ MagElementTestOptions::MagElementTestOptions (int countArgs, char *argv[])
 	    {
 	      mAcceptTcp = true;
 	    }
+	  else if  (nextArg == "dual")
+	    {
+	      mRunDual = true;
+	    }
 	  else if  (nextArg == "file-check")
 	    {
 	      mRunFileCheck = true;
 	    }
+	  else if  (nextArg == "replay")
+	    {
+	      mRunReplay = true;
+	    }
+	  else if  (nextArg == "batch-check")
+	    {
+	      mRunBatchCheck = true;
+	    }
+	  else if  (nextArg == "extract")
+	    {
+	      mRunExtract = true;
+	    }
+	  else if  (nextArg == "salvage")
+	    {
+	      mRunSalvage = true;
+	    }
+	  else if  (nextArg == "pyramid")
+	    {
+	      mRunPyramid = true;
+	    }
+	  else if  (nextArg == "decimate")
+	    {
+	      mRunDecimate = true;
+	    }
+	  else if  (nextArg == "decode")
+	    {
+	      mRunDecode = true;
+	    }
+	  else if  (nextArg == "pcap")
+	    {
+	      mRunPcap = true;
+	    }
+	  else if  (nextArg == "merge")
+	    {
+	      mRunMerge = true;
+	    }
+	}
+      else if (nextArg == "-replay-proto")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) ||
+	      ((nextArg != "tcp") && (nextArg != "udp")))
+	    {
+	      std::cerr << "\n\nError: -replay-proto must be followed by tcp or udp\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mReplayUdp = (nextArg == "udp");
+	}
+      else if (nextArg == "-rate")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg))
+	    {
+	      std::cerr << "\n\nError: -rate must be followed by a positive number or max\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  if (nextArg == "max")
+	    {
+	      mReplayRate = 0.0;
+	    }
+	  else
+	    {
+	      double rate = 0.0;
+	      if (!parseNumber (nextArg, rate) || (rate == 0.0))
+		{
+		  std::cerr << "\n\nError: -rate must be followed by a positive number or max\n\n";
+		  mValid = false;
+		  return;
+		}
+	      mReplayRate = rate;
+	    }
+	}
+      else if (nextArg == "-jitter")
+	{
+	  double jitter = 0.0;
+	  if (!nextNumber (countArgs, argv, index, jitter) || !std::isfinite (jitter))
+	    {
+	      std::cerr << "\n\nError: -jitter must be followed by a number of milliseconds\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mReplayJitterMs = jitter;
+	}
+      else if (nextArg == "-loss")
+	{
+	  double loss = 0.0;
+	  if (!nextNumber (countArgs, argv, index, loss) || (loss > 100.0))
+	    {
+	      std::cerr << "\n\nError: -loss must be followed by a percentage, 0 to 100\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mReplayLossPercent = loss;
+	}
+      else if (nextArg == "-workers")
+	{
+	  double workers = 0.0;
+	  if (!nextNumber (countArgs, argv, index, workers) || (workers > 1024) ||
+	      (workers != (uint32_t)workers))
+	    {
+	      std::cerr << "\n\nError: -workers must be followed by a number, 0 (automatic) to 1024\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mWorkerCount = (uint32_t)workers;
+	}
+      else if (nextArg == "-chunk-mb")
+	{
+	  double megabytes = 0.0;
+	  if (!nextNumber (countArgs, argv, index, megabytes) || (megabytes < 1) ||
+	      (megabytes > 65536) || (megabytes != (uint32_t)megabytes))
+	    {
+	      std::cerr << "\n\nError: -chunk-mb must be followed by a number, 1 to 65536\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mChunkMegabytes = (uint32_t)megabytes;
+	}
+      else if (nextArg == "-range")
+	{
+	  uint64_t firstIndex = 0, lastIndex = 0;
+	  if (!nextWholeNumber (countArgs, argv, index, firstIndex) ||
+	      !nextWholeNumber (countArgs, argv, index, lastIndex) ||
+	      (lastIndex < firstIndex) || (lastIndex == UINT64_MAX))
+	    {
+	      std::cerr << "\n\nError: -range must be followed by the first and last packet index\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mExtractAll = false;
+	  mExtractFirst = firstIndex;
+	  mExtractLast = lastIndex;
+	}
+      else if (nextArg == "-out")
+	{
+	  if (!nextArgument (countArgs, argv, index, mOutputFileName))
+	    {
+	      std::cerr << "\n\nError: -out must be followed by a file name\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-csv")
+	{
+	  if (!nextArgument (countArgs, argv, index, mExtractFileName))
+	    {
+	      std::cerr << "\n\nError: -csv must be followed by a file name\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-reorder")
+	{
+	  double slots = 0.0;
+	  if (!nextNumber (countArgs, argv, index, slots) || (slots < 2) ||
+	      (slots > 1024) || (slots != (uint32_t)slots))
+	    {
+	      std::cerr << "\n\nError: -reorder must be followed by a number of blocks, 2 to 1024\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mReorderSlots = (uint32_t)slots;
+	}
+      else if (nextArg == "-udp-port")
+	{
+	  double port = 0.0;
+	  if (!nextNumber (countArgs, argv, index, port) || (port < 1) ||
+	      (port > 65535) || (port != (uint32_t)port))
+	    {
+	      std::cerr << "\n\nError: -udp-port must be followed by a port number, 1 to 65535\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mUdpPort = (uint32_t)port;
+	}
+      else if (nextArg == "-reorder-ms")
+	{
+	  double holdMs = 0.0;
+	  if (!nextNumber (countArgs, argv, index, holdMs) || (holdMs > 10000))
+	    {
+	      std::cerr << "\n\nError: -reorder-ms must be followed by a number of milliseconds, 0 to 10000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mReorderHoldMs = holdMs;
+	}
+      else if (nextArg == "-merge-buffer")
+	{
+	  double records = 0.0;
+	  if (!nextNumber (countArgs, argv, index, records) || (records < 16) ||
+	      (records > 1048576) || (records != (uint32_t)records))
+	    {
+	      std::cerr << "\n\nError: -merge-buffer must be followed by a number of records, 16 to 1048576\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mMergeBufferRecords = (uint32_t)records;
+	}
+      else if (nextArg == "-pixels")
+	{
+	  double pixels = 0.0;
+	  if (!nextNumber (countArgs, argv, index, pixels) || (pixels < 1) ||
+	      (pixels > 65536) || (pixels != (uint32_t)pixels))
+	    {
+	      std::cerr << "\n\nError: -pixels must be followed by a number, 1 to 65536\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPyramidPixels = (uint32_t)pixels;
+	}
+      else if (nextArg == "-rates")
+	{
+	  /* Comma separated, e.g. 100,10,1 */
+	  std::string rateList;
+	  bool ratesValid = nextArgument (countArgs, argv, index, rateList);
+	  mDecimateRates.clear ();
+	  size_t start = 0;
+	  while (ratesValid && (start <= rateList.size ()))
+	    {
+	      size_t comma = rateList.find (',', start);
+	      std::string rateText = rateList.substr (start, (comma == std::string::npos) ? std::string::npos : comma - start);
+	      char *end = nullptr;
+	      unsigned long rate = strtoul (rateText.c_str (), &end, 10);
+	      if (rateText.empty () || (*end != '\0') || (rate < 1) || (rate > 500) || ((1000 % rate) != 0))
+		{
+		  ratesValid = false;
+		  break;
+		}
+	      mDecimateRates.push_back ((uint32_t)rate);
+	      start = (comma == std::string::npos) ? rateList.size () + 1 : comma + 1;
+	    }
+	  if (!ratesValid || mDecimateRates.empty ())
+	    {
+	      std::cerr << "\n\nError: -rates must be followed by a comma separated list of output rates in Hz, each dividing 1000 (1 to 500)\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-stdout")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) || !ParseRecordTypes (nextArg, mStdoutTypes))
+	    {
+	      std::cerr << "\n\nError: -stdout must be followed by all, or a comma separated list of record types\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mStdout = true;
+	}
+      else if (nextArg == "-schema")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) ||
+	      !std::filesystem::exists (nextArg))
+	    {
+	      std::cerr << "\n\nError: -schema needs to be followed by an existing file\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mSchemaFileName = nextArg;
+	}
+      else if (nextArg == "-layout")
+	{
+	  if (!nextArgument (countArgs, argv, index, mDecodeLayout))
+	    {
+	      std::cerr << "\n\nError: -layout must be followed by the name of a record layout\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-checksum")
+	{
+	  double interval = 0.0;
+	  if (!nextNumber (countArgs, argv, index, interval) || (interval < 1) ||
+	      (interval > 1000000) || (interval != (uint32_t)interval))
+	    {
+	      std::cerr << "\n\nError: -checksum must be followed by a number of records, 1 to 1000000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mChecksumInterval = (uint32_t)interval;
+	}
+      else if (nextArg == "-stats")
+	{
+	  double window = 0.0;
+	  if (!nextNumber (countArgs, argv, index, window) || (window < 4) || (window > 10000000))
+	    {
+	      std::cerr << "\n\nError: -stats must be followed by a window length of 4 to 10000000 samples\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mStatisticsWindow = (uint32_t)window;
+	}
+      else if (nextArg == "-psd")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg))
+	    {
+	      std::cerr << "\n\nError: -psd needs to be followed by a valid file name\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPsdLogName = nextArg;
+	  mPsdEnabled = true;
+	}
+      else if (nextArg == "-psd-length")
+	{
+	  double length = 0.0;
+	  if (!nextNumber (countArgs, argv, index, length) || (length > 1048576) ||
+	      (length < 64) || (length != (uint32_t)length) ||
+	      !RealFft::IsValidLength ((uint32_t)length))
+	    {
+	      std::cerr << "\n\nError: -psd-length must be a power of two, 64 to 1048576\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPsdLength = (uint32_t)length;
+	}
+      else if (nextArg == "-psd-averages")
+	{
+	  double averages = 0.0;
+	  if (!nextNumber (countArgs, argv, index, averages) || (averages < 1) || (averages > 10000))
+	    {
+	      std::cerr << "\n\nError: -psd-averages must be followed by a number, 1 to 10000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPsdAverages = (uint32_t)averages;
+	}
+      else if (nextArg == "-gradiometer")
+	{
+	  double decimation = 0.0;
+	  if (!nextNumber (countArgs, argv, index, decimation) || (decimation < 1) ||
+	      (decimation > 1000000) || (decimation != (uint32_t)decimation))
+	    {
+	      std::cerr << "\n\nError: -gradiometer must be followed by a decimation factor, 1 to 1000000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mGradiometerEnabled = true;
+	  mGradiometerDecimation = (uint32_t)decimation;
+	}
+      else if (nextArg == "-anomaly")
+	{
+	  double factor = 0.0;
+	  if (!nextNumber (countArgs, argv, index, factor) || (factor < 1) ||
+	      (factor > 1000) || (factor != (uint32_t)factor))
+	    {
+	      std::cerr << "\n\nError: -anomaly must be followed by a threshold factor, 1 to 1000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mAnomalyFactor = (uint32_t)factor;
+	}
+      else if (nextArg == "-anomaly-rms")
+	{
+	  double window = 0.0;
+	  if (!nextNumber (countArgs, argv, index, window) || (window < 2) ||
+	      (window > 100000) || (window != (uint32_t)window))
+	    {
+	      std::cerr << "\n\nError: -anomaly-rms must be followed by a number of samples, 2 to 100000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mAnomalyWindow = (uint32_t)window;
+	}
+      else if (nextArg == "-anomaly-trend")
+	{
+	  double background = 0.0;
+	  if (!nextNumber (countArgs, argv, index, background) || (background < 2) ||
+	      (background > 10000000) || (background != (uint32_t)background))
+	    {
+	      std::cerr << "\n\nError: -anomaly-trend must be followed by a number of samples, 2 to 10000000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mAnomalyBackground = (uint32_t)background;
+	}
+      else if (nextArg == "-tl")
+	{
+	  if (!nextArgument (countArgs, argv, index, mCompensationFileName))
+	    {
+	      std::cerr << "\n\nError: -tl must be followed by a coefficients file name\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-tl-calibrate")
+	{
+	  uint64_t firstIndex = 0, lastIndex = 0;
+	  if (!nextWholeNumber (countArgs, argv, index, firstIndex) ||
+	      !nextWholeNumber (countArgs, argv, index, lastIndex) ||
+	      (lastIndex < firstIndex))
+	    {
+	      std::cerr << "\n\nError: -tl-calibrate must be followed by the first and last decimated index\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mCompensationCalibrate = true;
+	  mCompensationFirst = firstIndex;
+	  mCompensationLast = lastIndex;
+	}
+      else if (nextArg == "-tl-filter")
+	{
+	  double halfWidth = 0.0;
+	  if (!nextNumber (countArgs, argv, index, halfWidth) || (halfWidth < 1) ||
+	      (halfWidth > 100000) || (halfWidth != (uint32_t)halfWidth))
+	    {
+	      std::cerr << "\n\nError: -tl-filter must be followed by a number of samples, 1 to 100000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mCompensationFilter = (uint32_t)halfWidth;
+	}
+      else if (nextArg == "-resample")
+	{
+	  double rate = 0.0;
+	  if (!nextNumber (countArgs, argv, index, rate) || (rate < 1) ||
+	      (rate > 10000) || (rate != (uint32_t)rate))
+	    {
+	      std::cerr << "\n\nError: -resample must be followed by a rate in Hz, 1 to 10000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mResampleRate = (uint32_t)rate;
+	}
+      else if (nextArg == "-interpolation")
+	{
+	  if (!nextArgument (countArgs, argv, index, mResampleKernel) ||
+	      ((mResampleKernel != "linear") && (mResampleKernel != "cubic") && (mResampleKernel != "sinc")))
+	    {
+	      std::cerr << "\n\nError: -interpolation must be followed by linear, cubic or sinc\n\n";
+	      mValid = false;
+	      return;
+	    }
+	}
+      else if (nextArg == "-fixed")
+	{
+	  double decimation = 0.0;
+	  if (!nextNumber (countArgs, argv, index, decimation) || (decimation < 1) ||
+	      (decimation > 1000000) || (decimation != (uint32_t)decimation))
+	    {
+	      std::cerr << "\n\nError: -fixed must be followed by a decimation factor, 1 to 1000000\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mFixedDecimation = (uint32_t)decimation;
+	}
+      else if (nextArg == "-fixed-order")
+	{
+	  double order = 0.0;
+	  if (!nextNumber (countArgs, argv, index, order) || (order < 1) ||
+	      (order > FIXED_POINT_MAX_ORDER) || (order != (uint32_t)order))
+	    {
+	      std::cerr << "\n\nError: -fixed-order must be followed by a number, 1 to "
+			<< FIXED_POINT_MAX_ORDER << "\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mFixedOrder = (uint32_t)order;
+	}
+      else if (nextArg == "-pipeline")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) ||
+	      !std::filesystem::exists (nextArg))
+	    {
+	      std::cerr << "\n\nError: -pipeline needs to be followed by an existing file\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPipelineFileName = nextArg;
+	}
+      else if (nextArg == "-threads")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) ||
+	      ((nextArg != "fused") && (nextArg != "stage")))
+	    {
+	      std::cerr << "\n\nError: -threads must be followed by fused or stage\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mThreadPerStage = (nextArg == "stage");
+	}
+      else if (nextArg == "-batch")
+	{
+	  double batch = 0.0;
+	  if (!nextNumber (countArgs, argv, index, batch) || (batch < 1) ||
+	      (batch > 65536) || (batch != (uint32_t)batch))
+	    {
+	      std::cerr << "\n\nError: -batch must be followed by a number of records, 1 to 65536\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPipelineBatchSize = (uint32_t)batch;
+	}
+      else if (nextArg == "-pool-slots")
+	{
+	  double slots = 0.0;
+	  if (!nextNumber (countArgs, argv, index, slots) || (slots < 16) ||
+	      (slots > 1048576) || (slots != (uint32_t)slots))
+	    {
+	      std::cerr << "\n\nError: -pool-slots must be followed by a number, 16 to 1048576\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mPoolSlots = (uint32_t)slots;
+	}
+      else if ((nextArg == "-rx-cpu") || (nextArg == "-writer-cpu") || (nextArg == "-command-cpu"))
+	{
+	  std::string option = nextArg;
+	  uint64_t cpu = 0;
+	  unsigned int cpuCount = std::thread::hardware_concurrency ();
+	  if (!nextWholeNumber (countArgs, argv, index, cpu) || (cpu > INT32_MAX) ||
+	      ((cpuCount > 0) && (cpu >= cpuCount)))
+	    {
+	      std::cerr << "\n\nError: " << option << " must be followed by a CPU number, 0 to "
+			<< ((cpuCount > 0) ? cpuCount - 1 : 0) << "\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  if (option == "-rx-cpu")
+	    {
+	      mReceiveCpu = (int32_t)cpu;
+	    }
+	  else if (option == "-writer-cpu")
+	    {
+	      mWriterCpu = (int32_t)cpu;
+	    }
+	  else
+	    {
+	      mCommandCpu = (int32_t)cpu;
+	    }
+	}
+      else if (nextArg == "-rt-priority")
+	{
+	  double priority = 0.0;
+	  if (!nextNumber (countArgs, argv, index, priority) || (priority < 1) ||
+	      (priority > 99) || (priority != (uint32_t)priority))
+	    {
+	      std::cerr << "\n\nError: -rt-priority must be followed by a priority, 1 to 99\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mRealTimePriority = (uint32_t)priority;
+	}
+      else if (nextArg == "-rt-policy")
+	{
+	  if (!nextArgument (countArgs, argv, index, nextArg) ||
+	      ((nextArg != "fifo") && (nextArg != "rr")))
+	    {
+	      std::cerr << "\n\nError: -rt-policy must be followed by fifo or rr\n\n";
+	      mValid = false;
+	      return;
+	    }
+	  mRealTimeRoundRobin = (nextArg == "rr");
+	}
+      else if (nextArg == "-lock-memory")
+	{
+	  mLockMemory = true;
+	}
+      else if (nextArg == "-follow")
+	{
+	  mFollowFile = true;
 	}
       else if (nextArg == "-LICENSE")
 	{
@@ -287,7 +917,10 @@ MagElementTestOptions::MagElementTestOptions (int countArgs, char *argv[])
     };
 
   int protocolsChecked = (mAcceptUdp ? 1 : 0) +
-    (mAcceptTcp ? 1 : 0) + (mRunFileCheck ? 1 : 0);
+    (mAcceptTcp ? 1 : 0) + (mRunFileCheck ? 1 : 0) + (mRunReplay ? 1 : 0) +
+    (mRunBatchCheck ? 1 : 0) + (mRunExtract ? 1 : 0) + (mRunSalvage ? 1 : 0) +
+    (mRunPyramid ? 1 : 0) + (mRunPcap ? 1 : 0) + (mRunMerge ? 1 : 0) +
+    (mRunDecimate ? 1 : 0) + (mRunDual ? 1 : 0) + (mRunDecode ? 1 : 0);
 
 if (protocolsChecked != 1)
     {
@@ -314,10 +947,108 @@ if (protocolsChecked != 1)
       mValid = false;
       return;
     }
+  if (mRunDual && (!mRemotePortIsValid || !mRemoteIsValid))
+    {
+      std::cerr << "\n\nError: Dual needs the instrument's -addr and TCP -port.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunReplay && !mRemotePortIsValid)
+    {
+      std::cerr << "\n\nError: Replay port is not valid.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunReplay && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Replay needs a recording, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunBatchCheck && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Batch check needs a file, directory or pattern, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunExtract && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Extract needs a recording, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunPcap && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Pcap needs a capture file, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunPcap && !mOutputFileName.empty () && std::filesystem::exists(mOutputFileName))
+    {
+      std::cerr << "\n\nError: Output file already exists.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunMerge && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Merge needs recordings, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunMerge && !mOutputFileName.empty () && std::filesystem::exists(mOutputFileName))
+    {
+      std::cerr << "\n\nError: Output file already exists.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunPyramid && !mFileIsValid)
+    {
+      std::cerr << "\n\nError: Pyramid needs a recording, given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mFollowFile && (!mRunFileCheck || !mFileIsValid))
+    {
+      std::cerr << "\n\nError: -follow is for file-check, with the recording given with -file.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunDecimate && (!mFileIsValid || mOutputFileName.empty ()))
+    {
+      std::cerr << "\n\nError: Decimate needs a recording, given with -file, and a new file, given with -out.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunDecimate && std::filesystem::exists(mOutputFileName))
+    {
+      std::cerr << "\n\nError: Output file already exists.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mRunSalvage && (!mFileIsValid || mOutputFileName.empty ()))
+    {
+      std::cerr << "\n\nError: Salvage needs a damaged recording, given with -file, and a new file, given with -out.\n\n";
+      mValid = false;
+      return;
+    }
+  if (mRunSalvage && std::filesystem::exists(mOutputFileName))
+    {
+      std::cerr << "\n\nError: Salvage output file already exists.\n\n";
+      mValid = false;
+      return;
+    }
 
   if (mFileIsValid)
     {
-      if (mAcceptUdp || mAcceptTcp)
+      if (mAcceptUdp || mAcceptTcp || mRunDual)
 	{
 	  if (std::filesystem::exists(mFileNameToSave))
 	    {
@@ -326,16 +1057,54 @@ if (protocolsChecked != 1)
 	      return;
 	    }
 	}
-      else if (mRunFileCheck)
+      else if ((mRunFileCheck && !mFollowFile) || mRunReplay || mRunExtract || mRunSalvage || mRunPyramid ||
+	       mRunPcap || mRunDecimate || mRunDecode)
 	{
 	  if (!std::filesystem::exists(mFileNameToSave))
 	    {
-	      std::cerr << "\n\nError: File does not exist for file check.\n\n";
+	      std::cerr << "\n\nError: File does not exist for file check, replay, extract, salvage, pyramid, pcap, decimate or decode.\n\n";
 	      mValid = false;
 	      return;
 	    }
 	}
     }
+
+  if (!mExtractFileName.empty () && std::filesystem::exists(mExtractFileName))
+    {
+      std::cerr << "\n\nError: CSV file already exists.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mStdout && !(mAcceptUdp || mAcceptTcp || mRunDual || mRunFileCheck || mRunPcap || mRunMerge))
+    {
+      std::cerr << "\n\nError: -stdout needs -proto tcp, udp, dual, file-check, pcap or merge.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mCompensationCalibrate && mCompensationFileName.empty ())
+    {
+      std::cerr << "\n\nError: -tl-calibrate needs a file for the coefficients, given with -tl.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if ((mFixedDecimation > 0) &&
+      (CicDecimator::RegisterBits (mFixedDecimation, mFixedOrder) > FIXED_POINT_REGISTER_BITS))
+    {
+      std::cerr << "\n\nError: -fixed " << mFixedDecimation << " with -fixed-order " << mFixedOrder
+		<< " needs more than " << FIXED_POINT_REGISTER_BITS << " bits; lower one of them.\n\n";
+      mValid = false;
+      return;
+    }
+
+  if (mPsdEnabled && std::filesystem::exists(mPsdLogName))
+    {
+      std::cerr << "\n\nError: PSD log file already exists.\n\n";
+      mValid = false;
+      return;
+    }
 	  
   mValid = true;
 }
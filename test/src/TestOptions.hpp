@@ -22,6 +22,7 @@ IN THE SOFTWARE.
 #ifndef TEST_OPTIONS_HPP
 #define TEST_OPTIONS_HPP
 
+#include <vector>
 #include <gmplatform.h>
 
 #define MAG_ELEMENT_MAX_PATH_LENGTH   255
@@ -38,6 +39,9 @@ struct PACKED_SPEC MagElementTestOptions
   bool         mAcceptTcp = false;
   bool         mAcceptUdp = false;
   bool         mRunFileCheck = false;
+  bool         mFollowFile = false;       /* -follow: file-check a recording as it is written */
+  bool         mRunDual = false;          /* -proto dual: udp and tcp at once */
+  uint32_t     mUdpPort = 0;              /* -udp-port: for dual; 0 = -port */
   std::string  mRemote;
   bool         mRemoteIsValid = false;
   bool         mLicenseRequest = false;
@@ -45,6 +49,91 @@ struct PACKED_SPEC MagElementTestOptions
   bool         mRemotePortIsValid = false;
   bool         mValid = false;
   bool         mVerboseMode = true;
+
+  /* -proto replay */
+  bool         mRunReplay = false;
+  bool         mReplayUdp = false;
+  double       mReplayRate = 1.0;         /* Times real time; 0 = as fast as possible */
+  double       mReplayJitterMs = 0.0;
+  double       mReplayLossPercent = 0.0;
+
+  /* -proto batch-check */
+  bool         mRunBatchCheck = false;
+  uint32_t     mWorkerCount = 0;          /* -workers; 0 = one per hardware thread */
+  uint32_t     mChunkMegabytes = 64;      /* -chunk-mb: file split for parallel checking */
+
+  /* -proto salvage */
+  bool         mRunSalvage = false;
+  std::string  mOutputFileName;           /* -out: the recovered recording */
+
+  /* -proto extract */
+  bool         mRunExtract = false;
+  bool         mExtractAll = true;        /* No -range: the whole recording */
+  uint64_t     mExtractFirst = 0;         /* -range: first and last packet index */
+  uint64_t     mExtractLast = 0;
+  std::string  mExtractFileName;          /* -csv: output file; else the console */
+
+  /* -proto pcap; also uses -port and -out */
+  bool         mRunPcap = false;
+
+  /* -proto merge; also uses -out */
+  bool         mRunMerge = false;
+  uint32_t     mMergeBufferRecords = 1024; /* -merge-buffer: records held per input */
+
+  /* -proto pyramid; also uses -out, -range and -csv */
+  bool         mRunPyramid = false;
+  uint32_t     mPyramidPixels = 0;        /* -pixels: columns to print; 0 = build only */
+
+  /* -proto decimate; also uses -out and -workers */
+  bool         mRunDecimate = false;
+  std::vector<uint32_t> mDecimateRates { 100, 10, 1 }; /* -rates: output Hz, each dividing 1000 */
+
+  /* -stdout: write records to standard output; no types = all */
+  bool         mStdout = false;
+  std::vector<uint32_t> mStdoutTypes;
+
+  /* -proto decode; also uses -csv */
+  bool         mRunDecode = false;
+  std::string  mSchemaFileName;           /* -schema: record layout file */
+  std::string  mDecodeLayout = "block";   /* -layout: name of the layouts to print */
+
+  /* Processing stages; 0 = off */
+  uint32_t     mStatisticsWindow = 0;     /* -stats: window length in samples */
+  bool         mPsdEnabled = false;       /* -psd: Welch PSD log file name */
+  std::string  mPsdLogName;
+  uint32_t     mPsdLength = 4096;         /* -psd-length: FFT length, samples */
+  uint32_t     mPsdAverages = 8;          /* -psd-averages: segments per estimate */
+  bool         mGradiometerEnabled = false;
+  uint32_t     mGradiometerDecimation = 1; /* -gradiometer: raw samples per output */
+  uint32_t     mAnomalyFactor = 0;        /* -anomaly: threshold, spreads above the noise level */
+  uint32_t     mAnomalyWindow = 20;       /* -anomaly-rms: RMS window, samples */
+  uint32_t     mAnomalyBackground = 2000; /* -anomaly-trend: trend window, samples */
+  std::string  mCompensationFileName;     /* -tl: Tolles-Lawson coefficients file */
+  bool         mCompensationCalibrate = false;
+  uint64_t     mCompensationFirst = 0;    /* -tl-calibrate: first and last decimated index */
+  uint64_t     mCompensationLast = 0;
+  uint32_t     mCompensationFilter = 50;  /* -tl-filter: high-pass half width, samples */
+  uint32_t     mResampleRate = 0;         /* -resample: output samples a second */
+  std::string  mResampleKernel = "cubic"; /* -interpolation: linear, cubic or sinc */
+  uint32_t     mFixedDecimation = 0;      /* -fixed: CIC decimation factor */
+  uint32_t     mFixedOrder = 3;           /* -fixed-order: CIC stages */
+
+  /* Processing pipeline */
+  std::string  mPipelineFileName;         /* -pipeline: stages, threads and batching */
+  bool         mThreadPerStage = false;   /* -threads stage; else fused */
+  uint32_t     mPipelineBatchSize = 8;    /* -batch: records per hop between threads */
+  uint32_t     mPoolSlots = 2048;         /* -pool-slots: buffers per record size */
+  uint32_t     mChecksumInterval = 0;     /* -checksum: records per CRC32C record; 0 = none */
+  uint32_t     mReorderSlots = 0;         /* -reorder: UDP reorder window, blocks; 0 = off */
+  double       mReorderHoldMs = 50.0;     /* -reorder-ms: longest wait for a missing block */
+
+  /* Real-time settings; CPU -1 = not pinned, priority 0 = normal scheduling */
+  int32_t      mReceiveCpu = -1;          /* -rx-cpu */
+  int32_t      mWriterCpu = -1;           /* -writer-cpu */
+  int32_t      mCommandCpu = -1;          /* -command-cpu */
+  uint32_t     mRealTimePriority = 0;     /* -rt-priority, 1 to 99 */
+  bool         mRealTimeRoundRobin = false; /* -rt-policy rr; else fifo */
+  bool         mLockMemory = false;       /* -lock-memory */
 } ALIGN_1_SPEC;
 
 #endif
@@ -0,0 +1,321 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "SimdKernels.hpp"
+#include "TollesLawson.hpp"
+
+/* Starting variance of each coefficient, in nT squared per unit term. */
+#define TOLLES_LAWSON_INITIAL_VARIANCE 1.0e6
+
+bool TollesLawsonTerms::Compute (float x, float y, float z, double terms[TOLLES_LAWSON_TERMS])
+{
+  double total = std::sqrt ((double)x * x + (double)y * y + (double)z * z);
+  if (total == 0.0)
+    {
+      return false;
+    }
+  double cosine[3] = { x / total, y / total, z / total };
+  double change[3] = { 0.0, 0.0, 0.0 };
+  if (mHavePrevious)
+    {
+      for (int axis = 0; axis < 3; axis++)
+	{
+	  change[axis] = cosine[axis] - mPrevious[axis];
+	}
+    }
+  memcpy (mPrevious, cosine, sizeof (mPrevious));
+  mHavePrevious = true;
+
+  /* Permanent */
+  terms[0] = cosine[0];
+  terms[1] = cosine[1];
+  terms[2] = cosine[2];
+  /* Induced */
+  terms[3] = cosine[0] * cosine[0];
+  terms[4] = cosine[0] * cosine[1];
+  terms[5] = cosine[0] * cosine[2];
+  terms[6] = cosine[1] * cosine[1];
+  terms[7] = cosine[1] * cosine[2];
+  /* Eddy current */
+  terms[8] = cosine[0] * change[0];
+  terms[9] = cosine[0] * change[1];
+  terms[10] = cosine[0] * change[2];
+  terms[11] = cosine[1] * change[0];
+  terms[12] = cosine[1] * change[1];
+  terms[13] = cosine[1] * change[2];
+  terms[14] = cosine[2] * change[0];
+  terms[15] = cosine[2] * change[1];
+  return true;
+}
+
+
+RecursiveLeastSquares::RecursiveLeastSquares (uint32_t size, double initialVariance)
+  : mSize (size),
+    mInverse ((size_t)size * size, 0.0),
+    mCoefficients (size, 0.0),
+    mProduct (size, 0.0)
+{
+  for (uint32_t row = 0; row < size; row++)
+    {
+      mInverse[(size_t)row * size + row] = initialVariance;
+    }
+}
+
+void RecursiveLeastSquares::Add (const double *x, double y)
+{
+  for (uint32_t row = 0; row < mSize; row++)
+    {
+      mProduct[row] = DotProduct (&mInverse[(size_t)row * mSize], x, mSize);
+    }
+  double denominator = 1.0 + DotProduct (x, mProduct.data (), mSize);
+  double error = y - DotProduct (x, mCoefficients.data (), mSize);
+
+  /* c += P x e / (1 + x'P x);  P -= P x x'P / (1 + x'P x) */
+  AddScaled (mProduct.data (), error / denominator, mCoefficients.data (), mSize);
+  for (uint32_t row = 0; row < mSize; row++)
+    {
+      AddScaled (mProduct.data (), -mProduct[row] / denominator, &mInverse[(size_t)row * mSize], mSize);
+    }
+  mCount++;
+}
+
+
+MovingMeanHighPass::MovingMeanHighPass (uint32_t channels, uint32_t halfWidth)
+  : mChannels (channels), mHalfWidth (halfWidth), mLength (2 * halfWidth + 1),
+    mRing ((size_t)mLength * channels, 0.0), mSums (channels, 0.0)
+{
+}
+
+bool MovingMeanHighPass::Add (const double *input, double *output)
+{
+  uint64_t sequence = mSeen++;
+  double *slot = &mRing[(size_t)(sequence % mLength) * mChannels];
+  for (uint32_t channel = 0; channel < mChannels; channel++)
+    {
+      mSums[channel] += input[channel] - slot[channel];
+      slot[channel] = input[channel];
+    }
+  /* Sums are recomputed once per pass through the ring, so that rounding
+     can't build up. */
+  if ((sequence % mLength) == mLength - 1)
+    {
+      for (uint32_t channel = 0; channel < mChannels; channel++)
+	{
+	  double sum = 0.0;
+	  for (uint32_t sample = 0; sample < mLength; sample++)
+	    {
+	      sum += mRing[(size_t)sample * mChannels + channel];
+	    }
+	  mSums[channel] = sum;
+	}
+    }
+  if (sequence + 1 < mLength)
+    {
+      return false;
+    }
+  const double *middle = &mRing[(size_t)((sequence - mHalfWidth) % mLength) * mChannels];
+  for (uint32_t channel = 0; channel < mChannels; channel++)
+    {
+      output[channel] = middle[channel] - mSums[channel] / mLength;
+    }
+  return true;
+}
+
+void MovingMeanHighPass::Reset ()
+{
+  std::fill (mRing.begin (), mRing.end (), 0.0);
+  std::fill (mSums.begin (), mSums.end (), 0.0);
+  mSeen = 0;
+}
+
+
+CompensationProcessor::CompensationProcessor (const std::string &fileName, uint32_t highPassHalfWidth)
+  : mFileName (fileName),
+    mHighPass (TOLLES_LAWSON_TERMS + 1, highPassHalfWidth),
+    mFit (TOLLES_LAWSON_TERMS, TOLLES_LAWSON_INITIAL_VARIANCE)
+{
+  memset (&mPacket, 0, sizeof (mPacket));
+  mPacket.mRecordType = GM_MAG_ELEMENT_COMPENSATED_FORMAT;
+  mPacket.mRecordSize = sizeof (CompensatedPacket);
+}
+
+void CompensationProcessor::SetCalibration (uint64_t first, uint64_t last)
+{
+  mCalibrating = true;
+  mCalibrationFirst = first;
+  mCalibrationLast = last;
+}
+
+bool CompensationProcessor::Load ()
+{
+  std::ifstream input (mFileName);
+  if (!input)
+    {
+      std::cerr << "\n\nError: Tolles-Lawson file " << mFileName << " can't be opened\n\n";
+      return false;
+    }
+  std::string line;
+  std::vector<double> values;
+  uint32_t terms = 0;
+  uint32_t samples = 0;
+  while (std::getline (input, line))
+    {
+      size_t comment = line.find ('#');
+      if (comment != std::string::npos)
+	{
+	  line.erase (comment);
+	}
+      std::istringstream words (line);
+      std::string keyword;
+      if (!(words >> keyword))
+	{
+	  continue;
+	}
+      if (keyword == "terms")
+	{
+	  words >> terms;
+	}
+      else if (keyword == "samples")
+	{
+	  words >> samples;
+	}
+      else
+	{
+	  char *end = nullptr;
+	  double value = strtod (keyword.c_str (), &end);
+	  if (*end != '\0')
+	    {
+	      break;
+	    }
+	  values.push_back (value);
+	}
+    }
+  if ((terms != TOLLES_LAWSON_TERMS) || (values.size () != TOLLES_LAWSON_TERMS))
+    {
+      std::cerr << "\n\nError: Tolles-Lawson file " << mFileName << " doesn't hold "
+		<< TOLLES_LAWSON_TERMS << " coefficients\n\n";
+      return false;
+    }
+  memcpy (mCoefficients, values.data (), sizeof (mCoefficients));
+  mCalibrationSamples = samples;
+  mHaveCoefficients = true;
+  return true;
+}
+
+bool CompensationProcessor::Save ()
+{
+  std::ofstream output (mFileName);
+  output << "# MagElement Tolles-Lawson coefficients: permanent x y z, induced xx xy xz yy yz,\n"
+	 << "# eddy x.dx x.dy x.dz y.dx y.dy y.dz z.dx z.dy\n"
+	 << "terms " << TOLLES_LAWSON_TERMS << "\n"
+	 << "samples " << mCalibrationSamples << "\n"
+	 << std::setprecision (17);
+  for (double coefficient : mCoefficients)
+    {
+      output << coefficient << "\n";
+    }
+  if (!output)
+    {
+      std::cerr << "\n\nError: Tolles-Lawson file " << mFileName << " can't be written\n\n";
+      return false;
+    }
+  return true;
+}
+
+void CompensationProcessor::EndCalibration ()
+{
+  mCalibrating = false;
+  if (mFit.Count () < TOLLES_LAWSON_TERMS)
+    {
+      std::cerr << "\n\nError: Tolles-Lawson calibration had " << mFit.Count ()
+		<< " samples, too few for " << TOLLES_LAWSON_TERMS << " coefficients\n\n";
+      return;
+    }
+  memcpy (mCoefficients, mFit.Coefficients (), sizeof (mCoefficients));
+  mCalibrationSamples = (uint32_t)mFit.Count ();
+  mHaveCoefficients = true;
+  if (Save ())
+    {
+      std::cerr << "Tolles-Lawson: fitted to " << mCalibrationSamples << " samples, saved to "
+		<< mFileName << "\n";
+    }
+}
+
+void CompensationProcessor::HandleDecimatedPacket (const IndexedMagElementDecimatedMagPacketWithHeader &decimatedPacket)
+{
+  const MagElementDecimatedMagPacket &packet = decimatedPacket.mIndexedPacket.mPacket;
+  uint64_t index = decimatedPacket.mIndexedPacket.mIndex;
+  double terms[TOLLES_LAWSON_TERMS];
+  if (!mTerms.Compute (packet.mCompassX, packet.mCompassY, packet.mCompassZ, terms))
+    {
+      return;
+    }
+
+  if (mCalibrating)
+    {
+      if (index < mCalibrationFirst)
+	{
+	  return;
+	}
+      if (index <= mCalibrationLast)
+	{
+	  double channels[TOLLES_LAWSON_TERMS + 1];
+	  double filtered[TOLLES_LAWSON_TERMS + 1];
+	  memcpy (channels, terms, sizeof (terms));
+	  channels[TOLLES_LAWSON_TERMS] = packet.mMagData;
+	  if (mHighPass.Add (channels, filtered))
+	    {
+	      mFit.Add (filtered, filtered[TOLLES_LAWSON_TERMS]);
+	    }
+	  return;
+	}
+      EndCalibration ();
+    }
+  if (!mHaveCoefficients)
+    {
+      return;
+    }
+
+  double correction = DotProduct (mCoefficients, terms, TOLLES_LAWSON_TERMS);
+  mPacket.mIndex = index;
+  mPacket.mMagData = packet.mMagData;
+  mPacket.mCorrection = correction;
+  mPacket.mCompensated = packet.mMagData - correction;
+  mPacket.mCalibrationSamples = mCalibrationSamples;
+  Emit (&mPacket, sizeof (mPacket));
+}
+
+void CompensationProcessor::Finish ()
+{
+  /* The data ended during the calibration. */
+  if (mCalibrating && (mFit.Count () > 0))
+    {
+      EndCalibration ();
+    }
+}
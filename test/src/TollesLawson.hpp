@@ -0,0 +1,139 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef TOLLES_LAWSON_HPP
+#define TOLLES_LAWSON_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "DerivedRecords.hpp"
+#include "RecordProcessor.hpp"
+
+/* Terms of the Tolles-Lawson model of the field of the platform: 3
+   permanent (the direction cosines of the field in the platform's frame,
+   from the compass), 5 induced (their products; zz is left out, since
+   xx + yy + zz = 1) and 8 eddy current (each cosine times the change in
+   each cosine since the sample before; z dz is left out, since
+   x dx + y dy + z dz = 0).  The total field hardly changes over a survey,
+   so it is folded into the induced and eddy coefficients. */
+#define TOLLES_LAWSON_TERMS 16
+
+class TollesLawsonTerms
+{
+public:
+  /* \brief Compute the terms from the next compass vector.
+     \return  false if the vector is zero, when the terms are left alone. */
+  bool Compute (float x, float y, float z, double terms[TOLLES_LAWSON_TERMS]);
+  void Reset () { mHavePrevious = false; }
+
+private:
+  bool   mHavePrevious = false;
+  double mPrevious[3] = {};
+};
+
+/* Recursive least squares: the coefficients that best fit y = x . c to
+   the samples so far, updated in O(size^2) per sample, with no matrix
+   inversion.  The inverse correlation matrix starts at initialVariance
+   times the identity, which keeps terms that the calibration doesn't
+   excite near zero rather than letting them grow without bound. */
+class RecursiveLeastSquares
+{
+public:
+  RecursiveLeastSquares (uint32_t size, double initialVariance);
+
+  void          Add (const double *x, double y);
+  const double *Coefficients () const { return mCoefficients.data (); }
+  uint64_t      Count () const { return mCount; }
+
+private:
+  uint32_t            mSize;
+  std::vector<double> mInverse;        /* size x size, symmetric */
+  std::vector<double> mCoefficients;
+  std::vector<double> mProduct;        /* mInverse x */
+  uint64_t            mCount = 0;
+};
+
+/* Removes the moving mean over 2 * halfWidth + 1 samples from each of a
+   number of channels, so that the slowly changing geological and diurnal
+   field drops out of the calibration while the platform's manoeuvres
+   remain.  The output is that of the middle sample, halfWidth samples
+   behind the input. */
+class MovingMeanHighPass
+{
+public:
+  MovingMeanHighPass (uint32_t channels, uint32_t halfWidth);
+
+  /* \return  true once output holds the filtered sample halfWidth back. */
+  bool Add (const double *input, double *output);
+  void Reset ();
+
+private:
+  uint32_t            mChannels;
+  uint32_t            mHalfWidth;
+  uint32_t            mLength;
+  std::vector<double> mRing;           /* mLength samples of mChannels */
+  std::vector<double> mSums;
+  uint64_t            mSeen = 0;
+};
+
+/* Tolles-Lawson compensation of the decimated mag data.  With a
+   calibration range of indices, the coefficients are fitted to the
+   high-passed samples in that range as they arrive, written to the
+   coefficient file at its end, and used from then on; without one, they
+   are read from the file.  Each compensated sample is emitted as a
+   CompensatedPacket. */
+class CompensationProcessor : public RecordProcessor
+{
+public:
+  CompensationProcessor (const std::string &fileName, uint32_t highPassHalfWidth);
+
+  /* \brief Fit the coefficients to the decimated records with index
+     first to last, instead of reading them. */
+  void SetCalibration (uint64_t first, uint64_t last);
+
+  /* \brief Read the coefficients file; not needed when calibrating.
+     \return  false, with a message on cerr, if it can't be read. */
+  bool Load ();
+
+  void HandleDecimatedPacket (const IndexedMagElementDecimatedMagPacketWithHeader &decimatedPacket) override;
+  void Finish () override;
+
+private:
+  bool Save ();
+  void EndCalibration ();
+
+  std::string           mFileName;
+  bool                  mCalibrating = false;
+  uint64_t              mCalibrationFirst = 0;
+  uint64_t              mCalibrationLast = 0;
+
+  TollesLawsonTerms     mTerms;
+  MovingMeanHighPass    mHighPass;
+  RecursiveLeastSquares mFit;
+
+  bool                  mHaveCoefficients = false;
+  double                mCoefficients[TOLLES_LAWSON_TERMS] = {};
+  uint32_t              mCalibrationSamples = 0;
+  CompensatedPacket     mPacket;
+};
+
+#endif
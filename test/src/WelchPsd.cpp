@@ -0,0 +1,268 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include "DecodedColumns.hpp"
+#include "SimdKernels.hpp"
+#include "WelchPsd.hpp"
+
+static const double sPi = 3.14159265358979323846;
+
+/* Bands for the noise figures, centred on 1, 10 and 100 Hz. */
+static const float sBandLowHz[PSD_LOG_BAND_COUNT]  = { 0.75f, 7.5f, 75.0f };
+static const float sBandHighHz[PSD_LOG_BAND_COUNT] = { 1.25f, 12.5f, 125.0f };
+
+WelchEstimator::WelchEstimator (uint32_t segmentLength, uint32_t averages)
+  : mSegmentLength (segmentLength),
+    mAverages (averages > 0 ? averages : 1),
+    mFft (segmentLength),
+    mWindow (segmentLength),
+    mBuffer (segmentLength),
+    mSegment (segmentLength),
+    mRe (segmentLength / 2 + 1),
+    mIm (segmentLength / 2 + 1),
+    mPowerSum (segmentLength / 2 + 1, 0.0),
+    mCompleted (segmentLength / 2 + 1, 0.0)
+{
+  /* Periodic Hann window. */
+  mWindowPower = 0.0;
+  for (uint32_t index = 0; index < mSegmentLength; index++)
+    {
+      mWindow[index] = 0.5 - 0.5 * std::cos (2.0 * sPi * index / mSegmentLength);
+      mWindowPower += mWindow[index] * mWindow[index];
+    }
+}
+
+void WelchEstimator::Restart ()
+{
+  mFill = 0;
+}
+
+bool WelchEstimator::Add (double value, uint64_t packetIndex)
+{
+  if (mFill == 0)
+    {
+      mBufferFirstIndex = packetIndex;
+    }
+  mBuffer[mFill++] = value;
+  mLastIndex = packetIndex;
+  if (mFill < mSegmentLength)
+    {
+      return false;
+    }
+
+  ProcessSegment ();
+
+  /* Keep the second half as the first half of the next segment. */
+  uint32_t hop = mSegmentLength / 2;
+  memmove (mBuffer.data (), mBuffer.data () + hop, (mSegmentLength - hop) * sizeof (double));
+  mFill = mSegmentLength - hop;
+  mBufferFirstIndex += hop;
+
+  if (mSegments < mAverages)
+    {
+      return false;
+    }
+  mCompleted.swap (mPowerSum);
+  mCompletedSegments = mSegments;
+  mCompletedFirstIndex = mFirstIndex;
+  mCompletedLastIndex = mLastIndex;
+  std::fill (mPowerSum.begin (), mPowerSum.end (), 0.0);
+  mSegments = 0;
+  return true;
+}
+
+void WelchEstimator::ProcessSegment ()
+{
+  /* Remove the mean, so that the large field value doesn't leak from DC
+     through the window sidelobes. */
+  double sum = 0.0;
+  for (uint32_t index = 0; index < mSegmentLength; index++)
+    {
+      sum += mBuffer[index];
+    }
+  double mean = sum / mSegmentLength;
+  for (uint32_t index = 0; index < mSegmentLength; index++)
+    {
+      mSegment[index] = mBuffer[index] - mean;
+    }
+  MultiplyArrays (mSegment.data (), mWindow.data (), mSegment.data (), mSegmentLength);
+  mFft.Forward (mSegment.data (), mRe.data (), mIm.data ());
+  AccumulatePower (mRe.data (), mIm.data (), mPowerSum.data (), mFft.BinCount ());
+
+  if (mSegments == 0)
+    {
+      mFirstIndex = mBufferFirstIndex;
+    }
+  mSegments++;
+}
+
+void WelchEstimator::Density (double sampleRateHz, std::vector<double> &density) const
+{
+  uint32_t bins = BinCount ();
+  density.resize (bins);
+  double scale = 1.0 / (mCompletedSegments * sampleRateHz * mWindowPower);
+  for (uint32_t bin = 0; bin < bins; bin++)
+    {
+      /* One-sided: fold the negative frequencies in, except at DC and Nyquist. */
+      double fold = ((bin == 0) || (bin == bins - 1)) ? 1.0 : 2.0;
+      density[bin] = mCompleted[bin] * scale * fold;
+    }
+}
+
+
+PsdProcessor::PsdProcessor (uint32_t segmentLength, uint32_t averages)
+  : mMag1 (segmentLength, averages),
+    mMag2 (segmentLength, averages),
+    mDensity (segmentLength / 2 + 1),
+    mAmplitude (segmentLength / 2 + 1)
+{
+}
+
+bool PsdProcessor::OpenLog (const std::string &fileName)
+{
+  mLog = fopen (fileName.c_str (), "wb");
+  if (mLog == nullptr)
+    {
+      std::cerr << "\n\nError: PSD log " << fileName << " can't be created.\n\n";
+      return false;
+    }
+  PsdLogHeader header;
+  memcpy (header.mMagic, PSD_LOG_MAGIC, sizeof (header.mMagic));
+  header.mHeaderSize = sizeof (PsdLogHeader);
+  header.mSegmentLength = (mMag1.BinCount () - 1) * 2;
+  header.mBinCount = mMag1.BinCount ();
+  header.mBandCount = PSD_LOG_BAND_COUNT;
+  for (int band = 0; band < PSD_LOG_BAND_COUNT; band++)
+    {
+      header.mBandLowHz[band] = sBandLowHz[band];
+      header.mBandHighHz[band] = sBandHighHz[band];
+    }
+  fwrite (&header, 1, sizeof (header), mLog);
+  return true;
+}
+
+void PsdProcessor::HandleRawDataBlock (const StreamerPacket &streamerPacket)
+{
+  DecodedRawBlock decoded;
+  DecodeRawBlock (streamerPacket, decoded);
+
+  /* A missing block breaks the time series; start new segments. */
+  if (mHaveIndex && (decoded.mFirstPacketIndex != mNextIndex))
+    {
+      mMag1.Restart ();
+      mMag2.Restart ();
+    }
+  mHaveIndex = true;
+  mNextIndex = decoded.mFirstPacketIndex + MFAM_STREAMER_CACHE_SIZE;
+
+  for (int index = 0; index < MFAM_STREAMER_CACHE_SIZE; index++)
+    {
+      uint64_t packetIndex = decoded.mFirstPacketIndex + index;
+      if (!decoded.mMag1Valid[index])
+	{
+	  mMag1.Restart ();
+	}
+      else if (mMag1.Add ((double)decoded.mMag1[index], packetIndex))
+	{
+	  Publish (mMag1, 1);
+	}
+      if (!decoded.mMag2Valid[index])
+	{
+	  mMag2.Restart ();
+	}
+      else if (mMag2.Add ((double)decoded.mMag2[index], packetIndex))
+	{
+	  Publish (mMag2, 2);
+	}
+    }
+}
+
+void PsdProcessor::HandleStatusPacket (const GmMagElementStatusPacket &statusPacket)
+{
+  if ((statusPacket.mSamplePeriod > 0) && (statusPacket.mSamplePeriod <= 1000))
+    {
+      mSampleRateHz = 1000.0 / statusPacket.mSamplePeriod;
+    }
+}
+
+void PsdProcessor::Publish (WelchEstimator &estimator, uint32_t channel)
+{
+  estimator.Density (mSampleRateHz, mDensity);
+
+  /* LSB^2/Hz to pT/sqrt(Hz). */
+  const double toPicoTesla = MFAM_NANOTESLAS_PER_LSB * 1000.0;
+  uint32_t bins = estimator.BinCount ();
+  double binWidth = mSampleRateHz / ((bins - 1) * 2);
+  for (uint32_t bin = 0; bin < bins; bin++)
+    {
+      mAmplitude[bin] = (float)(std::sqrt (mDensity[bin]) * toPicoTesla);
+    }
+
+  PsdLogRecord record;
+  record.mFirstPacketIndex = estimator.FirstPacketIndex ();
+  record.mLastPacketIndex = estimator.LastPacketIndex ();
+  record.mChannel = channel;
+  record.mSegmentsAveraged = estimator.SegmentsAveraged ();
+  record.mSampleRateHz = (float)mSampleRateHz;
+
+  std::ostringstream line;
+  line << "PSD mag" << channel << " at index " << record.mLastPacketIndex << " [pT/rtHz]:";
+  line << std::setprecision (4);
+  for (int band = 0; band < PSD_LOG_BAND_COUNT; band++)
+    {
+      double sum = 0.0;
+      uint32_t count = 0;
+      for (uint32_t bin = 1; bin < bins; bin++)
+	{
+	  double frequency = bin * binWidth;
+	  if ((frequency >= sBandLowHz[band]) && (frequency <= sBandHighHz[band]))
+	    {
+	      sum += mDensity[bin];
+	      count++;
+	    }
+	}
+      /* Bands above Nyquist, or narrower than one bin, are reported as 0. */
+      double noise = (count > 0) ? std::sqrt (sum / count) * toPicoTesla : 0.0;
+      record.mBandNoise[band] = (float)noise;
+      line << " " << (sBandLowHz[band] + sBandHighHz[band]) / 2 << "Hz=" << noise;
+    }
+  std::cout << line.str () << "\n";
+
+  if (mLog != nullptr)
+    {
+      fwrite (&record, 1, sizeof (record), mLog);
+      fwrite (mAmplitude.data (), sizeof (float), bins, mLog);
+    }
+}
+
+void PsdProcessor::Finish ()
+{
+  if (mLog != nullptr)
+    {
+      fclose (mLog);
+      mLog = nullptr;
+    }
+}
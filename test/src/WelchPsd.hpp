@@ -0,0 +1,146 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef WELCH_PSD_HPP
+#define WELCH_PSD_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "gmplatform.h"
+#include "Fft.hpp"
+#include "RecordProcessor.hpp"
+
+/* ================================================
+ * Binary PSD log, written by -psd.  The file starts with one
+ * PsdLogHeader; each averaged spectrum is then one PsdLogRecord followed
+ * by mBinCount floats, the amplitude spectral density in pT/sqrt(Hz) from
+ * DC to the Nyquist frequency.  All values are little-endian.
+ */
+#define PSD_LOG_MAGIC       "MEPSDLG1"
+#define PSD_LOG_BAND_COUNT  3
+
+PACKED_PRAGMA
+struct PACKED_SPEC PsdLogHeader
+{
+  char     mMagic[8];                          /* PSD_LOG_MAGIC, no terminator */
+  uint32_t mHeaderSize;                        /* sizeof (PsdLogHeader) */
+  uint32_t mSegmentLength;                     /* FFT length, samples */
+  uint32_t mBinCount;                          /* mSegmentLength / 2 + 1 */
+  uint32_t mBandCount;                         /* PSD_LOG_BAND_COUNT */
+  float    mBandLowHz[PSD_LOG_BAND_COUNT];     /* Limits of the noise figures */
+  float    mBandHighHz[PSD_LOG_BAND_COUNT];
+} ALIGN_1_SPEC;
+
+PACKED_PRAGMA
+struct PACKED_SPEC PsdLogRecord
+{
+  uint64_t mFirstPacketIndex;                  /* First sample of the first segment */
+  uint64_t mLastPacketIndex;                   /* Last sample of the last segment */
+  uint32_t mChannel;                           /* 1 = mag1, 2 = mag2 */
+  uint32_t mSegmentsAveraged;
+  float    mSampleRateHz;
+  float    mBandNoise[PSD_LOG_BAND_COUNT];     /* pT/sqrt(Hz), mean power over each band */
+} ALIGN_1_SPEC;
+
+static_assert ((sizeof(PsdLogHeader) == 48),"Not expected size");
+static_assert ((sizeof(PsdLogRecord) == 40),"Not expected size");
+
+/* Welch estimate of the power spectral density of one channel: Hann-windowed
+   segments of segmentLength samples, overlapped by half, with averages
+   segments per estimate.  All buffers are allocated by the constructor. */
+class WelchEstimator
+{
+public:
+  WelchEstimator (uint32_t segmentLength, uint32_t averages);
+
+  /* \brief Add the next sample.
+     \return  true when an averaged spectrum has just been completed; read it
+     with Density() before adding more samples. */
+  bool Add (double value, uint64_t packetIndex);
+
+  /* Forget any partial segment, e.g. after a gap or an invalid sample. */
+  void Restart ();
+
+  /* One-sided power spectral density of the last completed estimate, in
+     input units squared per Hz, for the given sample rate. */
+  void Density (double sampleRateHz, std::vector<double> &density) const;
+
+  uint32_t BinCount () const { return mFft.BinCount (); }
+  uint32_t SegmentsAveraged () const { return mCompletedSegments; }
+  uint64_t FirstPacketIndex () const { return mCompletedFirstIndex; }
+  uint64_t LastPacketIndex () const { return mCompletedLastIndex; }
+
+private:
+  void ProcessSegment ();
+
+  uint32_t            mSegmentLength;
+  uint32_t            mAverages;
+  RealFft             mFft;
+  std::vector<double> mWindow;
+  double              mWindowPower;      /* Sum of squared window values */
+  std::vector<double> mBuffer;           /* Samples of the segment being filled */
+  uint32_t            mFill = 0;
+  uint64_t            mBufferFirstIndex = 0;
+  uint64_t            mLastIndex = 0;
+  std::vector<double> mSegment;
+  std::vector<double> mRe;
+  std::vector<double> mIm;
+  std::vector<double> mPowerSum;
+  uint32_t            mSegments = 0;
+  uint64_t            mFirstIndex = 0;
+
+  std::vector<double> mCompleted;        /* Power sum of the last full average */
+  uint32_t            mCompletedSegments = 0;
+  uint64_t            mCompletedFirstIndex = 0;
+  uint64_t            mCompletedLastIndex = 0;
+};
+
+/* Welch PSD of mag1 and mag2 from the 1000Hz blocks.  Each averaged spectrum
+   is appended to the binary PSD log and summarized on the console as noise
+   figures in pT/sqrt(Hz) near 1, 10 and 100 Hz. */
+class PsdProcessor : public RecordProcessor
+{
+public:
+  PsdProcessor (uint32_t segmentLength, uint32_t averages);
+
+  /* \return  false if the log file can't be created. */
+  bool OpenLog (const std::string &fileName);
+
+  void HandleRawDataBlock (const StreamerPacket &streamerPacket) override;
+  void HandleStatusPacket (const GmMagElementStatusPacket &statusPacket) override;
+  void Finish () override;
+
+private:
+  void Publish (WelchEstimator &estimator, uint32_t channel);
+
+  WelchEstimator      mMag1;
+  WelchEstimator      mMag2;
+  double              mSampleRateHz = 1000.0;
+  bool                mHaveIndex = false;
+  uint64_t            mNextIndex = 0;
+  FILE               *mLog = nullptr;
+  std::vector<double> mDensity;
+  std::vector<float>  mAmplitude;
+};
+
+#endif
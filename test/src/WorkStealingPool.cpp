@@ -0,0 +1,149 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#include "WorkStealingPool.hpp"
+
+/* The pool and worker that the calling thread belongs to, if any. */
+static thread_local WorkStealingPool *sCurrentPool = nullptr;
+static thread_local uint32_t          sCurrentWorker = 0;
+
+WorkStealingPool::WorkStealingPool (uint32_t workers)
+{
+  if (workers == 0)
+    {
+      workers = std::thread::hardware_concurrency ();
+    }
+  if (workers == 0)
+    {
+      workers = 1;
+    }
+  for (uint32_t index = 0; index < workers; index++)
+    {
+      mWorkers.push_back (std::make_unique<Worker> ());
+    }
+  for (uint32_t index = 0; index < workers; index++)
+    {
+      mThreads.emplace_back (&WorkStealingPool::Run, this, index);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool ()
+{
+  Wait ();
+  {
+    std::lock_guard<std::mutex> lock (mSleepMutex);
+    mStopping = true;
+  }
+  mWake.notify_all ();
+  for (std::thread &thread : mThreads)
+    {
+      thread.join ();
+    }
+}
+
+void WorkStealingPool::Submit (Task task)
+{
+  uint32_t target;
+  if (sCurrentPool == this)
+    {
+      target = sCurrentWorker;
+    }
+  else
+    {
+      target = mNextWorker.fetch_add (1) % mWorkers.size ();
+    }
+
+  /* Counted first, so that the count never drops below the number of
+     queued tasks, and under the sleep mutex, so that a worker about to
+     sleep sees it. */
+  mPending.fetch_add (1);
+  {
+    std::lock_guard<std::mutex> lock (mSleepMutex);
+    mQueued.fetch_add (1);
+  }
+  {
+    std::lock_guard<std::mutex> lock (mWorkers[target]->mMutex);
+    mWorkers[target]->mTasks.push_back (std::move (task));
+  }
+  mWake.notify_one ();
+}
+
+void WorkStealingPool::Wait ()
+{
+  std::unique_lock<std::mutex> lock (mSleepMutex);
+  mIdle.wait (lock, [this] { return mPending.load () == 0; });
+}
+
+bool WorkStealingPool::TakeTask (uint32_t self, Task &task)
+{
+  {
+    Worker &own = *mWorkers[self];
+    std::lock_guard<std::mutex> lock (own.mMutex);
+    if (!own.mTasks.empty ())
+      {
+	task = std::move (own.mTasks.back ());
+	own.mTasks.pop_back ();
+	mQueued.fetch_sub (1);
+	return true;
+      }
+  }
+  for (size_t step = 1; step < mWorkers.size (); step++)
+    {
+      Worker &victim = *mWorkers[(self + step) % mWorkers.size ()];
+      std::lock_guard<std::mutex> lock (victim.mMutex);
+      if (!victim.mTasks.empty ())
+	{
+	  task = std::move (victim.mTasks.front ());
+	  victim.mTasks.pop_front ();
+	  mQueued.fetch_sub (1);
+	  mSteals.fetch_add (1);
+	  return true;
+	}
+    }
+  return false;
+}
+
+void WorkStealingPool::Run (uint32_t self)
+{
+  sCurrentPool = this;
+  sCurrentWorker = self;
+  while (true)
+    {
+      Task task;
+      if (TakeTask (self, task))
+	{
+	  task ();
+	  if (mPending.fetch_sub (1) == 1)
+	    {
+	      std::lock_guard<std::mutex> lock (mSleepMutex);
+	      mIdle.notify_all ();
+	    }
+	  continue;
+	}
+
+      std::unique_lock<std::mutex> lock (mSleepMutex);
+      mWake.wait (lock, [this] { return mStopping || (mQueued.load () > 0); });
+      if (mStopping && (mQueued.load () == 0))
+	{
+	  return;
+	}
+    }
+}
@@ -0,0 +1,86 @@
+/*******************************************************************************
+Copyright 2025 Geometrics, Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a 
+copy of this software and associated documentation files (the “Software”), 
+to deal in the Software without restriction, including without limitation 
+the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+and/or sell copies of the Software, and to permit persons to whom the 
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included 
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS 
+IN THE SOFTWARE.
+******************************************************************************/
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads, each with its own deque of tasks.  A
+   worker takes its newest task first, which keeps the subtasks that a
+   task submits (the chunks of a file, say) close together; a worker with
+   nothing to do steals the oldest task of another, so large jobs spread
+   across idle workers without a central queue. */
+class WorkStealingPool
+{
+public:
+  typedef std::function<void ()> Task;
+
+  /* \param workers  Number of threads; 0 for one per hardware thread. */
+  explicit WorkStealingPool (uint32_t workers);
+  ~WorkStealingPool ();
+
+  WorkStealingPool (const WorkStealingPool &) = delete;
+  WorkStealingPool &operator= (const WorkStealingPool &) = delete;
+
+  /* From a worker, the task goes on that worker's own deque; from any
+     other thread, the deques are filled in turn. */
+  void     Submit (Task task);
+
+  /* \brief Wait until every task submitted so far, including those that
+     tasks submit, has finished. */
+  void     Wait ();
+
+  uint32_t WorkerCount () const { return (uint32_t)mWorkers.size (); }
+  uint64_t Steals () const { return mSteals.load (); }
+
+private:
+  struct Worker
+  {
+    std::mutex       mMutex;
+    std::deque<Task> mTasks;
+  };
+
+  void Run (uint32_t self);
+  bool TakeTask (uint32_t self, Task &task);
+
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::vector<std::thread>             mThreads;
+
+  std::mutex                           mSleepMutex;
+  std::condition_variable              mWake;   /* Tasks queued, or stopping */
+  std::condition_variable              mIdle;   /* Nothing pending */
+  std::atomic<uint64_t>                mQueued {0};
+  std::atomic<uint64_t>                mPending {0};
+  std::atomic<uint32_t>                mNextWorker {0};
+  std::atomic<uint64_t>                mSteals {0};
+  bool                                 mStopping = false;
+};
+
+#endif